@@ -377,9 +377,9 @@ static int configure_video_filters(AVInputStream *ist, AVOutputStream *ost)
     }else
         sample_aspect_ratio = ist->st->codec->sample_aspect_ratio;
 
-    snprintf(args, 255, "%d:%d:%d:%d:%d:%d:%d", ist->st->codec->width,
+    snprintf(args, 255, "%d:%d:%d:%d:%d:%d:%d:flags=0x%X", ist->st->codec->width,
              ist->st->codec->height, ist->st->codec->pix_fmt, 1, AV_TIME_BASE,
-             sample_aspect_ratio.num, sample_aspect_ratio.den);
+             sample_aspect_ratio.num, sample_aspect_ratio.den, ost->sws_flags);
 
     ret = avfilter_graph_create_filter(&ost->input_video_filter, avfilter_get_by_name("buffer"),
                                        "src", args, NULL, ost->graph);
@@ -574,6 +574,7 @@ static int ffmpeg_exit(int ret)
     av_free(audio_out);
     allocated_audio_buf_size= allocated_audio_out_size= 0;
     av_free(samples);
+    avcodec_thread_pool_free();
 
 #if CONFIG_AVFILTER
     avfilter_uninit();
@@ -3008,6 +3009,15 @@ static int opt_top_field_first(const char *opt, const char *arg)
     return 0;
 }
 
+static int opt_thread_pool(const char *opt, const char *arg)
+{
+    if (avcodec_thread_pool_init(parse_number_or_die(opt, arg, OPT_INT64, 0, INT_MAX)) < 0) {
+        fprintf(stderr, "Could not start the thread pool\n");
+        ffmpeg_exit(1);
+    }
+    return 0;
+}
+
 static int opt_thread_count(const char *opt, const char *arg)
 {
     thread_count= parse_number_or_die(opt, arg, OPT_INT64, 0, INT_MAX);
@@ -4426,6 +4436,7 @@ static const OptionDef options[] = {
     { "v", HAS_ARG, {(void*)opt_verbose}, "set ffmpeg verbosity level", "number" },
     { "target", HAS_ARG, {(void*)opt_target}, "specify target file type (\"vcd\", \"svcd\", \"dvd\", \"dv\", \"dv50\", \"pal-vcd\", \"ntsc-svcd\", ...)", "type" },
     { "threads",  HAS_ARG | OPT_EXPERT, {(void*)opt_thread_count}, "thread count", "count" },
+    { "thread_pool", HAS_ARG | OPT_EXPERT, {(void*)opt_thread_pool}, "run the threads of all codecs on one pool of count threads, 0 for one per CPU", "count" },
     { "vsync", HAS_ARG | OPT_INT | OPT_EXPERT, {(void*)&video_sync_method}, "video sync method", "" },
     { "async", HAS_ARG | OPT_INT | OPT_EXPERT, {(void*)&audio_sync_method}, "audio sync method", "" },
     { "adrift_threshold", HAS_ARG | OPT_FLOAT | OPT_EXPERT, {(void*)&audio_drift_threshold}, "audio drift threshold", "threshold" },
@@ -39,6 +39,12 @@
 
 #include <stdint.h>
 
+#if CONFIG_FFT_FLOAT
+#   define INTFLOAT float
+#else
+#   define INTFLOAT int
+#endif
+
 #define MAX_CHANNELS 64
 #define MAX_ELEM_ID 16
 
@@ -172,7 +178,7 @@ typedef struct {
     int length[8][4];
     int direction[8][4];
     int order[8][4];
-    float coef[8][4][TNS_MAX_ORDER];
+    INTFLOAT coef[8][4][TNS_MAX_ORDER];
 } TemporalNoiseShaping;
 
 /**
@@ -209,7 +215,7 @@ typedef struct {
     int ch_select[8];      /**< [0] shared list of gains; [1] list of gains for right channel;
                             *   [2] list of gains for left channel; [3] lists of gains for both channels
                             */
-    float gain[16][120];
+    INTFLOAT gain[16][120];
 } ChannelCoupling;
 
 /**
@@ -221,12 +227,12 @@ typedef struct {
     Pulse pulse;
     enum BandType band_type[128];                   ///< band types
     int band_type_run_end[120];                     ///< band type run end points
-    float sf[120];                                  ///< scalefactors
+    INTFLOAT sf[120];                               ///< scalefactors
     int sf_idx[128];                                ///< scalefactor indices (used by encoder)
     uint8_t zeroes[128];                            ///< band is not coded (used by encoder)
-    DECLARE_ALIGNED(32, float,   coeffs)[1024];     ///< coefficients for IMDCT
-    DECLARE_ALIGNED(32, float,   saved)[1024];      ///< overlap
-    DECLARE_ALIGNED(32, float,   ret)[2048];        ///< PCM output
+    DECLARE_ALIGNED(32, INTFLOAT, coeffs)[1024];    ///< coefficients for IMDCT
+    DECLARE_ALIGNED(32, INTFLOAT, saved)[1024];     ///< overlap
+    DECLARE_ALIGNED(32, INTFLOAT, ret)[2048];       ///< PCM output
     DECLARE_ALIGNED(16, float,   ltp_state)[3072];  ///< time signal for LTP
     PredictorState predictor_state[MAX_PREDICTORS];
 } SingleChannelElement;
@@ -274,7 +280,7 @@ typedef struct {
      * (We do not want to have these on the stack.)
      * @{
      */
-    DECLARE_ALIGNED(32, float, buf_mdct)[1024];
+    DECLARE_ALIGNED(32, INTFLOAT, buf_mdct)[1024];
     /** @} */
 
     /**
@@ -286,6 +292,8 @@ typedef struct {
     FFTContext mdct_ltp;
     DSPContext dsp;
     FmtConvertContext fmt_conv;
+    void (*vector_fmul_window)(INTFLOAT *dst, const INTFLOAT *src0,
+                               const INTFLOAT *src1, const INTFLOAT *win, int len);
     int random_state;
     /** @} */
 
@@ -293,10 +301,10 @@ typedef struct {
      * @name Members used for output interleaving
      * @{
      */
-    float *output_data[MAX_CHANNELS];                 ///< Points to each element's 'ret' buffer (PCM output).
+    INTFLOAT *output_data[MAX_CHANNELS];              ///< Points to each element's 'ret' buffer (PCM output).
     /** @} */
 
-    DECLARE_ALIGNED(32, float, temp)[128];
+    DECLARE_ALIGNED(32, INTFLOAT, temp)[128];
 
     enum OCStatus output_configured;
 } AACContext;
@@ -104,7 +104,7 @@
 #include <math.h>
 #include <string.h>
 
-#if ARCH_ARM
+#if ARCH_ARM && CONFIG_FFT_FLOAT
 #   include "arm/aac.h"
 #endif
 
@@ -118,6 +118,36 @@ static VLC vlc_spectral[11];
 
 static const char overread_err[] = "Input buffer exhausted before END element found\n";
 
+#if !CONFIG_FFT_FLOAT
+/**
+ * @name Fixed-point tables, set up by aac_fixed_tableinit()
+ * Dequantized values are n^(4/3) in Q13, windows and TNS coefficients Q31.
+ * @{
+ */
+static int pow43_fixed[1 << 13];
+static int codebook_vals_fixed[3][16];
+static const int *const codebook_vector_vals_fixed[11] = {
+    codebook_vals_fixed[0], codebook_vals_fixed[0],
+    codebook_vals_fixed[2], codebook_vals_fixed[2],
+    codebook_vals_fixed[1], codebook_vals_fixed[1],
+    codebook_vals_fixed[2], codebook_vals_fixed[2],
+    codebook_vals_fixed[2], codebook_vals_fixed[2],
+    codebook_vals_fixed[2],
+};
+static int tns_tmp2_map_fixed[4][16];
+static int kbd_long_1024_fixed[1024];
+static int kbd_short_128_fixed[128];
+static int sine_1024_fixed[1024];
+static int sine_128_fixed[128];
+/** @} */
+
+/** 2^(i/8) in Q30 */
+static const int pow2_frac_fixed[8] = {
+    1073741824, 1170923762, 1276901417, 1392470869,
+    1518500250, 1655936265, 1805811301, 1969251188,
+};
+#endif /* !CONFIG_FFT_FLOAT */
+
 static ChannelElement *get_che(AACContext *ac, int type, int elem_id)
 {
     // For PCE based channel configurations map the channels solely based on tags.
@@ -186,7 +216,9 @@ static av_cold int che_configure(AACContext *ac,
     if (che_pos[type][id]) {
         if (!ac->che[type][id] && !(ac->che[type][id] = av_mallocz(sizeof(ChannelElement))))
             return AVERROR(ENOMEM);
+#if CONFIG_FFT_FLOAT
         ff_aac_sbr_ctx_init(ac, &ac->che[type][id]->sbr);
+#endif
         if (type != TYPE_CCE) {
             ac->output_data[(*channels)++] = ac->che[type][id]->ch[0].ret;
             if (type == TYPE_CPE ||
@@ -195,8 +227,10 @@ static av_cold int che_configure(AACContext *ac,
             }
         }
     } else {
+#if CONFIG_FFT_FLOAT
         if (ac->che[type][id])
             ff_aac_sbr_ctx_close(&ac->che[type][id]->sbr);
+#endif
         av_freep(&ac->che[type][id]);
     }
     return 0;
@@ -480,13 +514,22 @@ static int decode_audio_specific_config(AACContext *ac,
     }
     if (m4ac->sbr == 1 && m4ac->ps == -1)
         m4ac->ps = 1;
+#if !CONFIG_FFT_FLOAT
+    if (m4ac->sbr == 1)
+        av_log(avctx, AV_LOG_WARNING, "SBR is not supported by the fixed-point "
+               "decoder, only the %d Hz AAC core will be decoded.\n", m4ac->sample_rate);
+    m4ac->sbr = 0;
+    m4ac->ps  = 0;
+#endif
 
     skip_bits_long(&gb, i);
 
     switch (m4ac->object_type) {
+#if CONFIG_FFT_FLOAT
     case AOT_AAC_MAIN:
-    case AOT_AAC_LC:
     case AOT_AAC_LTP:
+#endif
+    case AOT_AAC_LC:
         if (decode_ga_specific_config(ac, avctx, &gb, m4ac, m4ac->chan_config))
             return -1;
         break;
@@ -515,6 +558,7 @@ static av_always_inline int lcg_random(int previous_val)
     return previous_val * 1664525 + 1013904223;
 }
 
+#if CONFIG_FFT_FLOAT
 static av_always_inline void reset_predict_state(PredictorState *ps)
 {
     ps->r0   = 0.0f;
@@ -538,6 +582,58 @@ static void reset_predictor_group(PredictorState *ps, int group_num)
     for (i = group_num - 1; i < MAX_PREDICTORS; i += 30)
         reset_predict_state(&ps[i]);
 }
+#else
+/**
+ * Set up the fixed-point tables from their float counterparts.
+ */
+static av_cold void aac_fixed_tableinit(void)
+{
+    int i, j;
+
+    /* cbrt_tab holds the bit patterns of n^(4/3) as floats */
+    for (i = 1; i < 1 << 13; i++) {
+        int exp       = (cbrt_tab[i] >> 23) - 127 - 23 + 13;
+        unsigned mant = cbrt_tab[i] & 0x7fffff | 0x800000;
+        pow43_fixed[i] = exp >= 0 ? mant << exp : (mant + (1 << (-exp - 1))) >> -exp;
+    }
+    for (i = 0; i < 16; i++) {
+        codebook_vals_fixed[0][i] = i < 3 ? (i - 1) * pow43_fixed[1] : 0;
+        codebook_vals_fixed[1][i] = i < 9 ? (i < 4 ? -pow43_fixed[4 - i] : pow43_fixed[i - 4]) : 0;
+        codebook_vals_fixed[2][i] = pow43_fixed[i];
+    }
+
+    for (i = 0; i < 4; i++)
+        for (j = 0; j < 1 << (3 + (i & 1) - (i >> 1)); j++)
+            tns_tmp2_map_fixed[i][j] = av_clipl_int32(llrint(tns_tmp2_map[i][j] * 2147483648.0));
+
+    for (i = 0; i < 1024; i++) {
+        kbd_long_1024_fixed[i] = av_clipl_int32(llrint(ff_aac_kbd_long_1024[i] * 2147483648.0));
+        sine_1024_fixed[i]     = av_clipl_int32(llrint(ff_sine_1024[i]         * 2147483648.0));
+    }
+    for (i = 0; i < 128; i++) {
+        kbd_short_128_fixed[i] = av_clipl_int32(llrint(ff_aac_kbd_short_128[i] * 2147483648.0));
+        sine_128_fixed[i]      = av_clipl_int32(llrint(ff_sine_128[i]          * 2147483648.0));
+    }
+}
+
+static void vector_fmul_window_fixed(int *dst, const int *src0,
+                                     const int *src1, const int *win, int len)
+{
+    int i, j;
+
+    dst  += len;
+    win  += len;
+    src0 += len;
+    for (i = -len, j = len - 1; i < 0; i++, j--) {
+        int64_t s0 = src0[i];
+        int64_t s1 = src1[j];
+        int wi = win[i];
+        int wj = win[j];
+        dst[i] = (s0 * wj - s1 * wi + (1 << 30)) >> 31;
+        dst[j] = (s0 * wi + s1 * wj + (1 << 30)) >> 31;
+    }
+}
+#endif /* CONFIG_FFT_FLOAT */
 
 #define AAC_INIT_VLC_STATIC(num, size) \
     INIT_VLC_STATIC(&vlc_spectral[num], 8, ff_aac_spectral_sizes[num], \
@@ -548,7 +644,9 @@ static void reset_predictor_group(PredictorState *ps, int group_num)
 static av_cold int aac_decode_init(AVCodecContext *avctx)
 {
     AACContext *ac = avctx->priv_data;
+#if CONFIG_FFT_FLOAT
     float output_scale_factor;
+#endif
 
     ac->avctx = avctx;
     ac->m4ac.sample_rate = avctx->sample_rate;
@@ -560,6 +658,7 @@ static av_cold int aac_decode_init(AVCodecContext *avctx)
             return -1;
     }
 
+#if CONFIG_FFT_FLOAT
     if (avctx->request_sample_fmt == AV_SAMPLE_FMT_FLT) {
         avctx->sample_fmt = AV_SAMPLE_FMT_FLT;
         output_scale_factor = 1.0 / 32768.0;
@@ -567,6 +666,9 @@ static av_cold int aac_decode_init(AVCodecContext *avctx)
         avctx->sample_fmt = AV_SAMPLE_FMT_S16;
         output_scale_factor = 1.0;
     }
+#else
+    avctx->sample_fmt = AV_SAMPLE_FMT_S16;
+#endif
 
     AAC_INIT_VLC_STATIC( 0, 304);
     AAC_INIT_VLC_STATIC( 1, 270);
@@ -580,23 +682,36 @@ static av_cold int aac_decode_init(AVCodecContext *avctx)
     AAC_INIT_VLC_STATIC( 9, 366);
     AAC_INIT_VLC_STATIC(10, 462);
 
+#if CONFIG_FFT_FLOAT
     ff_aac_sbr_init();
 
     dsputil_init(&ac->dsp, avctx);
     ff_fmt_convert_init(&ac->fmt_conv, avctx);
+    ac->vector_fmul_window = ac->dsp.vector_fmul_window;
+#else
+    ac->vector_fmul_window = vector_fmul_window_fixed;
+#endif
 
     ac->random_state = 0x1f2e3d4c;
 
+#if CONFIG_FFT_FLOAT
     ff_aac_tableinit();
+#endif
 
     INIT_VLC_STATIC(&vlc_scalefactors,7,FF_ARRAY_ELEMS(ff_aac_scalefactor_code),
                     ff_aac_scalefactor_bits, sizeof(ff_aac_scalefactor_bits[0]), sizeof(ff_aac_scalefactor_bits[0]),
                     ff_aac_scalefactor_code, sizeof(ff_aac_scalefactor_code[0]), sizeof(ff_aac_scalefactor_code[0]),
                     352);
 
+#if CONFIG_FFT_FLOAT
     ff_mdct_init(&ac->mdct,       11, 1, output_scale_factor/1024.0);
     ff_mdct_init(&ac->mdct_small,  8, 1, output_scale_factor/128.0);
     ff_mdct_init(&ac->mdct_ltp,   11, 0, -2.0/output_scale_factor);
+#else
+    /* both transforms output 16-bit PCM in Q7 */
+    ff_mdct_init(&ac->mdct,       11, 1, 1.0 / 8);
+    ff_mdct_init(&ac->mdct_small,  8, 1, 1.0);
+#endif
     // window initialization
     ff_kbd_window_init(ff_aac_kbd_long_1024, 4.0, 1024);
     ff_kbd_window_init(ff_aac_kbd_short_128, 6.0, 128);
@@ -604,6 +719,9 @@ static av_cold int aac_decode_init(AVCodecContext *avctx)
     ff_init_ff_sine_windows( 7);
 
     cbrt_tableinit();
+#if !CONFIG_FFT_FLOAT
+    aac_fixed_tableinit();
+#endif
 
     return 0;
 }
@@ -783,11 +901,13 @@ static int decode_band_types(AACContext *ac, enum BandType band_type[120],
  * @param   global_gain         first scalefactor value as scalefactors are differentially coded
  * @param   band_type           array of the used band type
  * @param   band_type_run_end   array of the last scalefactor band of a band type run
- * @param   sf                  array of scalefactors or intensity stereo positions
+ * @param   sf                  array of scalefactors or intensity stereo positions;
+ *                              the fixed-point decoder keeps their exponents in
+ *                              quarter octaves instead
  *
  * @return  Returns error status. 0 - OK, !0 - error
  */
-static int decode_scalefactors(AACContext *ac, float sf[120], GetBitContext *gb,
+static int decode_scalefactors(AACContext *ac, INTFLOAT sf[120], GetBitContext *gb,
                                unsigned int global_gain,
                                IndividualChannelStream *ics,
                                enum BandType band_type[120],
@@ -814,7 +934,11 @@ static int decode_scalefactors(AACContext *ac, float sf[120], GetBitContext *gb,
                                 "audible artifact, there may be a bug in the "
                                 "decoder. ", offset[2], clipped_offset);
                     }
+#if CONFIG_FFT_FLOAT
                     sf[idx] = ff_aac_pow2sf_tab[-clipped_offset + POW_SF2_ZERO];
+#else
+                    sf[idx] = -clipped_offset;
+#endif
                 }
             } else if (band_type[idx] == NOISE_BT) {
                 for (; i < run_end; i++, idx++) {
@@ -829,7 +953,11 @@ static int decode_scalefactors(AACContext *ac, float sf[120], GetBitContext *gb,
                                 "artifact, there may be a bug in the decoder. ",
                                 offset[1], clipped_offset);
                     }
+#if CONFIG_FFT_FLOAT
                     sf[idx] = -ff_aac_pow2sf_tab[clipped_offset + POW_SF2_ZERO];
+#else
+                    sf[idx] = clipped_offset;
+#endif
                 }
             } else {
                 for (; i < run_end; i++, idx++) {
@@ -839,7 +967,11 @@ static int decode_scalefactors(AACContext *ac, float sf[120], GetBitContext *gb,
                                "%s (%d) out of range.\n", sf_str[0], offset[0]);
                         return -1;
                     }
+#if CONFIG_FFT_FLOAT
                     sf[idx] = -ff_aac_pow2sf_tab[offset[0] - 100 + POW_SF2_ZERO];
+#else
+                    sf[idx] = offset[0] - 100;
+#endif
                 }
             }
         }
@@ -904,7 +1036,11 @@ static int decode_tns(AACContext *ac, TemporalNoiseShaping *tns,
                     tmp2_idx = 2 * coef_compress + coef_res;
 
                     for (i = 0; i < tns->order[w][filt]; i++)
+#if CONFIG_FFT_FLOAT
                         tns->coef[w][filt][i] = tns_tmp2_map[tmp2_idx][get_bits(gb, coef_len)];
+#else
+                        tns->coef[w][filt][i] = tns_tmp2_map_fixed[tmp2_idx][get_bits(gb, coef_len)];
+#endif
                 }
             }
         }
@@ -931,6 +1067,7 @@ static void decode_mid_side_stereo(ChannelElement *cpe, GetBitContext *gb,
     }
 }
 
+#if CONFIG_FFT_FLOAT
 #ifndef VMUL2
 static inline float *VMUL2(float *dst, const float *v, unsigned idx,
                            const float *scale)
@@ -998,6 +1135,110 @@ static inline float *VMUL4S(float *dst, const float *v, unsigned idx,
     return dst;
 }
 #endif
+#else /* CONFIG_FFT_FLOAT */
+/* The fixed-point versions only look up n^(4/3), the scalefactor is
+ * applied by scale_band_fixed() once the whole band has been decoded. */
+static inline int *VMUL2(int *dst, const int *v, unsigned idx,
+                         const int *scale)
+{
+    *dst++ = v[idx    & 15];
+    *dst++ = v[idx>>4 & 15];
+    return dst;
+}
+
+static inline int *VMUL4(int *dst, const int *v, unsigned idx,
+                         const int *scale)
+{
+    *dst++ = v[idx    & 3];
+    *dst++ = v[idx>>2 & 3];
+    *dst++ = v[idx>>4 & 3];
+    *dst++ = v[idx>>6 & 3];
+    return dst;
+}
+
+static inline int *VMUL2S(int *dst, const int *v, unsigned idx,
+                          unsigned sign, const int *scale)
+{
+    int s0 = -(int)(sign >> 1 & 1);
+    int s1 = -(int)(sign      & 1);
+
+    *dst++ = (v[idx    & 15] ^ s0) - s0;
+    *dst++ = (v[idx>>4 & 15] ^ s1) - s1;
+
+    return dst;
+}
+
+static inline int *VMUL4S(int *dst, const int *v, unsigned idx,
+                          unsigned sign, const int *scale)
+{
+    unsigned nz = idx >> 12;
+    int s;
+
+    s = -(int)(sign >> 31);
+    *dst++ = (v[idx    & 3] ^ s) - s;
+
+    sign <<= nz & 1; nz >>= 1;
+    s = -(int)(sign >> 31);
+    *dst++ = (v[idx>>2 & 3] ^ s) - s;
+
+    sign <<= nz & 1; nz >>= 1;
+    s = -(int)(sign >> 31);
+    *dst++ = (v[idx>>4 & 3] ^ s) - s;
+
+    sign <<= nz & 1; nz >>= 1;
+    s = -(int)(sign >> 31);
+    *dst++ = (v[idx>>6 & 3] ^ s) - s;
+
+    return dst;
+}
+
+/**
+ * Multiply len values by mult and shift them down with rounding and saturation.
+ */
+static void vector_mul_shift_fixed(int *dst, const int *src, int mult,
+                                   int shift, int len)
+{
+    int64_t round;
+    int i;
+
+    if (shift > 62) {
+        memset(dst, 0, len * sizeof(*dst));
+        return;
+    }
+    /* only reachable with absurd scalefactors, saturate instead */
+    shift = FFMAX(shift, 1);
+    round = 1LL << (shift - 1);
+    for (i = 0; i < len; i++)
+        dst[i] = av_clipl_int32((src[i] * (int64_t)mult + round) >> shift);
+}
+
+/**
+ * Scale dequantized n^(4/3) values (Q13) by -2^(exp/4), the sign matching
+ * the negative scalefactors of the floating-point decoder.
+ */
+static void scale_band_fixed(int *coef, int exp, int len)
+{
+    vector_mul_shift_fixed(coef, coef, -pow2_frac_fixed[2 * (exp & 3)],
+                           43 - (exp >> 2), len);
+}
+
+/**
+ * Find n such that n^(4/3) in Q13 equals v.
+ */
+static int pow43_inverse_fixed(int v)
+{
+    int lo = 0, hi = (1 << 13) - 1;
+
+    while (lo < hi) {
+        int mid = (lo + hi) >> 1;
+        if (pow43_fixed[mid] < v)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+#endif /* CONFIG_FFT_FLOAT */
 
 /**
  * Decode spectral data; reference: table 4.50.
@@ -1011,8 +1252,8 @@ static inline float *VMUL4S(float *dst, const float *v, unsigned idx,
  *
  * @return  Returns error status. 0 - OK, !0 - error
  */
-static int decode_spectrum_and_dequant(AACContext *ac, float coef[1024],
-                                       GetBitContext *gb, const float sf[120],
+static int decode_spectrum_and_dequant(AACContext *ac, INTFLOAT coef[1024],
+                                       GetBitContext *gb, const INTFLOAT sf[120],
                                        int pulse_present, const Pulse *pulse,
                                        const IndividualChannelStream *ics,
                                        enum BandType band_type[120])
@@ -1020,26 +1261,27 @@ static int decode_spectrum_and_dequant(AACContext *ac, float coef[1024],
     int i, k, g, idx = 0;
     const int c = 1024 / ics->num_windows;
     const uint16_t *offsets = ics->swb_offset;
-    float *coef_base = coef;
+    INTFLOAT *coef_base = coef;
 
     for (g = 0; g < ics->num_windows; g++)
-        memset(coef + g * 128 + offsets[ics->max_sfb], 0, sizeof(float) * (c - offsets[ics->max_sfb]));
+        memset(coef + g * 128 + offsets[ics->max_sfb], 0, sizeof(INTFLOAT) * (c - offsets[ics->max_sfb]));
 
     for (g = 0; g < ics->num_window_groups; g++) {
         unsigned g_len = ics->group_len[g];
 
         for (i = 0; i < ics->max_sfb; i++, idx++) {
             const unsigned cbt_m1 = band_type[idx] - 1;
-            float *cfo = coef + offsets[i];
+            INTFLOAT *cfo = coef + offsets[i];
             int off_len = offsets[i + 1] - offsets[i];
             int group;
 
             if (cbt_m1 >= INTENSITY_BT2 - 1) {
                 for (group = 0; group < g_len; group++, cfo+=128) {
-                    memset(cfo, 0, off_len * sizeof(float));
+                    memset(cfo, 0, off_len * sizeof(INTFLOAT));
                 }
             } else if (cbt_m1 == NOISE_BT - 1) {
                 for (group = 0; group < g_len; group++, cfo+=128) {
+#if CONFIG_FFT_FLOAT
                     float scale;
                     float band_energy;
 
@@ -1051,9 +1293,29 @@ static int decode_spectrum_and_dequant(AACContext *ac, float coef[1024],
                     band_energy = ac->dsp.scalarproduct_float(cfo, cfo, off_len);
                     scale = sf[idx] / sqrtf(band_energy);
                     ac->dsp.vector_fmul_scalar(cfo, cfo, scale, off_len);
+#else
+                    unsigned band_energy = 0;
+                    int64_t scale;
+
+                    for (k = 0; k < off_len; k++) {
+                        ac->random_state  = lcg_random(ac->random_state);
+                        cfo[k] = ac->random_state >> 22;
+                        band_energy += cfo[k] * cfo[k];
+                    }
+
+                    /* -2^(sf/4) / sqrt(band_energy), Q38 before the exponent */
+                    scale = ((int64_t)pow2_frac_fixed[2 * (sf[idx] & 3)] << 8) /
+                            FFMAX(ff_sqrt(band_energy), 1);
+                    vector_mul_shift_fixed(cfo, cfo, -FFMIN(scale, INT_MAX),
+                                           38 - (sf[idx] >> 2), off_len);
+#endif
                 }
             } else {
+#if CONFIG_FFT_FLOAT
                 const float *vq = ff_aac_codebook_vector_vals[cbt_m1];
+#else
+                const int *vq = codebook_vector_vals_fixed[cbt_m1];
+#endif
                 const uint16_t *cb_vector_idx = ff_aac_codebook_vector_idx[cbt_m1];
                 VLC_TYPE (*vlc_tab)[2] = vlc_spectral[cbt_m1].table;
                 OPEN_READER(re, gb);
@@ -1061,7 +1323,7 @@ static int decode_spectrum_and_dequant(AACContext *ac, float coef[1024],
                 switch (cbt_m1 >> 1) {
                 case 0:
                     for (group = 0; group < g_len; group++, cfo+=128) {
-                        float *cf = cfo;
+                        INTFLOAT *cf = cfo;
                         int len = off_len;
 
                         do {
@@ -1078,7 +1340,7 @@ static int decode_spectrum_and_dequant(AACContext *ac, float coef[1024],
 
                 case 1:
                     for (group = 0; group < g_len; group++, cfo+=128) {
-                        float *cf = cfo;
+                        INTFLOAT *cf = cfo;
                         int len = off_len;
 
                         do {
@@ -1100,7 +1362,7 @@ static int decode_spectrum_and_dequant(AACContext *ac, float coef[1024],
 
                 case 2:
                     for (group = 0; group < g_len; group++, cfo+=128) {
-                        float *cf = cfo;
+                        INTFLOAT *cf = cfo;
                         int len = off_len;
 
                         do {
@@ -1118,7 +1380,7 @@ static int decode_spectrum_and_dequant(AACContext *ac, float coef[1024],
                 case 3:
                 case 4:
                     for (group = 0; group < g_len; group++, cfo+=128) {
-                        float *cf = cfo;
+                        INTFLOAT *cf = cfo;
                         int len = off_len;
 
                         do {
@@ -1140,8 +1402,12 @@ static int decode_spectrum_and_dequant(AACContext *ac, float coef[1024],
 
                 default:
                     for (group = 0; group < g_len; group++, cfo+=128) {
-                        float *cf = cfo;
+                        INTFLOAT *cf = cfo;
+#if CONFIG_FFT_FLOAT
                         uint32_t *icf = (uint32_t *) cf;
+#else
+                        int *icf = cf;
+#endif
                         int len = off_len;
 
                         do {
@@ -1185,27 +1451,58 @@ static int decode_spectrum_and_dequant(AACContext *ac, float coef[1024],
                                     b += 4;
                                     n = (1 << b) + SHOW_UBITS(re, gb, b);
                                     LAST_SKIP_BITS(re, gb, b);
+#if CONFIG_FFT_FLOAT
                                     *icf++ = cbrt_tab[n] | (bits & 1U<<31);
+#else
+                                    *icf++ = bits & 1U<<31 ? -pow43_fixed[n] : pow43_fixed[n];
+#endif
                                     bits <<= 1;
                                 } else {
+#if CONFIG_FFT_FLOAT
                                     unsigned v = ((const uint32_t*)vq)[cb_idx & 15];
                                     *icf++ = (bits & 1U<<31) | v;
+#else
+                                    int v = vq[cb_idx & 15];
+                                    *icf++ = bits & 1U<<31 ? -v : v;
+#endif
                                     bits <<= !!v;
                                 }
                                 cb_idx >>= 4;
                             }
                         } while (len -= 2);
 
+#if CONFIG_FFT_FLOAT
                         ac->dsp.vector_fmul_scalar(cfo, cfo, sf[idx], off_len);
+#endif
                     }
                 }
 
                 CLOSE_READER(re, gb);
+
+#if !CONFIG_FFT_FLOAT
+                /* pulses only occur in long windows and have to be added
+                 * to the quantized values before the band is scaled */
+                if (pulse_present) {
+                    for (k = 0; k < pulse->num_pulse; k++) {
+                        int pos = pulse->pos[k];
+                        if (pos >= offsets[i] && pos < offsets[i + 1]) {
+                            int co = coef_base[pos];
+                            int n  = pow43_inverse_fixed(FFABS(co)) + pulse->amp[k];
+                            n = FFMIN(n, (1 << 13) - 1);
+                            coef_base[pos] = co > 0 ? pow43_fixed[n] : -pow43_fixed[n];
+                        }
+                    }
+                }
+                cfo = coef + offsets[i];
+                for (group = 0; group < g_len; group++, cfo += 128)
+                    scale_band_fixed(cfo, sf[idx], off_len);
+#endif
             }
         }
         coef += g_len << 7;
     }
 
+#if CONFIG_FFT_FLOAT
     if (pulse_present) {
         idx = 0;
         for (i = 0; i < pulse->num_pulse; i++) {
@@ -1222,9 +1519,11 @@ static int decode_spectrum_and_dequant(AACContext *ac, float coef[1024],
             }
         }
     }
+#endif
     return 0;
 }
 
+#if CONFIG_FFT_FLOAT
 static av_always_inline float flt16_round(float pf)
 {
     union float754 tmp;
@@ -1304,6 +1603,7 @@ static void apply_prediction(AACContext *ac, SingleChannelElement *sce)
     } else
         reset_all_predictors(sce->predictor_state);
 }
+#endif /* CONFIG_FFT_FLOAT */
 
 /**
  * Decode an individual_channel_stream payload; reference: table 4.44.
@@ -1319,7 +1619,7 @@ static int decode_ics(AACContext *ac, SingleChannelElement *sce,
     Pulse pulse;
     TemporalNoiseShaping    *tns = &sce->tns;
     IndividualChannelStream *ics = &sce->ics;
-    float *out = sce->coeffs;
+    INTFLOAT *out = sce->coeffs;
     int global_gain, pulse_present = 0;
 
     /* This assignment is to silence a GCC warning about the variable being used
@@ -1362,8 +1662,10 @@ static int decode_ics(AACContext *ac, SingleChannelElement *sce,
     if (decode_spectrum_and_dequant(ac, out, gb, sce->sf, pulse_present, &pulse, ics, sce->band_type) < 0)
         return -1;
 
+#if CONFIG_FFT_FLOAT
     if (ac->m4ac.object_type == AOT_AAC_MAIN && !common_window)
         apply_prediction(ac, sce);
+#endif
 
     return 0;
 }
@@ -1374,8 +1676,8 @@ static int decode_ics(AACContext *ac, SingleChannelElement *sce,
 static void apply_mid_side_stereo(AACContext *ac, ChannelElement *cpe)
 {
     const IndividualChannelStream *ics = &cpe->ch[0].ics;
-    float *ch0 = cpe->ch[0].coeffs;
-    float *ch1 = cpe->ch[1].coeffs;
+    INTFLOAT *ch0 = cpe->ch[0].coeffs;
+    INTFLOAT *ch1 = cpe->ch[1].coeffs;
     int g, i, group, idx = 0;
     const uint16_t *offsets = ics->swb_offset;
     for (g = 0; g < ics->num_window_groups; g++) {
@@ -1383,9 +1685,20 @@ static void apply_mid_side_stereo(AACContext *ac, ChannelElement *cpe)
             if (cpe->ms_mask[idx] &&
                     cpe->ch[0].band_type[idx] < NOISE_BT && cpe->ch[1].band_type[idx] < NOISE_BT) {
                 for (group = 0; group < ics->group_len[g]; group++) {
+#if CONFIG_FFT_FLOAT
                     ac->dsp.butterflies_float(ch0 + group * 128 + offsets[i],
                                               ch1 + group * 128 + offsets[i],
                                               offsets[i+1] - offsets[i]);
+#else
+                    int *l = ch0 + group * 128;
+                    int *r = ch1 + group * 128;
+                    int k;
+                    for (k = offsets[i]; k < offsets[i + 1]; k++) {
+                        int t = av_clipl_int32((int64_t)l[k] - r[k]);
+                        l[k]  = av_clipl_int32((int64_t)l[k] + r[k]);
+                        r[k]  = t;
+                    }
+#endif
                 }
             }
         }
@@ -1405,11 +1718,13 @@ static void apply_intensity_stereo(AACContext *ac, ChannelElement *cpe, int ms_p
 {
     const IndividualChannelStream *ics = &cpe->ch[1].ics;
     SingleChannelElement         *sce1 = &cpe->ch[1];
-    float *coef0 = cpe->ch[0].coeffs, *coef1 = cpe->ch[1].coeffs;
+    INTFLOAT *coef0 = cpe->ch[0].coeffs, *coef1 = cpe->ch[1].coeffs;
     const uint16_t *offsets = ics->swb_offset;
     int g, group, i, idx = 0;
     int c;
+#if CONFIG_FFT_FLOAT
     float scale;
+#endif
     for (g = 0; g < ics->num_window_groups; g++) {
         for (i = 0; i < ics->max_sfb;) {
             if (sce1->band_type[idx] == INTENSITY_BT || sce1->band_type[idx] == INTENSITY_BT2) {
@@ -1418,12 +1733,21 @@ static void apply_intensity_stereo(AACContext *ac, ChannelElement *cpe, int ms_p
                     c = -1 + 2 * (sce1->band_type[idx] - 14);
                     if (ms_present)
                         c *= 1 - 2 * cpe->ms_mask[idx];
+#if CONFIG_FFT_FLOAT
                     scale = c * sce1->sf[idx];
                     for (group = 0; group < ics->group_len[g]; group++)
                         ac->dsp.vector_fmul_scalar(coef1 + group * 128 + offsets[i],
                                                    coef0 + group * 128 + offsets[i],
                                                    scale,
                                                    offsets[i + 1] - offsets[i]);
+#else
+                    for (group = 0; group < ics->group_len[g]; group++)
+                        vector_mul_shift_fixed(coef1 + group * 128 + offsets[i],
+                                               coef0 + group * 128 + offsets[i],
+                                               c * pow2_frac_fixed[2 * (sce1->sf[idx] & 3)],
+                                               30 - (sce1->sf[idx] >> 2),
+                                               offsets[i + 1] - offsets[i]);
+#endif
                 }
             } else {
                 int bt_run_end = sce1->band_type_run_end[idx];
@@ -1470,22 +1794,40 @@ static int decode_cpe(AACContext *ac, GetBitContext *gb, ChannelElement *cpe)
     if (common_window) {
         if (ms_present)
             apply_mid_side_stereo(ac, cpe);
+#if CONFIG_FFT_FLOAT
         if (ac->m4ac.object_type == AOT_AAC_MAIN) {
             apply_prediction(ac, &cpe->ch[0]);
             apply_prediction(ac, &cpe->ch[1]);
         }
+#endif
     }
 
     apply_intensity_stereo(ac, cpe, ms_present);
     return 0;
 }
 
+#if CONFIG_FFT_FLOAT
 static const float cce_scale[] = {
     1.09050773266525765921, //2^(1/8)
     1.18920711500272106672, //2^(1/4)
     M_SQRT2,
     2,
 };
+#else
+/**
+ * Return 2^(exp/8) in Q16.
+ */
+static int cce_gain_fixed(int exp)
+{
+    int shift;
+
+    exp   = FFMIN(exp, 15 * 8 - 1);
+    shift = 14 - (exp >> 3);
+    if (shift > 30)
+        return 0;
+    return (pow2_frac_fixed[exp & 7] + (1 << shift >> 1)) >> shift;
+}
+#endif
 
 /**
  * Decode coupling_channel_element; reference: table 4.8.
@@ -1497,7 +1839,7 @@ static int decode_cce(AACContext *ac, GetBitContext *gb, ChannelElement *che)
     int num_gain = 0;
     int c, g, sfb, ret;
     int sign;
-    float scale;
+    INTFLOAT scale;
     SingleChannelElement *sce = &che->ch[0];
     ChannelCoupling     *coup = &che->coup;
 
@@ -1517,7 +1859,11 @@ static int decode_cce(AACContext *ac, GetBitContext *gb, ChannelElement *che)
     coup->coupling_point += get_bits1(gb) || (coup->coupling_point >> 1);
 
     sign  = get_bits(gb, 1);
+#if CONFIG_FFT_FLOAT
     scale = cce_scale[get_bits(gb, 2)];
+#else
+    scale = 1 << get_bits(gb, 2); // in 1/8 octaves
+#endif
 
     if ((ret = decode_ics(ac, sce, gb, 0, 0)))
         return ret;
@@ -1526,11 +1872,19 @@ static int decode_cce(AACContext *ac, GetBitContext *gb, ChannelElement *che)
         int idx  = 0;
         int cge  = 1;
         int gain = 0;
+#if CONFIG_FFT_FLOAT
         float gain_cache = 1.;
+#else
+        int gain_cache = 1 << 16;
+#endif
         if (c) {
             cge = coup->coupling_point == AFTER_IMDCT ? 1 : get_bits1(gb);
             gain = cge ? get_vlc2(gb, vlc_scalefactors.table, 7, 3) - 60: 0;
+#if CONFIG_FFT_FLOAT
             gain_cache = powf(scale, -gain);
+#else
+            gain_cache = cce_gain_fixed(-gain * scale);
+#endif
         }
         if (coup->coupling_point == AFTER_IMDCT) {
             coup->gain[c][0] = gain_cache;
@@ -1547,7 +1901,11 @@ static int decode_cce(AACContext *ac, GetBitContext *gb, ChannelElement *che)
                                     s  -= 2 * (t & 0x1);
                                     t >>= 1;
                                 }
+#if CONFIG_FFT_FLOAT
                                 gain_cache = powf(scale, -t) * s;
+#else
+                                gain_cache = cce_gain_fixed(-t * scale) * s;
+#endif
                             }
                         }
                         coup->gain[c][idx] = gain_cache;
@@ -1651,7 +2009,12 @@ static int decode_extension_payload(AACContext *ac, GetBitContext *gb, int cnt,
         if (!che) {
             av_log(ac->avctx, AV_LOG_ERROR, "SBR was found before the first channel element.\n");
             return res;
-        } else if (!ac->m4ac.sbr) {
+        }
+#if !CONFIG_FFT_FLOAT
+        /* not supported by the fixed-point decoder, which outputs the AAC core */
+        skip_bits_long(gb, 8 * cnt - 4);
+#else
+        else if (!ac->m4ac.sbr) {
             av_log(ac->avctx, AV_LOG_ERROR, "SBR signaled to be not-present but was found in the bitstream.\n");
             skip_bits_long(gb, 8 * cnt - 4);
             return res;
@@ -1667,6 +2030,7 @@ static int decode_extension_payload(AACContext *ac, GetBitContext *gb, int cnt,
             ac->m4ac.sbr = 1;
         }
         res = ff_decode_sbr_extension(ac, &che->sbr, gb, crc_flag, cnt, elem_type);
+#endif
         break;
     case EXT_DYNAMIC_RANGE:
         res = decode_dynamic_range(&ac->che_drc, gb, cnt);
@@ -1687,14 +2051,49 @@ static int decode_extension_payload(AACContext *ac, GetBitContext *gb, int cnt,
  * @param   decode  1 if tool is used normally, 0 if tool is used in LTP.
  * @param   coef    spectral coefficients
  */
-static void apply_tns(float coef[1024], TemporalNoiseShaping *tns,
+#if !CONFIG_FFT_FLOAT
+/**
+ * Convert TNS reflection coefficients (Q31) to LPC coefficients.
+ * The LPC coefficients are bounded by prod(1 + |refl[i]|), the precision
+ * is chosen from that bound so that filters with poles close to the unit
+ * circle do not lose accuracy.
+ *
+ * @return the number of fractional bits of the LPC coefficients
+ */
+static int compute_lpc_coefs_fixed(const int *refl, int order, int *lpc)
+{
+    int64_t bound = 1 << 24;
+    int i, j, bits;
+
+    for (j = 0; j < order; j++)
+        bound += (bound * (FFABS(refl[j]) >> 8) >> 23) + 1;
+    bits = 30 - av_log2(bound >> 24);
+
+    for (j = 0; j < order; j++) {
+        int r = -refl[j];
+        lpc[j] = (r + (1 << (30 - bits))) >> (31 - bits);
+        for (i = 0; i < (j + 1) >> 1; i++) {
+            int f = lpc[i];
+            int b = lpc[j - 1 - i];
+            lpc[        i] = f + (int)((r * (int64_t)b + (1 << 30)) >> 31);
+            lpc[j - 1 - i] = b + (int)((r * (int64_t)f + (1 << 30)) >> 31);
+        }
+    }
+    return bits;
+}
+#endif
+
+static void apply_tns(INTFLOAT coef[1024], TemporalNoiseShaping *tns,
                       IndividualChannelStream *ics, int decode)
 {
     const int mmm = FFMIN(ics->tns_max_bands, ics->max_sfb);
     int w, filt, m, i;
     int bottom, top, order, start, end, size, inc;
-    float lpc[TNS_MAX_ORDER];
-    float tmp[TNS_MAX_ORDER];
+    INTFLOAT lpc[TNS_MAX_ORDER];
+    INTFLOAT tmp[TNS_MAX_ORDER];
+#if !CONFIG_FFT_FLOAT
+    int lpc_bits;
+#endif
 
     for (w = 0; w < ics->num_windows; w++) {
         bottom = ics->num_swb;
@@ -1706,7 +2105,11 @@ static void apply_tns(float coef[1024], TemporalNoiseShaping *tns,
                 continue;
 
             // tns_decode_coef
+#if CONFIG_FFT_FLOAT
             compute_lpc_coefs(tns->coef[w][filt], order, lpc, 0, 0, 0);
+#else
+            lpc_bits = compute_lpc_coefs_fixed(tns->coef[w][filt], order, lpc);
+#endif
 
             start = ics->swb_offset[FFMIN(bottom, mmm)];
             end   = ics->swb_offset[FFMIN(   top, mmm)];
@@ -1722,15 +2125,33 @@ static void apply_tns(float coef[1024], TemporalNoiseShaping *tns,
 
             if (decode) {
                 // ar filter
+#if CONFIG_FFT_FLOAT
                 for (m = 0; m < size; m++, start += inc)
                     for (i = 1; i <= FFMIN(m, order); i++)
                         coef[start] -= coef[start - i * inc] * lpc[i - 1];
+#else
+                for (m = 0; m < size; m++, start += inc) {
+                    int64_t acc = 0;
+                    for (i = 1; i <= FFMIN(m, order); i++)
+                        acc += coef[start - i * inc] * (int64_t)lpc[i - 1];
+                    coef[start] = av_clipl_int32(coef[start] - ((acc + (1 << (lpc_bits - 1))) >> lpc_bits));
+                }
+#endif
             } else {
                 // ma filter
                 for (m = 0; m < size; m++, start += inc) {
                     tmp[0] = coef[start];
+#if CONFIG_FFT_FLOAT
                     for (i = 1; i <= FFMIN(m, order); i++)
                         coef[start] += tmp[i] * lpc[i - 1];
+#else
+                    {
+                        int64_t acc = 0;
+                        for (i = 1; i <= FFMIN(m, order); i++)
+                            acc += tmp[i] * (int64_t)lpc[i - 1];
+                        coef[start] = av_clipl_int32(coef[start] + ((acc + (1 << (lpc_bits - 1))) >> lpc_bits));
+                    }
+#endif
                     for (i = order; i > 0; i--)
                         tmp[i] = tmp[i - 1];
                 }
@@ -1739,6 +2160,7 @@ static void apply_tns(float coef[1024], TemporalNoiseShaping *tns,
     }
 }
 
+#if CONFIG_FFT_FLOAT
 /**
  *  Apply windowing and MDCT to obtain the spectral
  *  coefficient from the predicted sample by LTP.
@@ -1832,6 +2254,31 @@ static void update_ltp(AACContext *ac, SingleChannelElement *sce)
     memcpy(sce->ltp_state+1024, sce->ret,            1024 * sizeof(*sce->ltp_state));
     memcpy(sce->ltp_state+2048, saved_ltp,           1024 * sizeof(*sce->ltp_state));
 }
+#else
+/**
+ * Fixed-point IMDCT, blocks with a peak of max_bits or more are shifted
+ * down before the transform to keep the FFT from overflowing.
+ */
+static void imdct_half_fixed(FFTContext *mdct, int *out, int *in, int max_bits)
+{
+    const int n2 = 1 << (mdct->mdct_bits - 1);
+    unsigned max = 0;
+    int i, shift;
+
+    for (i = 0; i < n2; i++)
+        max |= in[i] ^ (in[i] >> 31);
+    shift = av_log2(max) + 1 - max_bits;
+    if (shift > 0)
+        for (i = 0; i < n2; i++)
+            in[i] >>= shift;
+
+    mdct->imdct_half(mdct, out, in);
+
+    if (shift > 0)
+        for (i = 0; i < n2; i++)
+            out[i] = av_clipl_int32((int64_t)out[i] << shift);
+}
+#endif /* CONFIG_FFT_FLOAT */
 
 /**
  * Conduct IMDCT and windowing.
@@ -1839,22 +2286,36 @@ static void update_ltp(AACContext *ac, SingleChannelElement *sce)
 static void imdct_and_windowing(AACContext *ac, SingleChannelElement *sce)
 {
     IndividualChannelStream *ics = &sce->ics;
-    float *in    = sce->coeffs;
-    float *out   = sce->ret;
-    float *saved = sce->saved;
+    INTFLOAT *in    = sce->coeffs;
+    INTFLOAT *out   = sce->ret;
+    INTFLOAT *saved = sce->saved;
+#if CONFIG_FFT_FLOAT
     const float *swindow      = ics->use_kb_window[0] ? ff_aac_kbd_short_128 : ff_sine_128;
     const float *lwindow_prev = ics->use_kb_window[1] ? ff_aac_kbd_long_1024 : ff_sine_1024;
     const float *swindow_prev = ics->use_kb_window[1] ? ff_aac_kbd_short_128 : ff_sine_128;
-    float *buf  = ac->buf_mdct;
-    float *temp = ac->temp;
+#else
+    const int *swindow      = ics->use_kb_window[0] ? kbd_short_128_fixed : sine_128_fixed;
+    const int *lwindow_prev = ics->use_kb_window[1] ? kbd_long_1024_fixed : sine_1024_fixed;
+    const int *swindow_prev = ics->use_kb_window[1] ? kbd_short_128_fixed : sine_128_fixed;
+#endif
+    INTFLOAT *buf  = ac->buf_mdct;
+    INTFLOAT *temp = ac->temp;
     int i;
 
     // imdct
+#if CONFIG_FFT_FLOAT
     if (ics->window_sequence[0] == EIGHT_SHORT_SEQUENCE) {
         for (i = 0; i < 1024; i += 128)
             ac->mdct_small.imdct_half(&ac->mdct_small, buf + i, in + i);
     } else
         ac->mdct.imdct_half(&ac->mdct, buf, in);
+#else
+    if (ics->window_sequence[0] == EIGHT_SHORT_SEQUENCE) {
+        for (i = 0; i < 1024; i += 128)
+            imdct_half_fixed(&ac->mdct_small, buf + i, in + i, 23);
+    } else
+        imdct_half_fixed(&ac->mdct, buf, in, 22);
+#endif
 
     /* window overlapping
      * NOTE: To simplify the overlapping code, all 'meaningless' short to long
@@ -1864,35 +2325,35 @@ static void imdct_and_windowing(AACContext *ac, SingleChannelElement *sce)
      */
     if ((ics->window_sequence[1] == ONLY_LONG_SEQUENCE || ics->window_sequence[1] == LONG_STOP_SEQUENCE) &&
             (ics->window_sequence[0] == ONLY_LONG_SEQUENCE || ics->window_sequence[0] == LONG_START_SEQUENCE)) {
-        ac->dsp.vector_fmul_window(    out,               saved,            buf,         lwindow_prev, 512);
+        ac->vector_fmul_window(    out,               saved,            buf,         lwindow_prev, 512);
     } else {
-        memcpy(                        out,               saved,            448 * sizeof(float));
+        memcpy(                    out,               saved,            448 * sizeof(INTFLOAT));
 
         if (ics->window_sequence[0] == EIGHT_SHORT_SEQUENCE) {
-            ac->dsp.vector_fmul_window(out + 448 + 0*128, saved + 448,      buf + 0*128, swindow_prev, 64);
-            ac->dsp.vector_fmul_window(out + 448 + 1*128, buf + 0*128 + 64, buf + 1*128, swindow,      64);
-            ac->dsp.vector_fmul_window(out + 448 + 2*128, buf + 1*128 + 64, buf + 2*128, swindow,      64);
-            ac->dsp.vector_fmul_window(out + 448 + 3*128, buf + 2*128 + 64, buf + 3*128, swindow,      64);
-            ac->dsp.vector_fmul_window(temp,              buf + 3*128 + 64, buf + 4*128, swindow,      64);
-            memcpy(                    out + 448 + 4*128, temp, 64 * sizeof(float));
+            ac->vector_fmul_window(out + 448 + 0*128, saved + 448,      buf + 0*128, swindow_prev, 64);
+            ac->vector_fmul_window(out + 448 + 1*128, buf + 0*128 + 64, buf + 1*128, swindow,      64);
+            ac->vector_fmul_window(out + 448 + 2*128, buf + 1*128 + 64, buf + 2*128, swindow,      64);
+            ac->vector_fmul_window(out + 448 + 3*128, buf + 2*128 + 64, buf + 3*128, swindow,      64);
+            ac->vector_fmul_window(temp,              buf + 3*128 + 64, buf + 4*128, swindow,      64);
+            memcpy(                out + 448 + 4*128, temp, 64 * sizeof(INTFLOAT));
         } else {
-            ac->dsp.vector_fmul_window(out + 448,         saved + 448,      buf,         swindow_prev, 64);
-            memcpy(                    out + 576,         buf + 64,         448 * sizeof(float));
+            ac->vector_fmul_window(out + 448,         saved + 448,      buf,         swindow_prev, 64);
+            memcpy(                out + 576,         buf + 64,         448 * sizeof(INTFLOAT));
         }
     }
 
     // buffer update
     if (ics->window_sequence[0] == EIGHT_SHORT_SEQUENCE) {
-        memcpy(                    saved,       temp + 64,         64 * sizeof(float));
-        ac->dsp.vector_fmul_window(saved + 64,  buf + 4*128 + 64, buf + 5*128, swindow, 64);
-        ac->dsp.vector_fmul_window(saved + 192, buf + 5*128 + 64, buf + 6*128, swindow, 64);
-        ac->dsp.vector_fmul_window(saved + 320, buf + 6*128 + 64, buf + 7*128, swindow, 64);
-        memcpy(                    saved + 448, buf + 7*128 + 64,  64 * sizeof(float));
+        memcpy(                saved,       temp + 64,         64 * sizeof(INTFLOAT));
+        ac->vector_fmul_window(saved + 64,  buf + 4*128 + 64, buf + 5*128, swindow, 64);
+        ac->vector_fmul_window(saved + 192, buf + 5*128 + 64, buf + 6*128, swindow, 64);
+        ac->vector_fmul_window(saved + 320, buf + 6*128 + 64, buf + 7*128, swindow, 64);
+        memcpy(                saved + 448, buf + 7*128 + 64,  64 * sizeof(INTFLOAT));
     } else if (ics->window_sequence[0] == LONG_START_SEQUENCE) {
-        memcpy(                    saved,       buf + 512,        448 * sizeof(float));
-        memcpy(                    saved + 448, buf + 7*128 + 64,  64 * sizeof(float));
+        memcpy(                saved,       buf + 512,        448 * sizeof(INTFLOAT));
+        memcpy(                saved + 448, buf + 7*128 + 64,  64 * sizeof(INTFLOAT));
     } else { // LONG_STOP or ONLY_LONG
-        memcpy(                    saved,       buf + 512,        512 * sizeof(float));
+        memcpy(                saved,       buf + 512,        512 * sizeof(INTFLOAT));
     }
 }
 
@@ -1907,8 +2368,8 @@ static void apply_dependent_coupling(AACContext *ac,
 {
     IndividualChannelStream *ics = &cce->ch[0].ics;
     const uint16_t *offsets = ics->swb_offset;
-    float *dest = target->coeffs;
-    const float *src = cce->ch[0].coeffs;
+    INTFLOAT *dest = target->coeffs;
+    const INTFLOAT *src = cce->ch[0].coeffs;
     int g, i, group, k, idx = 0;
     if (ac->m4ac.object_type == AOT_AAC_LTP) {
         av_log(ac->avctx, AV_LOG_ERROR,
@@ -1918,11 +2379,15 @@ static void apply_dependent_coupling(AACContext *ac,
     for (g = 0; g < ics->num_window_groups; g++) {
         for (i = 0; i < ics->max_sfb; i++, idx++) {
             if (cce->ch[0].band_type[idx] != ZERO_BT) {
-                const float gain = cce->coup.gain[index][idx];
+                const INTFLOAT gain = cce->coup.gain[index][idx];
                 for (group = 0; group < ics->group_len[g]; group++) {
                     for (k = offsets[i]; k < offsets[i + 1]; k++) {
                         // XXX dsputil-ize
+#if CONFIG_FFT_FLOAT
                         dest[group * 128 + k] += gain * src[group * 128 + k];
+#else
+                        dest[group * 128 + k] += (gain * (int64_t)src[group * 128 + k] + 0x8000) >> 16;
+#endif
                     }
                 }
             }
@@ -1942,13 +2407,17 @@ static void apply_independent_coupling(AACContext *ac,
                                        ChannelElement *cce, int index)
 {
     int i;
-    const float gain = cce->coup.gain[index][0];
-    const float *src = cce->ch[0].ret;
-    float *dest = target->ret;
+    const INTFLOAT gain = cce->coup.gain[index][0];
+    const INTFLOAT *src = cce->ch[0].ret;
+    INTFLOAT *dest = target->ret;
     const int len = 1024 << (ac->m4ac.sbr == 1);
 
     for (i = 0; i < len; i++)
+#if CONFIG_FFT_FLOAT
         dest[i] += gain * src[i];
+#else
+        dest[i] += (gain * (int64_t)src[i] + 0x8000) >> 16;
+#endif
 }
 
 /**
@@ -1998,6 +2467,7 @@ static void spectral_to_sample(AACContext *ac)
             if (che) {
                 if (type <= TYPE_CPE)
                     apply_channel_coupling(ac, che, type, i, BEFORE_TNS, apply_dependent_coupling);
+#if CONFIG_FFT_FLOAT
                 if (ac->m4ac.object_type == AOT_AAC_LTP) {
                     if (che->ch[0].ics.predictor_present) {
                         if (che->ch[0].ics.ltp.present)
@@ -2006,6 +2476,7 @@ static void spectral_to_sample(AACContext *ac)
                             apply_ltp(ac, &che->ch[1]);
                     }
                 }
+#endif
                 if (che->ch[0].tns.present)
                     apply_tns(che->ch[0].coeffs, &che->ch[0].tns, &che->ch[0].ics, 1);
                 if (che->ch[1].tns.present)
@@ -2013,6 +2484,7 @@ static void spectral_to_sample(AACContext *ac)
                 if (type <= TYPE_CPE)
                     apply_channel_coupling(ac, che, type, i, BETWEEN_TNS_AND_IMDCT, apply_dependent_coupling);
                 if (type != TYPE_CCE || che->coup.coupling_point == AFTER_IMDCT) {
+#if CONFIG_FFT_FLOAT
                     imdct_and_windowing(ac, &che->ch[0]);
                     if (ac->m4ac.object_type == AOT_AAC_LTP)
                         update_ltp(ac, &che->ch[0]);
@@ -2024,6 +2496,11 @@ static void spectral_to_sample(AACContext *ac)
                     if (ac->m4ac.sbr > 0) {
                         ff_sbr_apply(ac, &che->sbr, type, che->ch[0].ret, che->ch[1].ret);
                     }
+#else
+                    imdct_and_windowing(ac, &che->ch[0]);
+                    if (type == TYPE_CPE)
+                        imdct_and_windowing(ac, &che->ch[1]);
+#endif
                 }
                 if (type <= TYPE_CCE)
                     apply_channel_coupling(ac, che, type, i, AFTER_IMDCT, apply_independent_coupling);
@@ -2051,12 +2528,19 @@ static int parse_adts_frame_header(AACContext *ac, GetBitContext *gb)
             ac->output_configured = OC_NONE;
         }
         if (ac->output_configured != OC_LOCKED) {
-            ac->m4ac.sbr = -1;
-            ac->m4ac.ps  = -1;
+            ac->m4ac.sbr = CONFIG_FFT_FLOAT ? -1 : 0;
+            ac->m4ac.ps  = CONFIG_FFT_FLOAT ? -1 : 0;
         }
         ac->m4ac.sample_rate     = hdr_info.sample_rate;
         ac->m4ac.sampling_index  = hdr_info.sampling_index;
         ac->m4ac.object_type     = hdr_info.object_type;
+#if !CONFIG_FFT_FLOAT
+        if (ac->m4ac.object_type != AOT_AAC_LC) {
+            av_log(ac->avctx, AV_LOG_ERROR, "Audio object type %d is not supported.\n",
+                   ac->m4ac.object_type);
+            return -1;
+        }
+#endif
         if (!ac->avctx->sample_rate)
             ac->avctx->sample_rate = hdr_info.sample_rate;
         if (hdr_info.num_aac_frames == 1) {
@@ -2191,12 +2675,20 @@ static int aac_decode_frame_int(AVCodecContext *avctx, void *data,
     *data_size = data_size_tmp;
 
     if (samples) {
+#if CONFIG_FFT_FLOAT
         if (avctx->sample_fmt == AV_SAMPLE_FMT_FLT)
             ac->fmt_conv.float_interleave(data, (const float **)ac->output_data,
                                           samples, avctx->channels);
         else
             ac->fmt_conv.float_to_int16_interleave(data, (const float **)ac->output_data,
                                                    samples, avctx->channels);
+#else
+        int16_t *out = data;
+        int i, ch;
+        for (i = 0; i < samples; i++)
+            for (ch = 0; ch < avctx->channels; ch++)
+                *out++ = av_clip_int16((ac->output_data[ch][i] + 64) >> 7);
+#endif
     }
 
     if (ac->output_configured && audio_found)
@@ -2235,18 +2727,24 @@ static av_cold int aac_decode_close(AVCodecContext *avctx)
 
     for (i = 0; i < MAX_ELEM_ID; i++) {
         for (type = 0; type < 4; type++) {
+#if CONFIG_FFT_FLOAT
             if (ac->che[type][i])
                 ff_aac_sbr_ctx_close(&ac->che[type][i]->sbr);
+#endif
             av_freep(&ac->che[type][i]);
         }
     }
 
     ff_mdct_end(&ac->mdct);
     ff_mdct_end(&ac->mdct_small);
+#if CONFIG_FFT_FLOAT
     ff_mdct_end(&ac->mdct_ltp);
+#endif
     return 0;
 }
 
+#if CONFIG_FFT_FLOAT
+
 
 #define LOAS_SYNC_WORD   0x2b7       ///< 11 bits LOAS sync word
 
@@ -2540,3 +3038,4 @@ AVCodec ff_aac_latm_decoder = {
     },
     .channel_layouts = aac_channel_layout,
 };
+#endif /* CONFIG_FFT_FLOAT */
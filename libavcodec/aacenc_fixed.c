@@ -0,0 +1,796 @@
+/*
+ * Fixed-point AAC-LC encoder
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Fixed-point AAC-LC encoder.
+ *
+ * Everything done per frame is integer math, so the encoder runs at a
+ * reasonable speed on CPUs without an FPU. Floating point is only used
+ * once, to build tables in init().
+ *
+ * The spectrum comes from the fixed-point MDCT on block-normalized input and
+ * keeps the normalization as a per channel exponent. Scalefactors are derived
+ * from per band allowed noise with the form factor estimate of
+ * 3GPP TS 26.403 5.6.2. The allowed noise is the largest of a global noise
+ * level, the spread masking threshold and the absolute threshold of hearing,
+ * all of it in the log2 domain with 8 fractional bits. Bands below the noise
+ * level are not coded, so raising it drops the quiet bands first. The noise
+ * level follows the bitrate from frame to frame, like lambda does in the
+ * floating-point encoder.
+ *
+ * Only long windows are used and M/S stereo is not.
+ */
+
+#define CONFIG_FFT_FLOAT 0
+
+#include "libavutil/intmath.h"
+#include "avcodec.h"
+#include "put_bits.h"
+#include "dsputil.h"
+#include "fft.h"
+#include "mpeg4audio.h"
+
+#include "aac.h"
+#include "aactab.h"
+
+#define AAC_MAX_CHANNELS 6
+#define MAX_BANDS        51
+
+#define LD_ONE           256            ///< 1.0 in the log2 domain
+#define LD_ZERO          (-(1 << 20))   ///< log2(0)
+#define LD_DB(x)         ((int)((x) * LD_ONE * 0.33219281 + 0.5)) ///< energy dB to log2
+
+/** masking threshold of a band relative to its energy */
+#define MASK_SNR         LD_DB(29)
+
+/** maximum number of times a frame is encoded again when it is too big */
+#define MAX_RETRIES      8
+
+static const uint8_t aac_cb_range [12] = { 0, 3, 3, 3, 3, 9, 9, 8, 8, 13, 13, 17 };
+static const uint8_t aac_cb_maxval[12] = { 0, 1, 1, 2, 2, 4, 4, 7, 7, 12, 12, 16 };
+
+/** default channel configurations, same as the floating-point encoder */
+static const uint8_t aac_chan_configs[6][5] = {
+ {1, TYPE_SCE},
+ {1, TYPE_CPE},
+ {2, TYPE_SCE, TYPE_CPE},
+ {3, TYPE_SCE, TYPE_CPE, TYPE_SCE},
+ {3, TYPE_SCE, TYPE_CPE, TYPE_CPE},
+ {4, TYPE_SCE, TYPE_CPE, TYPE_CPE, TYPE_LFE},
+};
+
+static const uint8_t channel_maps[][AAC_MAX_CHANNELS] = {
+    { 0 },
+    { 0, 1 },
+    { 2, 0, 1 },
+    { 2, 0, 1, 3 },
+    { 2, 0, 1, 3, 4 },
+    { 2, 0, 1, 4, 5, 3 },
+};
+
+typedef struct AACFixedChannel {
+    DECLARE_ALIGNED(16, int16_t, samples)[2048]; ///< previous and current input
+    DECLARE_ALIGNED(16, int,     coeffs)[1024];  ///< MDCT coefficients, scaled by 2^coef_shift
+    int      coef_shift;                         ///< exponent of coeffs relative to the floating-point encoder
+    uint32_t pow34[1024];                        ///< |coeffs|^(3/4) with 6 fractional bits
+    int      qcoefs[1024];                       ///< quantized coefficients
+    int      en_ld[MAX_BANDS];                   ///< band energy
+    int      ff_ld[MAX_BANDS];                   ///< band form factor, sum of sqrt(|coeffs|)
+    int      maxq[MAX_BANDS];                    ///< largest quantized value in each band
+    int      sf_idx[MAX_BANDS];                  ///< scalefactors as coded
+    uint8_t  band_type[MAX_BANDS];
+    int      max_sfb;
+    int      num_swb;
+} AACFixedChannel;
+
+typedef struct AACFixedContext {
+    PutBitContext pb;
+    FFTContext mdct;
+    DSPContext dsp;
+    DECLARE_ALIGNED(16, int16_t, window)[1024];  ///< first half of the sine window
+    DECLARE_ALIGNED(16, int16_t, windowed)[2048];
+
+    int samplerate_index;
+    const uint16_t *swb_offset;
+    int num_swb;
+    int cutoff_band;                             ///< first band above the bandwidth
+    int band_limit;                              ///< first band not coded in the current frame
+
+    int ath_ld[MAX_BANDS];                       ///< absolute threshold of hearing for 16-bit full scale
+    int width_ld[MAX_BANDS];                     ///< number of lines in the band
+    int spread_hi[MAX_BANDS];                    ///< threshold decay towards higher bands
+    int spread_low[MAX_BANDS];                   ///< threshold decay towards lower bands
+
+    int noise_ld;                                ///< allowed noise per line, set by the rate control
+    int frame_bits;                              ///< average number of bits per frame
+    int bit_debt;                                ///< bits spent over the average so far
+    int last_frame;
+
+    AACFixedChannel *ch;
+} AACFixedContext;
+
+/** log2(1 + i/256) with 8 fractional bits */
+static uint8_t ld_tab[256];
+/** (1 + i/256)^(3/4) with 15 fractional bits */
+static uint16_t pow34_tab[257];
+/** i^(3/4) with 6 fractional bits for small i */
+static uint16_t pow34_small[256];
+/** 2^(i/4) with 15 fractional bits */
+static uint16_t pow2_quarter[4];
+/** 2^(i/16) with 30 fractional bits */
+static uint32_t pow2_16th[16];
+
+static av_cold void aac_fixed_tableinit(void)
+{
+    int i;
+
+    for (i = 0; i < 256; i++) {
+        ld_tab[i]      = lrint(log2(1.0 + i / 256.0) * LD_ONE) & 0xFF;
+        pow34_small[i] = lrint(pow(i, 0.75) * 64);
+    }
+    for (i = 0; i <= 256; i++)
+        pow34_tab[i] = lrint(pow(1.0 + i / 256.0, 0.75) * 32768) - (i == 256);
+    for (i = 0; i < 4; i++)
+        pow2_quarter[i] = lrint(pow(2.0, i / 4.0) * 32767);
+    for (i = 0; i < 16; i++)
+        pow2_16th[i] = lrint(pow(2.0, i / 16.0) * (1 << 30));
+}
+
+/**
+ * log2 with 8 fractional bits.
+ */
+static int ld64(uint64_t x)
+{
+    int k;
+
+    if (!x)
+        return LD_ZERO;
+    k = x >> 32 ? av_log2(x >> 32) + 32 : av_log2(x);
+    if (k >= 8)
+        return k * LD_ONE + ld_tab[(x >> (k - 8)) & 0xFF];
+    return k * LD_ONE + ld_tab[(x << (8 - k)) & 0xFF];
+}
+
+/**
+ * x^(3/4) with 6 fractional bits.
+ */
+static uint32_t pow34(uint32_t x)
+{
+    int k, a, b, i, frac;
+    uint32_t m;
+
+    if (x < 256)
+        return pow34_small[x];
+    k = av_log2(x);
+    /* x = (1 + i/256 + frac/2^(k-8)/256) * 2^k */
+    i    = (x >> (k - 8)) & 0xFF;
+    frac = k > 16 ? (x >> (k - 16)) & 0xFF : (x << (16 - k)) & 0xFF;
+    m    = pow34_tab[i] + (((pow34_tab[i + 1] - pow34_tab[i]) * frac) >> 8);
+    /* 2^(3k/4) = 2^a * 2^(b/4) */
+    a = 3 * k >> 2;
+    b = 3 * k & 3;
+    return ((uint64_t)m * pow2_quarter[b]) >> (24 - a);
+}
+
+/**
+ * Quantize one band.
+ * @param r scalefactor relative to the channel's coefficient scale
+ * @return  largest absolute quantized value
+ */
+static int quantize_band(int *out, const int *in, const uint32_t *in34, int size, int r)
+{
+    /* Q34 = 2^(3 * (104 - r) / 16), as in the floating-point encoder */
+    const int e     = 3 * (104 - r);
+    const int shift = 36 - (e >> 4) - 16;
+    const uint32_t mul = pow2_16th[e & 15];
+    int i, maxq = 0;
+
+    if (shift >= 64) {
+        memset(out, 0, size * sizeof(*out));
+        return 0;
+    }
+    for (i = 0; i < size; i++) {
+        uint64_t q = (((uint64_t)in34[i] * mul) >> shift) + 26568; // + 0.4054
+        int v = q >= (8191 << 16) ? 8191 : q >> 16;
+        maxq   = FFMAX(maxq, v);
+        out[i] = in[i] < 0 ? -v : v;
+    }
+    return maxq;
+}
+
+/**
+ * Count the bits of a quantized band, or write it if pb is set.
+ */
+static int encode_band(PutBitContext *pb, const int *q, int size, int cb)
+{
+    const int unsigned_cb = IS_CODEBOOK_UNSIGNED(cb);
+    const int dim   = cb < FIRST_PAIR_BT ? 4 : 2;
+    const int range = aac_cb_range[cb];
+    const int off   = unsigned_cb ? 0 : aac_cb_maxval[cb];
+    const uint8_t  *bits  = ff_aac_spectral_bits [cb - 1];
+    const uint16_t *codes = ff_aac_spectral_codes[cb - 1];
+    int i, j, total = 0;
+
+    for (i = 0; i < size; i += dim) {
+        int idx = 0;
+
+        for (j = 0; j < dim; j++) {
+            int v = q[i + j];
+            if (unsigned_cb) {
+                v = FFABS(v);
+                if (v) {
+                    total++;
+                    if (cb == ESC_BT && v >= 16) {
+                        total += 2 * av_log2(v) - 3;
+                        v = 16;
+                    }
+                }
+            }
+            idx = idx * range + v + off;
+        }
+        total += bits[idx];
+        if (pb) {
+            put_bits(pb, bits[idx], codes[idx]);
+            if (unsigned_cb) {
+                for (j = 0; j < dim; j++)
+                    if (q[i + j])
+                        put_bits(pb, 1, q[i + j] < 0);
+                if (cb == ESC_BT) {
+                    for (j = 0; j < 2; j++) {
+                        int v = FFABS(q[i + j]);
+                        if (v >= 16) {
+                            int len = av_log2(v);
+                            put_bits(pb, len - 4 + 1, (1 << (len - 4 + 1)) - 2);
+                            put_bits(pb, len, v & ((1 << len) - 1));
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return total;
+}
+
+/**
+ * Window, normalize and transform the samples of one channel.
+ */
+static void apply_window_and_mdct(AACFixedContext *s, AACFixedChannel *ch)
+{
+    int i, v, shift;
+    int max = 0;
+
+    for (i = 0; i < 2048; i++)
+        max |= FFABS(ch->samples[i]);
+    /* use the full 16 bits, less one for the transform */
+    shift = max ? 14 - av_log2(max) : 0;
+    if (shift > 0)
+        for (i = 0; i < 2048; i++)
+            s->windowed[i] = ch->samples[i] << shift;
+    else
+        memcpy(s->windowed, ch->samples, sizeof(s->windowed));
+    s->dsp.apply_window_int16(s->windowed, s->windowed, s->window, 2048);
+    s->mdct.mdct_calcw(&s->mdct, ch->coeffs, s->windowed);
+    /* the fixed-point transform outputs 32 times the floating-point one */
+    ch->coef_shift = shift + 5;
+
+    for (i = 0; i < 1024; i++) {
+        v = FFABS(ch->coeffs[i]);
+        ch->pow34[i] = pow34(v);
+    }
+}
+
+/**
+ * Measure band energies and form factors.
+ */
+static void analyze_bands(AACFixedContext *s, AACFixedChannel *ch)
+{
+    int g, i, max = 0, esh;
+
+    for (i = 0; i < s->swb_offset[ch->num_swb]; i++)
+        max |= FFABS(ch->coeffs[i]);
+    /* keep the squares small enough to sum up 96 of them */
+    esh = FFMAX(av_log2(max) - 26, 0);
+
+    for (g = 0; g < ch->num_swb; g++) {
+        uint64_t en = 0;
+        uint32_t form = 0;
+        for (i = s->swb_offset[g]; i < s->swb_offset[g + 1]; i++) {
+            int v = FFABS(ch->coeffs[i]);
+            en   += (uint64_t)(v >> esh) * (v >> esh);
+            form += ff_sqrt(v);
+        }
+        ch->en_ld[g] = en ? ld64(en) + 2 * esh * LD_ONE : LD_ZERO;
+        ch->ff_ld[g] = ld64(form);
+    }
+}
+
+/**
+ * Derive scalefactors from the allowed noise in each band and quantize.
+ */
+static void search_for_quantizers(AACFixedContext *s, AACFixedChannel *ch)
+{
+    int thr[MAX_BANDS];
+    const int sf_base = 4 * ch->coef_shift;
+    int g, last_sf = -1;
+
+    for (g = 0; g < ch->num_swb; g++)
+        thr[g] = ch->en_ld[g] - MASK_SNR;
+    for (g = 1; g < ch->num_swb; g++)
+        thr[g] = FFMAX(thr[g], thr[g - 1] - s->spread_hi[g]);
+    for (g = ch->num_swb - 2; g >= 0; g--)
+        thr[g] = FFMAX(thr[g], thr[g + 1] - s->spread_low[g]);
+    for (g = 0; g < ch->num_swb; g++)
+        thr[g] = FFMAX(thr[g], FFMAX(s->ath_ld[g], s->noise_ld + s->width_ld[g]) +
+                               2 * ch->coef_shift * LD_ONE);
+
+    ch->max_sfb = 0;
+    for (g = 0; g < ch->num_swb; g++) {
+        const int start = s->swb_offset[g];
+        const int size  = s->swb_offset[g + 1] - start;
+        int r, num;
+
+        ch->maxq[g] = 0;
+        if (g >= s->band_limit || thr[g] >= ch->en_ld[g]) {
+            ch->band_type[g] = ZERO_BT;
+            continue;
+        }
+        /* noise = 4/27 * 2^(3/8 (sf - 104)) * form factor */
+        num = 8 * (thr[g] - ch->ff_ld[g] + LD_DB(-8.29)); // 10 log10(4/27)
+        r   = 104 + (num >= 0 ? num / (3 * LD_ONE) : -((-num + 3 * LD_ONE - 1) / (3 * LD_ONE)));
+        r   = av_clip(r, sf_base, sf_base + SCALE_MAX_POS);
+        if (last_sf >= 0)
+            r = av_clip(r, last_sf - SCALE_MAX_DIFF, last_sf + SCALE_MAX_DIFF);
+
+        ch->maxq[g] = quantize_band(ch->qcoefs + start, ch->coeffs + start,
+                                    ch->pow34 + start, size, r);
+        if (!ch->maxq[g]) {
+            ch->band_type[g] = ZERO_BT;
+            continue;
+        }
+        while (ch->maxq[g] >= 8191 && r < sf_base + SCALE_MAX_POS &&
+               (last_sf < 0 || r < last_sf + SCALE_MAX_DIFF)) {
+            r++;
+            ch->maxq[g] = quantize_band(ch->qcoefs + start, ch->coeffs + start,
+                                        ch->pow34 + start, size, r);
+        }
+        ch->band_type[g] = ESC_BT;
+        ch->sf_idx[g]    = r - sf_base;
+        ch->max_sfb      = g + 1;
+        last_sf          = r;
+    }
+}
+
+/**
+ * Pick the codebooks with the fewest bits, counting the section headers.
+ */
+static void choose_codebooks(AACFixedContext *s, AACFixedChannel *ch)
+{
+    int cost[MAX_BANDS][12];
+    uint8_t prev[MAX_BANDS][12];
+    const int section_bits = 4 + 5;
+    int g, cb, best, best_cb = 0;
+
+    for (g = 0; g < ch->max_sfb; g++) {
+        const int start = s->swb_offset[g];
+        const int size  = s->swb_offset[g + 1] - start;
+        int prev_best = INT_MAX, prev_cb = 0;
+
+        if (g) {
+            for (cb = 0; cb < 12; cb++) {
+                if (cost[g - 1][cb] < prev_best) {
+                    prev_best = cost[g - 1][cb];
+                    prev_cb   = cb;
+                }
+            }
+        }
+        for (cb = 0; cb < 12; cb++) {
+            int bits;
+
+            cost[g][cb] = INT_MAX;
+            if ((ch->band_type[g] == ZERO_BT) != !cb)
+                continue;
+            if (cb && aac_cb_maxval[cb] < FFMIN(ch->maxq[g], 16))
+                continue;
+            bits = cb ? encode_band(NULL, ch->qcoefs + start, size, cb) : 0;
+            if (!g) {
+                cost[g][cb] = bits + section_bits;
+                prev[g][cb] = cb;
+            } else if (cost[g - 1][cb] != INT_MAX &&
+                       cost[g - 1][cb] <= prev_best + section_bits) {
+                cost[g][cb] = bits + cost[g - 1][cb];
+                prev[g][cb] = cb;
+            } else {
+                cost[g][cb] = bits + prev_best + section_bits;
+                prev[g][cb] = prev_cb;
+            }
+        }
+    }
+
+    if (!ch->max_sfb)
+        return;
+    best = INT_MAX;
+    for (cb = 0; cb < 12; cb++) {
+        if (cost[ch->max_sfb - 1][cb] < best) {
+            best    = cost[ch->max_sfb - 1][cb];
+            best_cb = cb;
+        }
+    }
+    for (g = ch->max_sfb - 1; g >= 0; g--) {
+        ch->band_type[g] = best_cb;
+        best_cb = prev[g][best_cb];
+    }
+}
+
+/**
+ * Encode ics_info element for a long window.
+ * @see Table 4.6 (syntax of ics_info)
+ */
+static void put_ics_info(AACFixedContext *s, AACFixedChannel *ch)
+{
+    put_bits(&s->pb, 1, 0);                  // ics_reserved bit
+    put_bits(&s->pb, 2, ONLY_LONG_SEQUENCE);
+    put_bits(&s->pb, 1, 0);                  // sine window
+    put_bits(&s->pb, 6, ch->max_sfb);
+    put_bits(&s->pb, 1, 0);                  // no prediction
+}
+
+/**
+ * Encode section data.
+ * @see Table 4.52 (syntax of section_data)
+ */
+static void encode_band_info(AACFixedContext *s, AACFixedChannel *ch)
+{
+    int g = 0;
+
+    while (g < ch->max_sfb) {
+        int cb  = ch->band_type[g];
+        int run = 0;
+
+        while (g < ch->max_sfb && ch->band_type[g] == cb) {
+            run++;
+            g++;
+        }
+        put_bits(&s->pb, 4, cb);
+        while (run >= 31) {
+            put_bits(&s->pb, 5, 31);
+            run -= 31;
+        }
+        put_bits(&s->pb, 5, run);
+    }
+}
+
+/**
+ * Encode scalefactors.
+ */
+static void encode_scale_factors(AACFixedContext *s, AACFixedChannel *ch, int global_gain)
+{
+    int g, off = global_gain;
+
+    for (g = 0; g < ch->max_sfb; g++) {
+        if (ch->band_type[g] != ZERO_BT) {
+            int diff = ch->sf_idx[g] - off + SCALE_DIFF_ZERO;
+            off = ch->sf_idx[g];
+            put_bits(&s->pb, ff_aac_scalefactor_bits[diff], ff_aac_scalefactor_code[diff]);
+        }
+    }
+}
+
+/**
+ * Encode one channel of audio data.
+ */
+static void encode_individual_channel(AACFixedContext *s, AACFixedChannel *ch,
+                                      int common_window)
+{
+    int g, global_gain = 0;
+
+    for (g = 0; g < ch->max_sfb; g++) {
+        if (ch->band_type[g] != ZERO_BT) {
+            global_gain = ch->sf_idx[g];
+            break;
+        }
+    }
+    put_bits(&s->pb, 8, global_gain);
+    if (!common_window)
+        put_ics_info(s, ch);
+    encode_band_info(s, ch);
+    encode_scale_factors(s, ch, global_gain);
+    put_bits(&s->pb, 1, 0); //pulse
+    put_bits(&s->pb, 1, 0); //tns
+    put_bits(&s->pb, 1, 0); //ssr
+    for (g = 0; g < ch->max_sfb; g++) {
+        if (ch->band_type[g] != ZERO_BT) {
+            const int start = s->swb_offset[g];
+            encode_band(&s->pb, ch->qcoefs + start, s->swb_offset[g + 1] - start,
+                        ch->band_type[g]);
+        }
+    }
+}
+
+/**
+ * Make AAC audio config object.
+ * @see 1.6.2.1 "Syntax - AudioSpecificConfig"
+ */
+static void put_audio_specific_config(AVCodecContext *avctx)
+{
+    PutBitContext pb;
+    AACFixedContext *s = avctx->priv_data;
+
+    init_put_bits(&pb, avctx->extradata, avctx->extradata_size*8);
+    put_bits(&pb, 5, 2); //object type - AAC-LC
+    put_bits(&pb, 4, s->samplerate_index); //sample rate index
+    put_bits(&pb, 4, avctx->channels);
+    //GASpecificConfig
+    put_bits(&pb, 1, 0); //frame length - 1024 samples
+    put_bits(&pb, 1, 0); //does not depend on core coder
+    put_bits(&pb, 1, 0); //is not extension
+
+    //Explicitly Mark SBR absent
+    put_bits(&pb, 11, 0x2b7); //sync extension
+    put_bits(&pb, 5,  AOT_SBR);
+    put_bits(&pb, 1,  0);
+    flush_put_bits(&pb);
+}
+
+/**
+ * Calculate ATH value for given frequency.
+ * Borrowed from Lame.
+ */
+static av_cold float ath(float f, float add)
+{
+    f /= 1000.0f;
+    return    3.64 * pow(f, -0.8)
+            - 6.8  * exp(-0.6  * (f - 3.4) * (f - 3.4))
+            + 6.0  * exp(-0.15 * (f - 8.7) * (f - 8.7))
+            + (0.6 + 0.04 * add) * 0.001 * f * f * f * f;
+}
+
+static av_cold float calc_bark(float f)
+{
+    return 13.3f * atanf(0.00076f * f) + 3.5f * atanf((f / 7500.0f) * (f / 7500.0f));
+}
+
+static av_cold void init_band_tables(AVCodecContext *avctx, AACFixedContext *s)
+{
+    const float line_to_frequency = avctx->sample_rate / 2048.0f;
+    float barks[MAX_BANDS];
+    int g, i;
+
+    for (g = 0; g < s->num_swb; g++) {
+        int start = s->swb_offset[g], end = s->swb_offset[g + 1];
+        float minath = ath(start * line_to_frequency, 4);
+
+        for (i = start + 1; i < end; i++)
+            minath = FFMIN(minath, ath(i * line_to_frequency, 4));
+        /* a full scale sine at 96 dB SPL has about (32768 * 512)^2 energy */
+        s->width_ld[g] = lrintf(log2(end - start) * LD_ONE);
+        s->ath_ld[g]   = s->width_ld[g] + lrintf((48 + (minath - 96) * 0.33219281) * LD_ONE);
+        barks[g] = calc_bark((start + end - 1) * 0.5f * line_to_frequency);
+    }
+    /* 15 dB per bark upwards and 30 dB downwards, like the 3GPP model */
+    s->spread_hi[0] = s->spread_low[s->num_swb - 1] = 0;
+    for (g = 1; g < s->num_swb; g++) {
+        float width = barks[g] - barks[g - 1];
+        s->spread_hi [g]     = LD_DB(15.0f * width);
+        s->spread_low[g - 1] = LD_DB(30.0f * width);
+    }
+}
+
+static av_cold int aac_fixed_encode_init(AVCodecContext *avctx)
+{
+    AACFixedContext *s = avctx->priv_data;
+    int i, ch, cutoff;
+
+    avctx->frame_size = 1024;
+
+    for (i = 0; i < 13; i++)
+        if (avctx->sample_rate == ff_mpeg4audio_sample_rates[i])
+            break;
+    if (i == 13) {
+        av_log(avctx, AV_LOG_ERROR, "Unsupported sample rate %d\n", avctx->sample_rate);
+        return -1;
+    }
+    if (avctx->channels < 1 || avctx->channels > AAC_MAX_CHANNELS) {
+        av_log(avctx, AV_LOG_ERROR, "Unsupported number of channels: %d\n", avctx->channels);
+        return -1;
+    }
+    if (avctx->profile != FF_PROFILE_UNKNOWN && avctx->profile != FF_PROFILE_AAC_LOW) {
+        av_log(avctx, AV_LOG_ERROR, "Unsupported profile %d\n", avctx->profile);
+        return -1;
+    }
+    if (1024.0 * avctx->bit_rate / avctx->sample_rate > 6144 * avctx->channels) {
+        av_log(avctx, AV_LOG_ERROR, "Too many bits per frame requested\n");
+        return -1;
+    }
+    s->samplerate_index = i;
+    s->swb_offset       = ff_swb_offset_1024[i];
+    s->num_swb          = ff_aac_num_swb_1024[i];
+
+    dsputil_init(&s->dsp, avctx);
+    if (ff_mdct_init(&s->mdct, 11, 0, 1.0) < 0)
+        return AVERROR(ENOMEM);
+    aac_fixed_tableinit();
+    for (i = 0; i < 1024; i++)
+        s->window[i] = lrint(sin(M_PI / 2048 * (i + 0.5)) * 32767);
+
+    s->ch = av_mallocz(sizeof(*s->ch) * avctx->channels);
+    avctx->extradata      = av_mallocz(5 + FF_INPUT_BUFFER_PADDING_SIZE);
+    if (!s->ch || !avctx->extradata)
+        return AVERROR(ENOMEM);
+    avctx->extradata_size = 5;
+    put_audio_specific_config(avctx);
+
+    init_band_tables(avctx, s);
+
+    /* same bandwidth rule of thumb as for the other fixed bitrate encoders */
+    cutoff = avctx->cutoff;
+    if (!cutoff)
+        cutoff = 3000 + avctx->bit_rate / avctx->channels / 4;
+    cutoff = FFMIN(cutoff, avctx->sample_rate / 2);
+    for (s->cutoff_band = 0; s->cutoff_band < s->num_swb; s->cutoff_band++)
+        if (s->swb_offset[s->cutoff_band] * avctx->sample_rate / 2048 >= cutoff)
+            break;
+
+    for (ch = 0; ch < avctx->channels; ch++)
+        s->ch[ch].num_swb = s->num_swb;
+
+    s->frame_bits = (int64_t)avctx->bit_rate * 1024 / avctx->sample_rate;
+    /* noise level in dB below a full scale sine */
+    if (avctx->flags & CODEC_FLAG_QSCALE)
+        s->noise_ld = 48 * LD_ONE - LD_DB((float)avctx->global_quality / FF_QP2LAMBDA);
+    else
+        s->noise_ld = 48 * LD_ONE - LD_DB(70);
+
+    return 0;
+}
+
+static int aac_fixed_encode_frame(AVCodecContext *avctx,
+                                  uint8_t *frame, int buf_size, void *data)
+{
+    AACFixedContext *s = avctx->priv_data;
+    const uint8_t *chan_map = aac_chan_configs[avctx->channels - 1];
+    const int16_t *samples = data;
+    int i, ch, el, start_ch, retries = 0;
+    int chan_el_counter[4];
+    int frame_bits;
+
+    if (s->last_frame)
+        return 0;
+
+    for (ch = 0; ch < avctx->channels; ch++) {
+        AACFixedChannel *c = &s->ch[ch];
+        const int src = channel_maps[avctx->channels - 1][ch];
+
+        memcpy(c->samples, c->samples + 1024, 1024 * sizeof(c->samples[0]));
+        if (samples) {
+            for (i = 0; i < 1024; i++)
+                c->samples[1024 + i] = samples[i * avctx->channels + src];
+        } else {
+            memset(c->samples + 1024, 0, 1024 * sizeof(c->samples[0]));
+        }
+        apply_window_and_mdct(s, c);
+    }
+
+    start_ch = 0;
+    for (el = 0; el < chan_map[0]; el++) {
+        int chans = chan_map[el + 1] == TYPE_CPE ? 2 : 1;
+        for (ch = start_ch; ch < start_ch + chans; ch++) {
+            /* same LFE band limit as the floating-point encoder */
+            if (chan_map[el + 1] == TYPE_LFE)
+                s->ch[ch].num_swb = FFMIN(s->num_swb, 12);
+            analyze_bands(s, &s->ch[ch]);
+        }
+        start_ch += chans;
+    }
+
+    s->band_limit = s->cutoff_band;
+    do {
+        init_put_bits(&s->pb, frame, buf_size * 8);
+        memset(chan_el_counter, 0, sizeof(chan_el_counter));
+        start_ch = 0;
+        for (el = 0; el < chan_map[0]; el++) {
+            const int tag   = chan_map[el + 1];
+            const int chans = tag == TYPE_CPE ? 2 : 1;
+            AACFixedChannel *c = &s->ch[start_ch];
+
+            put_bits(&s->pb, 3, tag);
+            put_bits(&s->pb, 4, chan_el_counter[tag]++);
+            for (ch = 0; ch < chans; ch++) {
+                search_for_quantizers(s, &c[ch]);
+                choose_codebooks(s, &c[ch]);
+            }
+            if (chans == 2) {
+                /* both channels use long sine windows, so they can share ics_info */
+                int max_sfb = FFMAX(c[0].max_sfb, c[1].max_sfb);
+                for (ch = 0; ch < 2; ch++) {
+                    for (i = c[ch].max_sfb; i < max_sfb; i++)
+                        c[ch].band_type[i] = ZERO_BT;
+                    c[ch].max_sfb = max_sfb;
+                }
+                put_bits(&s->pb, 1, 1); // common_window
+                put_ics_info(s, &c[0]);
+                put_bits(&s->pb, 2, 0); // no M/S
+            }
+            for (ch = 0; ch < chans; ch++)
+                encode_individual_channel(s, &c[ch], chans == 2);
+            start_ch += chans;
+        }
+
+        frame_bits = put_bits_count(&s->pb);
+        if (frame_bits <= 6144 * avctx->channels - 3)
+            break;
+        if (retries++ < MAX_RETRIES) {
+            s->noise_ld += ld64(frame_bits) - ld64(6144 * avctx->channels - 3) + LD_ONE;
+        } else {
+            /* the frame has to fit into the buffer of the decoder, drop
+             * the highest coded band until it does */
+            int max_sfb = 0;
+            for (ch = 0; ch < avctx->channels; ch++)
+                max_sfb = FFMAX(max_sfb, s->ch[ch].max_sfb);
+            if (!max_sfb)
+                break;
+            s->band_limit = max_sfb - 1;
+        }
+    } while (1);
+
+    put_bits(&s->pb, 3, TYPE_END);
+    flush_put_bits(&s->pb);
+    avctx->frame_bits = put_bits_count(&s->pb);
+
+    // rate control stuff
+    if (!(avctx->flags & CODEC_FLAG_QSCALE)) {
+        int target;
+
+        s->bit_debt = av_clip(s->bit_debt + avctx->frame_bits - s->frame_bits,
+                              -8 * s->frame_bits, 8 * s->frame_bits);
+        target = s->frame_bits - s->bit_debt / 16;
+        s->noise_ld += av_clip(2 * (ld64(avctx->frame_bits) - ld64(target)),
+                               -LD_ONE, LD_ONE);
+        s->noise_ld  = av_clip(s->noise_ld, 48 * LD_ONE - LD_DB(120), 48 * LD_ONE);
+    }
+
+    if (!data)
+        s->last_frame = 1;
+    return put_bits_count(&s->pb) >> 3;
+}
+
+static av_cold int aac_fixed_encode_end(AVCodecContext *avctx)
+{
+    AACFixedContext *s = avctx->priv_data;
+
+    ff_mdct_end(&s->mdct);
+    av_freep(&s->ch);
+    av_freep(&avctx->extradata);
+    return 0;
+}
+
+AVCodec ff_aac_fixed_encoder = {
+    "aac_fixed",
+    AVMEDIA_TYPE_AUDIO,
+    CODEC_ID_AAC,
+    sizeof(AACFixedContext),
+    aac_fixed_encode_init,
+    aac_fixed_encode_frame,
+    aac_fixed_encode_end,
+    .capabilities = CODEC_CAP_DELAY,
+    .sample_fmts = (const enum AVSampleFormat[]){AV_SAMPLE_FMT_S16,AV_SAMPLE_FMT_NONE},
+    .long_name = NULL_IF_CONFIG_SMALL("Advanced Audio Coding (fixed-point LC)"),
+};
@@ -238,6 +238,7 @@ void avcodec_register_all(void)
     /* audio codecs */
     REGISTER_ENCDEC  (AAC, aac);
     REGISTER_DECODER (AAC_LATM, aac_latm);
+    REGISTER_ENCDEC  (AAC_FIXED, aac_fixed);
     REGISTER_ENCDEC  (AC3, ac3);
     REGISTER_ENCODER (AC3_FIXED, ac3_fixed); //deprecated, just for libav compatibility
 //    REGISTER_ENCODER (AC3_FLOAT, ac3_float); dont remove dont outcomment, for configure
@@ -373,10 +374,9 @@ void avcodec_register_all(void)
     REGISTER_ENCODER (LIBAACPLUS, libaacplus);
     REGISTER_DECODER (LIBCELT, libcelt);
     REGISTER_ENCDEC  (LIBDIRAC, libdirac);
-    REGISTER_DECODER (LIBDM365_H264, libdm365_h264);
-    REGISTER_ENCODER (LIBDM365_H264, libdm365_h264);
-    REGISTER_ENCODER (LIBDM365_MPEG4, libdm365_mpeg4);
-    REGISTER_ENCODER (LIBDM365_JPEG, libdm365_jpeg);
+    REGISTER_ENCDEC  (LIBDM365_H264, libdm365_h264);
+    REGISTER_ENCDEC  (LIBDM365_MPEG4, libdm365_mpeg4);
+    REGISTER_ENCDEC  (LIBDM365_JPEG, libdm365_jpeg);
     REGISTER_ENCODER (LIBFAAC, libfaac);
     REGISTER_ENCDEC  (LIBGSM, libgsm);
     REGISTER_ENCDEC  (LIBGSM_MS, libgsm_ms);
@@ -27,8 +27,15 @@ void ff_simple_idct_add_armv5te(uint8_t *dest, int line_size, DCTELEM *data);
 
 void ff_prefetch_arm(void *mem, int stride, int h);
 
+void ff_put_h264_chroma_mc8_armv5te(uint8_t *, uint8_t *, int, int, int, int);
+void ff_put_h264_chroma_mc4_armv5te(uint8_t *, uint8_t *, int, int, int, int);
+void ff_avg_h264_chroma_mc8_armv5te(uint8_t *, uint8_t *, int, int, int, int);
+void ff_avg_h264_chroma_mc4_armv5te(uint8_t *, uint8_t *, int, int, int, int);
+
 void av_cold ff_dsputil_init_armv5te(DSPContext* c, AVCodecContext *avctx)
 {
+    const int high_bit_depth = avctx->codec_id == CODEC_ID_H264 && avctx->bits_per_raw_sample > 8;
+
     if (!avctx->lowres && (avctx->idct_algo == FF_IDCT_AUTO ||
                            avctx->idct_algo == FF_IDCT_SIMPLEARMV5TE)) {
         c->idct_put              = ff_simple_idct_put_armv5te;
@@ -38,4 +45,11 @@ void av_cold ff_dsputil_init_armv5te(DSPContext* c, AVCodecContext *avctx)
     }
 
     c->prefetch = ff_prefetch_arm;
+
+    if (CONFIG_H264_DECODER && !high_bit_depth) {
+        c->put_h264_chroma_pixels_tab[0] = ff_put_h264_chroma_mc8_armv5te;
+        c->put_h264_chroma_pixels_tab[1] = ff_put_h264_chroma_mc4_armv5te;
+        c->avg_h264_chroma_pixels_tab[0] = ff_avg_h264_chroma_mc8_armv5te;
+        c->avg_h264_chroma_pixels_tab[1] = ff_avg_h264_chroma_mc4_armv5te;
+    }
 }
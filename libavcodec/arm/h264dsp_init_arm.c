@@ -23,6 +23,33 @@
 #include "libavcodec/dsputil.h"
 #include "libavcodec/h264dsp.h"
 
+void ff_h264_v_loop_filter_luma_armv5te(uint8_t *pix, int stride, int alpha,
+                                        int beta, int8_t *tc0);
+void ff_h264_h_loop_filter_luma_armv5te(uint8_t *pix, int stride, int alpha,
+                                        int beta, int8_t *tc0);
+void ff_h264_v_loop_filter_chroma_armv5te(uint8_t *pix, int stride, int alpha,
+                                          int beta, int8_t *tc0);
+void ff_h264_h_loop_filter_chroma_armv5te(uint8_t *pix, int stride, int alpha,
+                                          int beta, int8_t *tc0);
+
+void ff_h264_idct_add_armv5te(uint8_t *dst, DCTELEM *block, int stride);
+void ff_h264_idct_dc_add_armv5te(uint8_t *dst, DCTELEM *block, int stride);
+void ff_h264_idct_add16_armv5te(uint8_t *dst, const int *block_offset,
+                                DCTELEM *block, int stride,
+                                const uint8_t nnzc[6*8]);
+void ff_h264_idct_add16intra_armv5te(uint8_t *dst, const int *block_offset,
+                                     DCTELEM *block, int stride,
+                                     const uint8_t nnzc[6*8]);
+void ff_h264_idct_add8_armv5te(uint8_t **dest, const int *block_offset,
+                               DCTELEM *block, int stride,
+                               const uint8_t nnzc[6*8]);
+
+void ff_h264_idct8_add_armv5te(uint8_t *dst, DCTELEM *block, int stride);
+void ff_h264_idct8_dc_add_armv5te(uint8_t *dst, DCTELEM *block, int stride);
+void ff_h264_idct8_add4_armv5te(uint8_t *dst, const int *block_offset,
+                                DCTELEM *block, int stride,
+                                const uint8_t nnzc[6*8]);
+
 void ff_h264_v_loop_filter_luma_neon(uint8_t *pix, int stride, int alpha,
                                      int beta, int8_t *tc0);
 void ff_h264_h_loop_filter_luma_neon(uint8_t *pix, int stride, int alpha,
@@ -94,6 +121,24 @@ void ff_h264_idct8_add4_neon(uint8_t *dst, const int *block_offset,
 
 void ff_h264dsp_init_arm(H264DSPContext *c, const int bit_depth)
 {
+    if (HAVE_ARMV5TE) {
+        if (bit_depth == 8) {
+            c->h264_v_loop_filter_luma   = ff_h264_v_loop_filter_luma_armv5te;
+            c->h264_h_loop_filter_luma   = ff_h264_h_loop_filter_luma_armv5te;
+            c->h264_v_loop_filter_chroma = ff_h264_v_loop_filter_chroma_armv5te;
+            c->h264_h_loop_filter_chroma = ff_h264_h_loop_filter_chroma_armv5te;
+
+            c->h264_idct_add        = ff_h264_idct_add_armv5te;
+            c->h264_idct_dc_add     = ff_h264_idct_dc_add_armv5te;
+            c->h264_idct_add16      = ff_h264_idct_add16_armv5te;
+            c->h264_idct_add16intra = ff_h264_idct_add16intra_armv5te;
+            c->h264_idct_add8       = ff_h264_idct_add8_armv5te;
+            c->h264_idct8_add       = ff_h264_idct8_add_armv5te;
+            c->h264_idct8_dc_add    = ff_h264_idct8_dc_add_armv5te;
+            c->h264_idct8_add4      = ff_h264_idct8_add4_armv5te;
+        }
+    }
+
     if (HAVE_NEON) {
         if (bit_depth == 8) {
             c->h264_v_loop_filter_luma   = ff_h264_v_loop_filter_luma_neon;
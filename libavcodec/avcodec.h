@@ -2844,6 +2844,8 @@ typedef struct AVCodecContext {
      * Which multithreading methods to use.
      * Use of FF_THREAD_FRAME will increase decoding delay by one frame per thread,
      * so clients which cannot provide future frames should not use it.
+     * FF_THREAD_FRAME_SLICE implies both other methods and is never used
+     * unless set explicitly.
      *
      * - encoding: Set by user, otherwise the default is used.
      * - decoding: Set by user, otherwise the default is used.
@@ -2851,6 +2853,7 @@ typedef struct AVCodecContext {
     int thread_type;
 #define FF_THREAD_FRAME   1 //< Decode more than one frame at once
 #define FF_THREAD_SLICE   2 //< Decode more than one part of a single frame at once
+#define FF_THREAD_FRAME_SLICE 4 //< Also decode the slices of each frame thread at once
 
     /**
      * Which multithreading methods are in use by the codec.
@@ -2902,7 +2905,24 @@ typedef struct AVCodecContext {
     int64_t pts_correction_last_pts;       /// PTS of the last frame
     int64_t pts_correction_last_dts;       /// DTS of the last frame
 
+    /**
+     * Priority of the jobs of this context on the shared thread pool,
+     * jobs of contexts with higher values are started first.
+     * @see avcodec_thread_pool_init()
+     * - encoding: Set by user.
+     * - decoding: Set by user.
+     */
+    int thread_priority;
 
+    /**
+     * Number of threads estimating the motion of input pictures ahead of
+     * encoding them, 0 disables this lookahead.
+     * The vectors found on half resolution pictures replace the pre-pass
+     * and are refined with a small diamond (dia_size 1) in P-frames.
+     * - encoding: Set by user.
+     * - decoding: unused
+     */
+    int me_lookahead_threads;
 } AVCodecContext;
 
 /**
@@ -3684,6 +3704,29 @@ int avcodec_default_execute(AVCodecContext *c, int (*func)(AVCodecContext *c2, v
 int avcodec_default_execute2(AVCodecContext *c, int (*func)(AVCodecContext *c2, void *arg2, int, int),void *arg, int *ret, int count);
 //FIXME func typedef
 
+/**
+ * Start a thread pool shared by all codec contexts opened afterwards.
+ *
+ * The slice threads of these contexts, and the slice jobs of frame
+ * threaded decoders, then run on the workers of the pool instead of
+ * threads of their own, so that many open contexts do not start more
+ * threads than there are cores. thread_count of a context still limits
+ * how many threads work on one of its frames, and jobs of contexts with
+ * a higher thread_priority are started first.
+ * Frame threads are not pooled, as they block waiting for each other.
+ *
+ * @param thread_count number of worker threads, 0 for one per CPU
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int avcodec_thread_pool_init(int thread_count);
+
+/**
+ * Stop the workers of the shared thread pool.
+ * Contexts opened while it existed run their jobs in the calling thread
+ * afterwards, they should be closed first.
+ */
+void avcodec_thread_pool_free(void);
+
 #if FF_API_AVCODEC_OPEN
 /**
  * Initialize the AVCodecContext to use the given AVCodec. Prior to using this
@@ -3837,6 +3880,36 @@ int avcodec_decode_video2(AVCodecContext *avctx, AVFrame *picture,
                          int *got_picture_ptr,
                          AVPacket *avpkt);
 
+/**
+ * Decode video without waiting for frame threads.
+ *
+ * With frame threading, this returns the oldest decoded frame only if
+ * its thread has already finished, and passes avpkt to the next thread
+ * only if that thread is idle, so the caller never waits for the slowest
+ * thread. Without frame threading, it is the same as avcodec_decode_video2().
+ *
+ * Frames are returned in the same order as with avcodec_decode_video2(),
+ * and both functions can be used on the same context. Use
+ * avcodec_decode_video2() with empty packets to drain the decoder at the
+ * end of the stream.
+ *
+ * @param avctx the codec context
+ * @param[out] picture the decoded frame, as with avcodec_decode_video2()
+ * @param[in] avpkt the packet to decode, or NULL to only return a
+ *            finished frame
+ * @param[out] got_picture_ptr nonzero if a frame was returned
+ * @return AVERROR(EAGAIN) if all threads are busy, in which case no frame
+ *         was returned and the packet must be passed again later,
+ *         otherwise avpkt->size if the packet was taken, 0 if avpkt is NULL,
+ *         or a negative error code from decoding the oldest frame.
+ *         Unless AVERROR(EAGAIN) is returned, the packet was taken even on
+ *         error, so it must not be passed again; with frame threading the
+ *         error belongs to an earlier packet.
+ */
+int avcodec_decode_video_nonblock(AVCodecContext *avctx, AVFrame *picture,
+                                  int *got_picture_ptr,
+                                  AVPacket *avpkt);
+
 /**
  * Decode a subtitle message.
  * Return a negative value on error, otherwise return the number of bytes used.
@@ -30,6 +30,7 @@
 #define BITS 16
 #define FLOATFMT "%.18e"
 #define FIXEDFMT "%6d"
+#define FIXED32FMT "%11d"
 
 static int clip_f15(int v)
 {
@@ -38,9 +39,18 @@ static int clip_f15(int v)
            v;
 }
 
+static int clip_f31(long long v)
+{
+    return v < -2147483647LL ? -2147483647 :
+           v >  2147483647LL ?  2147483647 :
+           v;
+}
+
 static void printval(double val, int fixed)
 {
-    if (fixed)
+    if (fixed == 32)
+        printf(" "FIXED32FMT",", clip_f31(llrint(val * 2147483648.0)));
+    else if (fixed)
         printf(" "FIXEDFMT",", clip_f15(lrint(val * (double)(1<<15))));
     else
         printf(" "FLOATFMT",", val);
@@ -52,10 +62,14 @@ int main(int argc, char *argv[])
     int i, j;
     int do_sin = argc > 1 && !strcmp(argv[1], "sin");
     int fixed  = argc > 1 &&  strstr(argv[1], "fixed");
+    int fixed_32 = argc > 1 && strstr(argv[1], "fixed_32");
     double (*func)(double) = do_sin ? sin : cos;
 
     printf("/* This file was automatically generated. */\n");
     printf("#define CONFIG_FFT_FLOAT %d\n", !fixed);
+    printf("#define CONFIG_FFT_FIXED_32 %d\n", fixed_32);
+    if (fixed_32)
+        fixed = 32;
     printf("#include \"libavcodec/%s\"\n", do_sin ? "rdft.h" : "fft.h");
     for (i = 4; i <= BITS; i++) {
         int m = 1 << i;
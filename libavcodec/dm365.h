@@ -0,0 +1,159 @@
+/*
+ * DM365 hardware codec support
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVCODEC_DM365_H
+#define AVCODEC_DM365_H
+
+/**
+ * @file
+ * Public interface of the libdm365 codecs for applications that manage
+ * the physically contiguous (CMEM) memory shared with the coprocessors.
+ */
+
+#include "avcodec.h"
+
+/**
+ * Allocate the payload of a packet from the CMEM pool.
+ *
+ * Packets allocated this way are passed by the libdm365 decoders to the
+ * hardware without copying, unless disabled by the "zerocopy" decoder
+ * option. Packets in other memory are copied into an internal CMEM buffer
+ * first. The payload is freed by av_free_packet().
+ *
+ * @param pkt  packet to initialize
+ * @param size wanted payload size, padding is added behind it
+ * @return 0 on success, a negative AVERROR on failure
+ */
+int av_dm365_new_packet(AVPacket *pkt, int size);
+
+/**
+ * Declare a CMEM block allocated by the application as picture memory.
+ *
+ * The libdm365 encoders read pictures lying completely in registered
+ * blocks in place and copy all other pictures into CMEM first. The
+ * pictures of av_dm365_default_get_buffer() are registered already, so
+ * decoded pictures are passed from a libdm365 decoder to a libdm365
+ * encoder without a copy.
+ *
+ * @return 0 on success, a negative AVERROR on failure
+ */
+int av_dm365_register_buffer(void *mem, int size);
+
+/**
+ * Remove a block registered by av_dm365_register_buffer(), this has to be
+ * done before it is freed.
+ */
+void av_dm365_unregister_buffer(void *mem);
+
+/**
+ * get_buffer() used by the libdm365 decoders.
+ *
+ * The decoders obtain every picture they pass to the coprocessor through
+ * AVCodecContext.get_buffer() and install this function there if the
+ * application did not override it. It hands out CMEM blocks from a pool
+ * of "output_buffers" pictures owned by the decoder.
+ *
+ * A returned picture stays valid until the decoder passes it to
+ * AVCodecContext.release_buffer(), which happens only after the codec
+ * stopped using it as a reference and it was returned for display.
+ * Applications which keep pictures longer, e.g. to feed them to a libdm365
+ * encoder without copying, override release_buffer() and call
+ * av_dm365_default_release_buffer() once they are done with the picture,
+ * at the latest before closing the decoder. Overridden get_buffer()
+ * callbacks must return CMEM memory with the layout of this function.
+ */
+int av_dm365_default_get_buffer(AVCodecContext *avctx, AVFrame *pic);
+
+/**
+ * Return a picture obtained by av_dm365_default_get_buffer() to the pool.
+ */
+void av_dm365_default_release_buffer(AVCodecContext *avctx, AVFrame *pic);
+
+/**
+ * Fetch the latest JPEG snapshot of a libdm365 video encoder.
+ *
+ * With the "snapshot_interval" option set to N, the libdm365_h264 and
+ * libdm365_mpeg4 encoders pass every Nth picture also to the hardware
+ * JPEG encoder, reading it from the same buffer as the video encoder,
+ * with the quality given by "snapshot_quality". The snapshot is available
+ * after the avcodec_encode_video() call which submitted the picture, also
+ * with "async_encode" where the video packet comes one call later. Only
+ * the latest snapshot is kept, older ones are dropped if not fetched.
+ *
+ * The packet payload lives in CMEM and is freed by av_free_packet(), pts
+ * is the pts of the source picture.
+ *
+ * @return 0 if a snapshot was returned in pkt, AVERROR(EAGAIN) if there is
+ *         none pending, AVERROR(EINVAL) if avctx is not a libdm365 video
+ *         encoder
+ */
+int av_dm365_get_snapshot(AVCodecContext *avctx, AVPacket *pkt);
+
+/**
+ * Get the macroblock SAD values of the last picture returned by a
+ * libdm365_h264 encoder opened with the "mb_info" option.
+ *
+ * With "mb_info" the encoder also exports the motion vectors found by the
+ * hardware in AVCodecContext.coded_frame: motion_val[0] holds one vector
+ * in quarter pels per 16x16 macroblock (motion_subsample_log2 is 4), with
+ * a stride of (width + 15) / 16 vectors. The SAD table has the same layout
+ * and gives the luma sum of absolute differences of every macroblock to
+ * its prediction, which together with the vectors allows motion detection
+ * without analyzing the pictures on the CPU. Both stay valid until the next
+ * call to avcodec_encode_video().
+ *
+ * @return the SAD table, NULL if not available
+ */
+const uint32_t *av_dm365_get_mb_sad(AVCodecContext *avctx);
+
+/**
+ * maximum number of regions of interest of the H.264 encoder
+ */
+#define AV_DM365_MAX_ROI 5
+
+/**
+ * Region of interest of the libdm365_h264 encoder.
+ */
+typedef struct AVDM365ROI {
+    int x, y;           ///< top left corner in pixels
+    int w, h;           ///< size in pixels
+    /**
+     * Negative values mark a region which gets more bits than the rest of
+     * the picture, positive values a background region which gets less.
+     * The magnitude is passed to the codec as the priority of the region.
+     */
+    int qp_offset;
+} AVDM365ROI;
+
+/**
+ * Set the regions of interest of a libdm365_h264 encoder.
+ *
+ * The regions apply to the pictures passed to avcodec_encode_video() after
+ * this call, until they are changed again. nb_roi 0 clears them. The
+ * initial regions can also be given by the "roi" option as a list of
+ * x,y,w,h,qp_offset separated by '|'.
+ *
+ * @return 0 on success, AVERROR(EINVAL) if avctx is not a libdm365_h264
+ *         encoder or more than AV_DM365_MAX_ROI regions are given
+ */
+int av_dm365_set_roi(AVCodecContext *avctx, const AVDM365ROI *roi, int nb_roi);
+
+#endif /* AVCODEC_DM365_H */
@@ -0,0 +1,1576 @@
+/*
+ * Software stand-in for the DM365 codec engine
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Software implementation of the Codec Engine, VISA and CMEM calls used by
+ * libdm365dec.c and libdm365enc.c, so that the wrappers can be built and
+ * run on a plain Linux host (configure --enable-libdm365-stub).
+ *
+ * CMEM blocks are ordinary heap allocations with fake physical addresses.
+ * The codecs are backed by the software implementations in libavcodec and
+ * follow the buffer semantics of the DM365 codec server: the application
+ * owns all input and output buffers and the codec only writes to the
+ * buffers passed with each process call. The H.264 encoder has no software
+ * counterpart, it writes lossless I_PCM pictures instead. Its slice limits
+ * and the slice output mode, where every process call returns the next
+ * slice of the picture, are emulated. Its motion vector and SAD output
+ * reports zero vectors and the SAD to the co-located macroblock of the
+ * previous picture. Regions of interest are checked, but as I_PCM has no
+ * quantizer they do not change the output.
+ *
+ * The video decoders keep the last displayed pictures as references and
+ * only list them in freeBufID when they drop out of the DPB, whose size
+ * follows the stream or the DM365STUB_DPB_SIZE environment variable.
+ *
+ * Every instance counts its process calls, the time spent in them and the
+ * buffers passed from outside of CMEM, which the coprocessor could not
+ * access without a copy. The numbers are logged at verbose level when the
+ * instance is deleted.
+ */
+
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include "libavutil/imgutils.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/opt.h"
+#include "avcodec.h"
+#include "golomb.h"
+#include "put_bits.h"
+
+#if HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+#include <xdc/std.h>
+#include <ti/sdo/ce/CERuntime.h>
+#include <ti/sdo/ce/Engine.h>
+#include <ti/sdo/ce/video1/videnc1.h>
+#include <ti/sdo/ce/video2/viddec2.h>
+#include <ti/sdo/ce/image1/imgenc1.h>
+#include <ti/sdo/ce/image1/imgdec1.h>
+#include <ti/sdo/codecs/h264dec/ih264vdec.h>
+#include <ti/sdo/codecs/mpeg4dec/imp4vdec.h>
+#include <ti/sdo/codecs/h264enc/ih264venc.h>
+#include <ti/sdo/linuxutils/cmem/include/cmem.h>
+
+/* fake physical address of the first CMEM block */
+#define STUB_PHYS_BASE 0x82000000UL
+
+typedef struct CMEMBlock {
+    uint8_t *raw;
+    uint8_t *ptr;
+    size_t size;
+    unsigned long phys;
+    struct CMEMBlock *next;
+} CMEMBlock;
+
+static CMEMBlock *cmem_blocks;
+static unsigned long cmem_next_phys = STUB_PHYS_BASE;
+static int cmem_users;
+
+#if HAVE_PTHREADS
+static pthread_mutex_t cmem_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define cmem_lock()   pthread_mutex_lock(&cmem_mutex)
+#define cmem_unlock() pthread_mutex_unlock(&cmem_mutex)
+#else
+#define cmem_lock()
+#define cmem_unlock()
+#endif
+
+CMEM_AllocParams CMEM_DEFAULTPARAMS = {
+    .type      = CMEM_POOL,
+    .flags     = CMEM_NONCACHED,
+    .alignment = 0,
+};
+
+int CMEM_init(void)
+{
+    cmem_lock();
+    cmem_users++;
+    cmem_unlock();
+    return 0;
+}
+
+int CMEM_exit(void)
+{
+    int ret = 0;
+
+    cmem_lock();
+    if (cmem_users > 0)
+        cmem_users--;
+    else
+        ret = -1;
+    cmem_unlock();
+    return ret;
+}
+
+void *CMEM_alloc(size_t size, CMEM_AllocParams *params)
+{
+    CMEMBlock *b;
+    size_t align = params && params->alignment ? params->alignment : 32;
+
+    if (!size || size > INT_MAX - align)
+        return NULL;
+
+    b = av_mallocz(sizeof(*b));
+    if (!b)
+        return NULL;
+    b->raw = av_malloc(size + align);
+    if (!b->raw) {
+        av_free(b);
+        return NULL;
+    }
+    b->ptr  = b->raw + (align - (uintptr_t)b->raw % align) % align;
+    b->size = size;
+
+    cmem_lock();
+    b->phys = cmem_next_phys;
+    cmem_next_phys += FFALIGN(size, 4096);
+    b->next = cmem_blocks;
+    cmem_blocks = b;
+    cmem_unlock();
+
+    return b->ptr;
+}
+
+int CMEM_free(void *ptr, CMEM_AllocParams *params)
+{
+    CMEMBlock **p, *b = NULL;
+
+    cmem_lock();
+    for (p = &cmem_blocks; *p; p = &(*p)->next) {
+        if ((*p)->ptr == ptr) {
+            b  = *p;
+            *p = b->next;
+            break;
+        }
+    }
+    cmem_unlock();
+
+    if (!b)
+        return -1;
+    av_free(b->raw);
+    av_free(b);
+    return 0;
+}
+
+unsigned long CMEM_getPhys(void *ptr)
+{
+    CMEMBlock *b;
+    unsigned long phys = 0;
+    uint8_t *p = ptr;
+
+    cmem_lock();
+    for (b = cmem_blocks; b; b = b->next) {
+        if (p >= b->ptr && p < b->ptr + b->size) {
+            phys = b->phys + (p - b->ptr);
+            break;
+        }
+    }
+    cmem_unlock();
+
+    return phys;
+}
+
+int CMEM_cacheWb(void *ptr, size_t size)
+{
+    return 0;
+}
+
+int CMEM_cacheInv(void *ptr, size_t size)
+{
+    return 0;
+}
+
+Void CERuntime_init(Void)
+{
+}
+
+Void CERuntime_exit(Void)
+{
+}
+
+struct Engine_Obj {
+    Engine_Error last_error;
+};
+
+Engine_Handle Engine_open(String name, Engine_Attrs *attrs, Engine_Error *ec)
+{
+    Engine_Handle e = av_mallocz(sizeof(*e));
+
+    if (ec)
+        *ec = e ? Engine_EOK : Engine_ENOMEM;
+    return e;
+}
+
+Void Engine_close(Engine_Handle engine)
+{
+    av_free(engine);
+}
+
+Engine_Error Engine_getLastError(Engine_Handle engine)
+{
+    return engine->last_error;
+}
+
+/*
+ * Codec default parameter tables exported by the DM365 codec libraries.
+ */
+IH264VDEC_Params IH264VDEC_PARAMS = {
+    .viddecParams = {
+        .size              = sizeof(IH264VDEC_Params),
+        .maxHeight         = 1088,
+        .maxWidth          = 1920,
+        .maxFrameRate      = 30000,
+        .maxBitRate        = 20000000,
+        .dataEndianness    = XDM_BYTE,
+        .forceChromaFormat = XDM_YUV_420SP,
+    },
+    .displayDelay          = 16,
+    .levelLimit            = LEVEL_4_2,
+    .inputDataMode         = IH264VDEC_TI_ENTIREFRAME,
+    .sliceFormat           = IH264VDEC_TI_BYTESTREAM,
+};
+
+IMP4VDEC_Params IMP4VDEC_PARAMS = {
+    .viddecParams = {
+        .size              = sizeof(IMP4VDEC_Params),
+        .maxHeight         = 576,
+        .maxWidth          = 720,
+        .maxFrameRate      = 30000,
+        .maxBitRate        = 6000000,
+        .dataEndianness    = XDM_BYTE,
+        .forceChromaFormat = XDM_YUV_420SP,
+    },
+    .displayDelay          = 1,
+};
+
+IH264VENC_VUIDataStructure H264VENC_TI_VUIPARAMBUFFER;
+
+IH264VENC_Params IH264VENC_PARAMS = {
+    .videncParams = {
+        .size              = sizeof(IH264VENC_Params),
+        .encodingPreset    = XDM_DEFAULT,
+        .rateControlPreset = IVIDEO_LOW_DELAY,
+        .maxHeight         = 1088,
+        .maxWidth          = 1920,
+        .maxFrameRate      = 30000,
+        .maxBitRate        = 10000000,
+        .dataEndianness    = XDM_BYTE,
+        .inputChromaFormat = XDM_YUV_420SP,
+        .inputContentType  = IVIDEO_PROGRESSIVE,
+        .reconChromaFormat = XDM_CHROMA_NA,
+    },
+    .profileIdc            = 100,
+    .levelIdc              = 40,
+};
+
+IH264VENC_DynamicParams H264VENC_TI_IH264VENC_DYNAMICPARAMS = {
+    .videncDynamicParams = {
+        .size               = sizeof(IH264VENC_DynamicParams),
+        .inputHeight        = 1088,
+        .inputWidth         = 1920,
+        .refFrameRate       = 30000,
+        .targetFrameRate    = 30000,
+        .targetBitRate      = 10000000,
+        .intraFrameInterval = 30,
+        .generateHeader     = XDM_ENCODE_AU,
+        .forceFrame         = IVIDEO_NA_FRAME,
+        .interFrameInterval = 1,
+    },
+    .rcQMax                = 51,
+    .rcQMaxI               = 51,
+    .idrFrameInterval      = 30,
+    .VUI_Buffer            = &H264VENC_TI_VUIPARAMBUFFER,
+};
+
+/*
+ * VISA codec instances
+ */
+typedef enum StubKind {
+    STUB_VIDDEC2,
+    STUB_VIDENC1,
+    STUB_IMGENC1,
+    STUB_IMGDEC1,
+} StubKind;
+
+typedef struct StubOutBuf {
+    XDAS_Int32 id;
+    XDAS_Int8 *bufs[2];
+    XDAS_Int32 sizes[2];
+} StubOutBuf;
+
+struct VISA_Obj {
+    const char *name;
+    StubKind kind;
+    enum CodecID codec_id;
+    AVCodecContext *avctx;          ///< software codec doing the work
+    AVFrame *frame;
+    int max_width;
+    int max_height;
+    int pitch;
+    int flushing;
+
+    /* VIDDEC2: buffers owned by the codec, keyed by inputID,
+     * IMGDEC1: pitch of the output picture */
+    StubOutBuf out[IVIDEO2_MAX_IO_BUFFERS];
+    XDAS_Int32 dpb[IVIDEO2_MAX_IO_BUFFERS]; ///< displayed pictures kept as references
+    int nb_dpb;
+    int dpb_size;                   ///< -1 until the first picture is decoded
+    uint8_t *in_buf;
+    int in_buf_size;
+
+    /* VIDENC1, IMGENC1: parameters of the last XDM_SETPARAMS */
+    int width;
+    int height;
+    int gop;
+    int bit_rate;
+    int frame_rate;                 ///< frames per 1000 seconds
+    int force_frame;
+    int quality;
+    int frame_count;
+    uint8_t *picture_buf;           ///< planar input of the software encoder
+
+    /* H.264 I_PCM writer */
+    int frame_num;
+    int idr_pic_id;
+    uint8_t *rbsp;
+    int rbsp_size;
+    int slice_mode;
+    int slice_size;
+    int slice_output;               ///< return one slice per process call
+    int mb_pos;                     ///< first macroblock of the next slice
+    int cur_idr;
+
+    /* H.264 motion vector and SAD output */
+    int mv_sad;
+    uint8_t *prev_luma;             ///< luma of the previous picture
+    int prev_size;
+    int enable_roi;
+
+    /* statistics */
+    int nb_calls;
+    int64_t total_time;
+    int64_t max_time;
+    int nb_foreign;                 ///< buffers passed from outside of CMEM
+};
+
+static const struct {
+    const char *name;
+    StubKind kind;
+    enum CodecID codec_id;
+} stub_codecs[] = {
+    { "h264dec",  STUB_VIDDEC2, CODEC_ID_H264  },
+    { "h264enc",  STUB_VIDENC1, CODEC_ID_H264  },
+    { "mpeg4dec", STUB_VIDDEC2, CODEC_ID_MPEG4 },
+    { "mpeg4enc", STUB_VIDENC1, CODEC_ID_MPEG4 },
+    { "jpegdec",  STUB_IMGDEC1, CODEC_ID_MJPEG },
+    { "jpegenc1", STUB_IMGENC1, CODEC_ID_MJPEG },
+};
+
+static int64_t stub_time(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void stub_check_buf(VISA_Handle h, void *buf)
+{
+    if (buf && !CMEM_getPhys(buf))
+        h->nb_foreign++;
+}
+
+static void stub_account(VISA_Handle h, int64_t start)
+{
+    int64_t t = stub_time() - start;
+
+    h->nb_calls++;
+    h->total_time += t;
+    h->max_time    = FFMAX(h->max_time, t);
+}
+
+static VISA_Handle stub_create(String name, StubKind kind, int max_width,
+                               int max_height)
+{
+    VISA_Handle h;
+    int i;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(stub_codecs); i++)
+        if (!strcmp(stub_codecs[i].name, name) && stub_codecs[i].kind == kind)
+            break;
+    if (i == FF_ARRAY_ELEMS(stub_codecs) || max_width <= 0 || max_height <= 0)
+        return NULL;
+
+    h = av_mallocz(sizeof(*h));
+    if (!h)
+        return NULL;
+    h->name       = stub_codecs[i].name;
+    h->kind       = kind;
+    h->codec_id   = stub_codecs[i].codec_id;
+    h->max_width  = max_width;
+    h->max_height = max_height;
+    h->pitch      = FFALIGN(max_width, 32);
+    h->dpb_size   = -1;
+    return h;
+}
+
+/* map the JPEG quality factor 1..100 to a quantizer scale */
+static int quality_to_qscale(int quality)
+{
+    return av_clip(31 - (quality * 30 + 50) / 100, 1, 31);
+}
+
+static void stub_setup_encoder(VISA_Handle h, AVCodecContext *avctx)
+{
+    avctx->width  = h->width;
+    avctx->height = h->height;
+
+    if (h->kind == STUB_IMGENC1) {
+        avctx->pix_fmt        = PIX_FMT_YUVJ420P;
+        avctx->time_base      = (AVRational){ 1, 25 };
+        avctx->flags         |= CODEC_FLAG_QSCALE;
+        avctx->global_quality = FF_QP2LAMBDA * quality_to_qscale(h->quality);
+    } else {
+        avctx->pix_fmt  = PIX_FMT_YUV420P;
+        av_reduce(&avctx->time_base.num, &avctx->time_base.den,
+                  1000, h->frame_rate, 65535);
+        avctx->gop_size = h->gop > 0 ? h->gop : 600;
+        avctx->bit_rate = h->bit_rate;
+    }
+}
+
+/* the software codec is opened on first use, outside of avcodec_open() of
+ * the wrapper, as avcodec_open() must not be nested */
+static int stub_open_codec(VISA_Handle h)
+{
+    AVCodec *codec;
+    int decoder = h->kind == STUB_VIDDEC2 || h->kind == STUB_IMGDEC1;
+
+    if (h->avctx)
+        return 0;
+
+    for (codec = av_codec_next(NULL); codec; codec = av_codec_next(codec))
+        if (codec->id == h->codec_id && (decoder ? !!codec->decode : !!codec->encode) &&
+            strncmp(codec->name, "libdm365", 8))
+            break;
+    if (!codec)
+        return -1;
+
+    h->avctx = avcodec_alloc_context3(codec);
+    h->frame = avcodec_alloc_frame();
+    if (!h->avctx || !h->frame)
+        return -1;
+
+    /* the output must not depend on the cpu of the build host */
+    h->avctx->flags    |= CODEC_FLAG_BITEXACT;
+    h->avctx->dct_algo  = FF_DCT_FASTINT;
+    h->avctx->idct_algo = FF_IDCT_SIMPLE;
+
+    if (!decoder) {
+        stub_setup_encoder(h, h->avctx);
+        if (av_image_alloc(h->frame->data, h->frame->linesize, h->width,
+                           h->height, h->avctx->pix_fmt, 16) < 0)
+            return -1;
+        h->picture_buf = h->frame->data[0];
+    }
+
+    if (avcodec_open2(h->avctx, codec, NULL) < 0) {
+        av_freep(&h->avctx);
+        return -1;
+    }
+    return 0;
+}
+
+/* instances are deleted from within avcodec_close() of the wrapper, so
+ * the software codec is torn down by hand instead of nesting the call */
+static void stub_close_codec(VISA_Handle h)
+{
+    AVCodecContext *avctx = h->avctx;
+
+    if (avctx) {
+        if (avctx->codec->close)
+            avctx->codec->close(avctx);
+        avcodec_default_free_buffers(avctx);
+        if (avctx->codec->priv_class)
+            av_opt_free(avctx->priv_data);
+        av_opt_free(avctx);
+        av_freep(&avctx->priv_data);
+        av_freep(&avctx->extradata);
+        av_freep(&h->avctx);
+    }
+    av_freep(&h->picture_buf);
+    av_freep(&h->frame);
+}
+
+static void stub_delete(VISA_Handle h)
+{
+    if (!h)
+        return;
+    if (h->nb_calls)
+        av_log(NULL, AV_LOG_VERBOSE, "%s: %d process calls, %.3f ms average, "
+               "%.3f ms max, %d buffers outside of CMEM\n", h->name,
+               h->nb_calls, h->total_time / 1000.0 / h->nb_calls,
+               h->max_time / 1000.0, h->nb_foreign);
+    stub_close_codec(h);
+    av_free(h->in_buf);
+    av_free(h->rbsp);
+    av_free(h->prev_luma);
+    av_free(h);
+}
+
+VIDDEC2_Handle VIDDEC2_create(Engine_Handle e, String name, VIDDEC2_Params *params)
+{
+    if (!e || !params)
+        return NULL;
+    return stub_create(name, STUB_VIDDEC2, params->maxWidth, params->maxHeight);
+}
+
+Void VIDDEC2_delete(VIDDEC2_Handle handle)
+{
+    stub_delete(handle);
+}
+
+static void viddec2_reset(VIDDEC2_Handle h)
+{
+    if (h->avctx)
+        avcodec_flush_buffers(h->avctx);
+    memset(h->out, 0, sizeof(h->out));
+    h->nb_dpb   = 0;
+    h->flushing = 0;
+}
+
+Int32 VIDDEC2_control(VIDDEC2_Handle h, VIDDEC2_Cmd id,
+                      VIDDEC2_DynamicParams *params, VIDDEC2_Status *status)
+{
+    int height = FFALIGN(h->max_height, 16);
+
+    status->extendedError = 0;
+
+    switch (id) {
+    case XDM_GETBUFINFO:
+        status->bufInfo.minNumInBufs     = 1;
+        /* room for a picture of uncompressed I_PCM macroblocks */
+        status->bufInfo.minInBufSize[0]  = h->pitch * height * 2;
+        status->bufInfo.minNumOutBufs    = 2;
+        status->bufInfo.minOutBufSize[0] = h->pitch * height;
+        status->bufInfo.minOutBufSize[1] = h->pitch * height / 2;
+        status->maxNumDisplayBufs        = IVIDEO2_MAX_IO_BUFFERS;
+        break;
+    case XDM_GETSTATUS:
+        status->outputWidth        = h->avctx ? h->avctx->width  : 0;
+        status->outputHeight       = h->avctx ? h->avctx->height : 0;
+        status->contentType        = IVIDEO_PROGRESSIVE;
+        status->outputChromaFormat = XDM_YUV_420SP;
+        break;
+    case XDM_SETPARAMS:
+    case XDM_SETDEFAULT:
+        break;
+    case XDM_RESET:
+        viddec2_reset(h);
+        break;
+    case XDM_FLUSH:
+        h->flushing = 1;
+        break;
+    default:
+        return VIDDEC2_EUNSUPPORTED;
+    }
+
+    return VIDDEC2_EOK;
+}
+
+static StubOutBuf *find_out_buf(VIDDEC2_Handle h, XDAS_Int32 id)
+{
+    int i;
+
+    for (i = 0; i < IVIDEO2_MAX_IO_BUFFERS; i++)
+        if (h->out[i].id == id)
+            return &h->out[i];
+    return NULL;
+}
+
+static int frame_type(AVFrame *frame)
+{
+    switch (frame->pict_type) {
+    case AV_PICTURE_TYPE_I:
+        return frame->key_frame ? IVIDEO_IDR_FRAME : IVIDEO_I_FRAME;
+    case AV_PICTURE_TYPE_P:
+        return IVIDEO_P_FRAME;
+    case AV_PICTURE_TYPE_B:
+        return IVIDEO_B_FRAME;
+    default:
+        return IVIDEO_NA_FRAME;
+    }
+}
+
+/* write a decoded yuv420p or yuv422p picture as NV12 into an application
+ * buffer, 4:2:2 chroma is subsampled by dropping every other line */
+static int store_nv12(VIDDEC2_Handle h, StubOutBuf *ob, AVFrame *frame,
+                      IVIDEO1_BufDesc *bd)
+{
+    int w = h->avctx->width, hgt = h->avctx->height;
+    uint8_t *y = ob->bufs[0], *uv = ob->bufs[1];
+    int vshift, i, j;
+
+    switch (h->avctx->pix_fmt) {
+    case PIX_FMT_YUV420P:
+    case PIX_FMT_YUVJ420P:
+        vshift = 0;
+        break;
+    case PIX_FMT_YUV422P:
+    case PIX_FMT_YUVJ422P:
+        vshift = 1;
+        break;
+    default:
+        return -1;
+    }
+
+    if (w > h->pitch || hgt > FFALIGN(h->max_height, 16) ||
+        ob->sizes[0] < h->pitch * hgt || ob->sizes[1] < h->pitch * hgt / 2)
+        return -1;
+
+    av_image_copy_plane(y, h->pitch, frame->data[0], frame->linesize[0], w, hgt);
+    for (j = 0; j < hgt / 2; j++) {
+        uint8_t *d = uv + j * h->pitch;
+        const uint8_t *u = frame->data[1] + (j << vshift) * frame->linesize[1];
+        const uint8_t *v = frame->data[2] + (j << vshift) * frame->linesize[2];
+        for (i = 0; i < w / 2; i++) {
+            d[2 * i]     = u[i];
+            d[2 * i + 1] = v[i];
+        }
+    }
+
+    memset(bd, 0, sizeof(*bd));
+    bd->numBufs              = 2;
+    bd->frameWidth           = w;
+    bd->frameHeight          = hgt;
+    bd->framePitch           = h->pitch;
+    bd->bufDesc[0].buf       = (XDAS_Int8 *) y;
+    bd->bufDesc[0].bufSize   = h->pitch * hgt;
+    bd->bufDesc[1].buf       = (XDAS_Int8 *) uv;
+    bd->bufDesc[1].bufSize   = h->pitch * hgt / 2;
+    bd->frameType            = frame_type(frame);
+    bd->topFieldFirstFlag    = 1;
+    bd->contentType          = IVIDEO_PROGRESSIVE;
+    bd->chromaFormat         = XDM_YUV_420SP;
+    return 0;
+}
+
+/* the coprocessor reads the bitstream by DMA; the software decoder
+ * needs zeroed padding behind it */
+static int load_packet(VISA_Handle h, AVPacket *pkt, const XDAS_Int8 *buf,
+                       int size)
+{
+    if (size > h->in_buf_size) {
+        av_free(h->in_buf);
+        h->in_buf_size = 0;
+        h->in_buf = av_malloc(size + FF_INPUT_BUFFER_PADDING_SIZE);
+        if (!h->in_buf)
+            return -1;
+        h->in_buf_size = size;
+    }
+    memcpy(h->in_buf, buf, size);
+    memset(h->in_buf + size, 0, FF_INPUT_BUFFER_PADDING_SIZE);
+    pkt->data = h->in_buf;
+    pkt->size = size;
+    return 0;
+}
+
+/* the sequence needs larger buffers than the instance was created for */
+static int stub_too_large(VISA_Handle h)
+{
+    return h->avctx->width  > h->max_width ||
+           h->avctx->height > h->max_height;
+}
+
+/* number of displayed pictures the codec holds on to as references,
+ * DM365STUB_DPB_SIZE overrides the size derived from the stream */
+static int dpb_size(VIDDEC2_Handle h)
+{
+    const char *env = getenv("DM365STUB_DPB_SIZE");
+    int size;
+
+    if (env && *env)
+        size = atoi(env);
+    else if (h->codec_id == CODEC_ID_H264)
+        size = FFMAX(h->avctx->refs, 1);
+    else
+        size = 1 + h->avctx->has_b_frames;
+    return av_clip(size, 0, IVIDEO2_MAX_IO_BUFFERS - 2);
+}
+
+static Int32 viddec2_process(VIDDEC2_Handle h, XDM1_BufDesc *inBufs,
+                             XDM_BufDesc *outBufs, VIDDEC2_InArgs *inArgs,
+                             VIDDEC2_OutArgs *outArgs)
+{
+    AVPacket pkt;
+    StubOutBuf *ob = NULL;
+    int got_picture = 0, ret, i;
+
+    outArgs->extendedError = 0;
+    outArgs->bytesConsumed = 0;
+    outArgs->outputID[0]   = 0;
+    outArgs->freeBufID[0]  = 0;
+    outArgs->outBufsInUseFlag = 0;
+    memset(&outArgs->decodedBufs, 0, sizeof(outArgs->decodedBufs));
+
+    if (stub_open_codec(h) < 0) {
+        outArgs->extendedError = 1 << XDM_FATALERROR;
+        outArgs->decodedBufs.extendedError = outArgs->extendedError;
+        return VIDDEC2_EFAIL;
+    }
+
+    av_init_packet(&pkt);
+    if (!h->flushing) {
+        /* remember where the picture started by this call has to go */
+        ob = find_out_buf(h, 0);
+        if (!ob || inArgs->inputID <= 0 || outBufs->numBufs < 2) {
+            outArgs->extendedError = 1 << XDM_UNSUPPORTEDPARAM;
+            outArgs->decodedBufs.extendedError = outArgs->extendedError;
+            return VIDDEC2_EFAIL;
+        }
+        ob->id       = inArgs->inputID;
+        ob->bufs[0]  = outBufs->bufs[0];
+        ob->bufs[1]  = outBufs->bufs[1];
+        ob->sizes[0] = outBufs->bufSizes[0];
+        ob->sizes[1] = outBufs->bufSizes[1];
+
+        if (load_packet(h, &pkt, inBufs->descs[0].buf, inArgs->numBytes) < 0)
+            return VIDDEC2_EFAIL;
+        h->avctx->reordered_opaque = inArgs->inputID;
+    }
+
+    ret = avcodec_decode_video2(h->avctx, h->frame, &got_picture, &pkt);
+    if (!h->flushing) {
+        outArgs->bytesConsumed = inArgs->numBytes;
+        if (ret >= 0 && stub_too_large(h)) {
+            ob->id = 0;
+            outArgs->freeBufID[0] = inArgs->inputID;
+            outArgs->freeBufID[1] = 0;
+            outArgs->extendedError = 1 << XDM_UNSUPPORTEDPARAM;
+            outArgs->decodedBufs.extendedError = outArgs->extendedError;
+            return VIDDEC2_EFAIL;
+        }
+        if (ret < 0) {
+            /* the buffer of this call is not referenced by the codec */
+            ob->id = 0;
+            outArgs->freeBufID[0] = inArgs->inputID;
+            outArgs->freeBufID[1] = 0;
+            outArgs->extendedError = 1 << XDM_CORRUPTEDDATA;
+            outArgs->decodedBufs.extendedError = outArgs->extendedError;
+            return VIDDEC2_EFAIL;
+        }
+    } else if (!got_picture) {
+        /* the stream ended, the references are not needed anymore */
+        for (i = 0; i < h->nb_dpb; i++)
+            outArgs->freeBufID[i] = h->dpb[i];
+        outArgs->freeBufID[i] = 0;
+        h->nb_dpb = 0;
+        return VIDDEC2_EFAIL;
+    }
+
+    if (got_picture) {
+        XDAS_Int32 id = h->frame->reordered_opaque;
+
+        ob = find_out_buf(h, id);
+        if (!ob || store_nv12(h, ob, h->frame, &outArgs->displayBufs[0]) < 0) {
+            outArgs->extendedError = 1 << XDM_FATALERROR;
+            outArgs->decodedBufs.extendedError = outArgs->extendedError;
+            return VIDDEC2_EFAIL;
+        }
+        ob->id = 0;
+        outArgs->decodedBufs  = outArgs->displayBufs[0];
+        outArgs->outputID[0]  = id;
+        outArgs->outputID[1]  = 0;
+
+        /* keep the picture as reference, free the oldest beyond the DPB */
+        if (h->dpb_size < 0)
+            h->dpb_size = dpb_size(h);
+        h->dpb[h->nb_dpb++] = id;
+        if (h->nb_dpb > h->dpb_size) {
+            outArgs->freeBufID[0] = h->dpb[0];
+            outArgs->freeBufID[1] = 0;
+            h->nb_dpb--;
+            memmove(h->dpb, h->dpb + 1, h->nb_dpb * sizeof(*h->dpb));
+        }
+    }
+
+    return VIDDEC2_EOK;
+}
+
+Int32 VIDDEC2_process(VIDDEC2_Handle h, XDM1_BufDesc *inBufs,
+                      XDM_BufDesc *outBufs, VIDDEC2_InArgs *inArgs,
+                      VIDDEC2_OutArgs *outArgs)
+{
+    int64_t start = stub_time();
+    Int32 ret;
+    int i;
+
+    if (inArgs->numBytes)
+        stub_check_buf(h, inBufs->descs[0].buf);
+    for (i = 0; i < outBufs->numBufs; i++)
+        stub_check_buf(h, outBufs->bufs[i]);
+
+    ret = viddec2_process(h, inBufs, outBufs, inArgs, outArgs);
+    stub_account(h, start);
+    return ret;
+}
+
+/*
+ * Encoders
+ */
+
+/* worst case size of one coded picture */
+static int max_packet_size(VISA_Handle h)
+{
+    int mbs = ((h->width + 15) >> 4) * ((h->height + 15) >> 4);
+
+    /* I_PCM with emulation prevention in every third byte, one slice
+     * header per macroblock at worst */
+    return mbs * (384 * 3 / 2 + 16) + 1024;
+}
+
+/* 8 bytes per macroblock: 16 bit vector components, 32 bit SAD */
+static int mv_sad_size(VISA_Handle h)
+{
+    return ((h->width + 15) >> 4) * ((h->height + 15) >> 4) * 8;
+}
+
+static int write_mv_sad(VISA_Handle h, const uint8_t *y, uint8_t *dst,
+                        int dst_size)
+{
+    int mb_w = (h->width + 15) >> 4, mb_h = (h->height + 15) >> 4;
+    int size = h->width * h->height;
+    int mb_x, mb_y, i, j;
+
+    if (!dst || dst_size < mv_sad_size(h))
+        return -1;
+
+    if (h->prev_size != size) {
+        av_free(h->prev_luma);
+        h->prev_size = 0;
+        if (!(h->prev_luma = av_malloc(size)))
+            return -1;
+        h->prev_size = size;
+        av_image_copy_plane(h->prev_luma, h->width, y, h->pitch,
+                            h->width, h->height);
+    }
+
+    for (mb_y = 0; mb_y < mb_h; mb_y++) {
+        for (mb_x = 0; mb_x < mb_w; mb_x++) {
+            unsigned sad = 0;
+            for (j = mb_y * 16; j < FFMIN(mb_y * 16 + 16, h->height); j++)
+                for (i = mb_x * 16; i < FFMIN(mb_x * 16 + 16, h->width); i++)
+                    sad += FFABS(y[j * h->pitch + i] - h->prev_luma[j * h->width + i]);
+            AV_WL16(dst,     0);
+            AV_WL16(dst + 2, 0);
+            AV_WL32(dst + 4, sad);
+            dst += 8;
+        }
+    }
+
+    av_image_copy_plane(h->prev_luma, h->width, y, h->pitch,
+                        h->width, h->height);
+    return 0;
+}
+
+static int check_roi(VISA_Handle h, const ROI_Interface *roi)
+{
+    int i;
+
+    if (roi->numOfROI < 0 || roi->numOfROI > MAX_ROI)
+        return -1;
+    for (i = 0; i < roi->numOfROI; i++) {
+        const XDM_Rect *r = &roi->listROI[i];
+        if (r->topLeft.x < 0 || r->topLeft.y < 0 ||
+            r->bottomRight.x < r->topLeft.x || r->bottomRight.y < r->topLeft.y ||
+            r->bottomRight.x >= h->width || r->bottomRight.y >= h->height ||
+            roi->roiType[i] < FACE_OBJECT || roi->roiType[i] > PRIVACY_MASK)
+            return -1;
+    }
+    return 0;
+}
+
+static int set_enc_params(VISA_Handle h, int width, int height,
+                          int capture_width)
+{
+    int pitch = capture_width > width ? capture_width : width;
+
+    if (width <= 0 || height <= 0 || (width & 1) || (height & 1) ||
+        width > h->max_width || height > h->max_height)
+        return -1;
+
+    /* the software encoders are reopened with the new size */
+    if (width != h->width || height != h->height)
+        stub_close_codec(h);
+
+    h->width  = width;
+    h->height = height;
+    h->pitch  = pitch;
+    return 0;
+}
+
+static void fill_buf_info(VISA_Handle h, XDM_AlgBufInfo *info)
+{
+    memset(info, 0, sizeof(*info));
+    info->minNumInBufs     = 2;
+    info->minInBufSize[0]  = h->pitch * h->height;
+    info->minInBufSize[1]  = h->pitch * h->height / 2;
+    info->minNumOutBufs    = 1;
+    info->minOutBufSize[0] = max_packet_size(h);
+    if (h->mv_sad) {
+        info->minNumOutBufs    = 2;
+        info->minOutBufSize[1] = mv_sad_size(h);
+    }
+}
+
+/* read an NV12 picture into the planar input of the software encoder */
+static int load_nv12(VISA_Handle h, const uint8_t *y, int y_size,
+                     const uint8_t *uv, int uv_size)
+{
+    AVFrame *frame = h->frame;
+    int i, j;
+
+    if (!y || !uv || y_size < h->pitch * h->height ||
+        uv_size < h->pitch * h->height / 2)
+        return -1;
+
+    av_image_copy_plane(frame->data[0], frame->linesize[0], y, h->pitch,
+                        h->width, h->height);
+    for (j = 0; j < h->height / 2; j++) {
+        const uint8_t *s = uv + j * h->pitch;
+        uint8_t *u = frame->data[1] + j * frame->linesize[1];
+        uint8_t *v = frame->data[2] + j * frame->linesize[2];
+        for (i = 0; i < h->width / 2; i++) {
+            u[i] = s[2 * i];
+            v[i] = s[2 * i + 1];
+        }
+    }
+    return 0;
+}
+
+/* escape a raw byte sequence payload into an Annex B NAL unit */
+static int write_nal(uint8_t *dst, int dst_size, int nal_ref_idc, int type,
+                     const uint8_t *rbsp, int size)
+{
+    int i, n = 0, zeros = 0;
+
+    if (dst_size < 5)
+        return -1;
+    dst[n++] = 0;
+    dst[n++] = 0;
+    dst[n++] = 0;
+    dst[n++] = 1;
+    dst[n++] = nal_ref_idc << 5 | type;
+
+    for (i = 0; i < size; i++) {
+        if (n + 2 > dst_size)
+            return -1;
+        if (zeros >= 2 && rbsp[i] <= 3) {
+            dst[n++] = 3;
+            zeros = 0;
+        }
+        dst[n++] = rbsp[i];
+        zeros = rbsp[i] ? 0 : zeros + 1;
+    }
+    return n;
+}
+
+static int finish_rbsp(PutBitContext *pb)
+{
+    put_bits(pb, 1, 1);
+    align_put_bits(pb);
+    flush_put_bits(pb);
+    return put_bits_count(pb) >> 3;
+}
+
+static int write_sps_pps(VISA_Handle h, uint8_t *dst, int dst_size)
+{
+    PutBitContext pb;
+    int mb_w = (h->width + 15) >> 4, mb_h = (h->height + 15) >> 4;
+    int crop_x = mb_w * 16 - h->width, crop_y = mb_h * 16 - h->height;
+    int size, n, ret;
+
+    init_put_bits(&pb, h->rbsp, h->rbsp_size);
+    put_bits(&pb, 8, 66);                   /* profile_idc, baseline */
+    put_bits(&pb, 8, 0);                    /* constraint flags */
+    put_bits(&pb, 8, 40);                   /* level_idc */
+    set_ue_golomb(&pb, 0);                  /* seq_parameter_set_id */
+    set_ue_golomb(&pb, 12);                 /* log2_max_frame_num - 4 */
+    set_ue_golomb(&pb, 2);                  /* pic_order_cnt_type */
+    set_ue_golomb(&pb, 1);                  /* max_num_ref_frames */
+    put_bits(&pb, 1, 0);                    /* gaps_in_frame_num_allowed */
+    set_ue_golomb(&pb, mb_w - 1);
+    set_ue_golomb(&pb, mb_h - 1);
+    put_bits(&pb, 1, 1);                    /* frame_mbs_only_flag */
+    put_bits(&pb, 1, 1);                    /* direct_8x8_inference_flag */
+    put_bits(&pb, 1, crop_x || crop_y);
+    if (crop_x || crop_y) {
+        set_ue_golomb(&pb, 0);
+        set_ue_golomb(&pb, crop_x >> 1);
+        set_ue_golomb(&pb, 0);
+        set_ue_golomb(&pb, crop_y >> 1);
+    }
+    put_bits(&pb, 1, 0);                    /* vui_parameters_present_flag */
+    size = finish_rbsp(&pb);
+
+    if ((n = write_nal(dst, dst_size, 3, 7, h->rbsp, size)) < 0)
+        return -1;
+
+    init_put_bits(&pb, h->rbsp, h->rbsp_size);
+    set_ue_golomb(&pb, 0);                  /* pic_parameter_set_id */
+    set_ue_golomb(&pb, 0);                  /* seq_parameter_set_id */
+    put_bits(&pb, 1, 0);                    /* entropy_coding_mode_flag */
+    put_bits(&pb, 1, 0);                    /* bottom_field_pic_order_in_frame_present */
+    set_ue_golomb(&pb, 0);                  /* num_slice_groups - 1 */
+    set_ue_golomb(&pb, 0);                  /* num_ref_idx_l0_default_active - 1 */
+    set_ue_golomb(&pb, 0);                  /* num_ref_idx_l1_default_active - 1 */
+    put_bits(&pb, 1, 0);                    /* weighted_pred_flag */
+    put_bits(&pb, 2, 0);                    /* weighted_bipred_idc */
+    set_se_golomb(&pb, 0);                  /* pic_init_qp - 26 */
+    set_se_golomb(&pb, 0);                  /* pic_init_qs - 26 */
+    set_se_golomb(&pb, 0);                  /* chroma_qp_index_offset */
+    put_bits(&pb, 1, 1);                    /* deblocking_filter_control_present */
+    put_bits(&pb, 1, 0);                    /* constrained_intra_pred_flag */
+    put_bits(&pb, 1, 0);                    /* redundant_pic_cnt_present_flag */
+    size = finish_rbsp(&pb);
+
+    if ((ret = write_nal(dst + n, dst_size - n, 3, 8, h->rbsp, size)) < 0)
+        return -1;
+    return n + ret;
+}
+
+/* size of the largest slice allowed by the slice limit in macroblocks */
+static int slice_mb_count(VISA_Handle h, int nb_mbs)
+{
+    switch (h->slice_mode) {
+    case IH264VENC_SLICEMODE_MBUNIT:
+        return h->slice_size > 0 ? FFMIN(h->slice_size, nb_mbs) : nb_mbs;
+    case IH264VENC_SLICEMODE_BYTES:
+        /* an I_PCM macroblock takes 384 bytes and a few bits of header,
+         * emulation prevention bytes are not taken into account */
+        return h->slice_size > 0 ? av_clip(h->slice_size / 386 - 1, 1, nb_mbs) : nb_mbs;
+    default:
+        return nb_mbs;
+    }
+}
+
+/* code a slice of I_PCM macroblocks, starting with macroblock h->mb_pos */
+static int write_pcm_slice(VISA_Handle h, int idr, const uint8_t *y,
+                           const uint8_t *uv, uint8_t *dst, int dst_size)
+{
+    PutBitContext pb;
+    int mb_w = (h->width + 15) >> 4, mb_h = (h->height + 15) >> 4;
+    int first = h->mb_pos, end = first + slice_mb_count(h, mb_w * mb_h - first);
+    int mb, mb_x, mb_y, i, j, c;
+
+    init_put_bits(&pb, h->rbsp, h->rbsp_size);
+    set_ue_golomb(&pb, first);              /* first_mb_in_slice */
+    set_ue_golomb(&pb, idr ? 7 : 5);        /* slice_type, I or P */
+    set_ue_golomb(&pb, 0);                  /* pic_parameter_set_id */
+    put_bits(&pb, 16, h->frame_num);
+    if (idr)
+        set_ue_golomb(&pb, h->idr_pic_id);
+    else
+        put_bits(&pb, 1, 0);                /* num_ref_idx_active_override */
+    if (!idr)
+        put_bits(&pb, 1, 0);                /* ref_pic_list_modification_flag_l0 */
+    if (idr) {
+        put_bits(&pb, 1, 0);                /* no_output_of_prior_pics_flag */
+        put_bits(&pb, 1, 0);                /* long_term_reference_flag */
+    } else {
+        put_bits(&pb, 1, 0);                /* adaptive_ref_pic_marking_mode */
+    }
+    set_se_golomb(&pb, 0);                  /* slice_qp_delta */
+    set_ue_golomb(&pb, 1);                  /* disable_deblocking_filter_idc */
+
+    for (mb = first; mb < end; mb++) {
+        mb_x = mb % mb_w;
+        mb_y = mb / mb_w;
+        if (!idr) {
+            set_ue_golomb(&pb, 0);          /* mb_skip_run */
+            set_ue_golomb(&pb, 30);         /* I_PCM in a P slice */
+        } else {
+            set_ue_golomb(&pb, 25);         /* I_PCM */
+        }
+        align_put_bits(&pb);
+
+        /* samples outside of the picture repeat its edges */
+        for (j = 0; j < 16; j++) {
+            int sy = FFMIN(mb_y * 16 + j, h->height - 1);
+            for (i = 0; i < 16; i++) {
+                int sx = FFMIN(mb_x * 16 + i, h->width - 1);
+                put_bits(&pb, 8, y[sy * h->pitch + sx]);
+            }
+        }
+        for (c = 0; c < 2; c++) {
+            for (j = 0; j < 8; j++) {
+                int sy = FFMIN(mb_y * 8 + j, h->height / 2 - 1);
+                for (i = 0; i < 8; i++) {
+                    int sx = FFMIN(mb_x * 8 + i, h->width / 2 - 1);
+                    put_bits(&pb, 8, uv[sy * h->pitch + 2 * sx + c]);
+                }
+            }
+        }
+    }
+
+    h->mb_pos = end < mb_w * mb_h ? end : 0;
+    return write_nal(dst, dst_size, 3, idr ? 5 : 1, h->rbsp, finish_rbsp(&pb));
+}
+
+/* code the picture, or only its next slice in slice output mode; *done is
+ * cleared while slices of the picture are left */
+static int encode_pcm(VISA_Handle h, IVIDEO1_BufDescIn *inBufs, uint8_t *dst,
+                      int dst_size, int *frame_type, int *done)
+{
+    const uint8_t *y = (const uint8_t *) inBufs->bufDesc[0].buf;
+    const uint8_t *uv = (const uint8_t *) inBufs->bufDesc[1].buf;
+    int idr, n = 0, ret;
+    int size = max_packet_size(h);
+
+    if (!y || !uv || inBufs->bufDesc[0].bufSize < h->pitch * h->height ||
+        inBufs->bufDesc[1].bufSize < h->pitch * h->height / 2)
+        return -1;
+
+    if (h->rbsp_size < size) {
+        av_free(h->rbsp);
+        h->rbsp_size = 0;
+        h->rbsp = av_malloc(size);
+        if (!h->rbsp)
+            return -1;
+        h->rbsp_size = size;
+    }
+
+    if (!h->mb_pos) {
+        h->cur_idr = !h->frame_count ||
+                     (h->gop > 0 && !(h->frame_count % h->gop)) ||
+                     h->force_frame == IVIDEO_I_FRAME ||
+                     h->force_frame == IVIDEO_IDR_FRAME;
+        if (h->cur_idr) {
+            h->frame_num = 0;
+            if ((n = write_sps_pps(h, dst, dst_size)) < 0)
+                return -1;
+        }
+    }
+    idr = h->cur_idr;
+
+    do {
+        ret = write_pcm_slice(h, idr, y, uv, dst + n, dst_size - n);
+        if (ret < 0) {
+            h->mb_pos = 0;
+            return -1;
+        }
+        n += ret;
+    } while (h->mb_pos && !h->slice_output);
+
+    *frame_type = idr ? IVIDEO_IDR_FRAME : IVIDEO_P_FRAME;
+    *done = !h->mb_pos;
+    if (*done) {
+        if (idr)
+            h->idr_pic_id = (h->idr_pic_id + 1) & 0xffff;
+        h->frame_num = (h->frame_num + 1) & 0xffff;
+    }
+    return n;
+}
+
+static int encode_software(VISA_Handle h, const uint8_t *y, int y_size,
+                           const uint8_t *uv, int uv_size, uint8_t *dst,
+                           int dst_size, int *frame_type)
+{
+    AVFrame *frame;
+    int ret;
+
+    if (stub_open_codec(h) < 0 || load_nv12(h, y, y_size, uv, uv_size) < 0)
+        return -1;
+
+    frame = h->frame;
+    frame->pts = h->frame_count;
+    frame->pict_type = h->force_frame == IVIDEO_I_FRAME ||
+                       h->force_frame == IVIDEO_IDR_FRAME ? AV_PICTURE_TYPE_I : 0;
+
+    ret = avcodec_encode_video(h->avctx, dst, dst_size, frame);
+    if (ret < 0)
+        return -1;
+
+    *frame_type = h->avctx->coded_frame->key_frame ? IVIDEO_I_FRAME :
+                                                     IVIDEO_P_FRAME;
+    return ret;
+}
+
+VIDENC1_Handle VIDENC1_create(Engine_Handle e, String name, VIDENC1_Params *params)
+{
+    VIDENC1_Handle h;
+
+    if (!e || !params)
+        return NULL;
+    h = stub_create(name, STUB_VIDENC1, params->maxWidth, params->maxHeight);
+    if (h) {
+        h->width      = params->maxWidth;
+        h->height     = params->maxHeight;
+        h->pitch      = params->maxWidth;
+        h->bit_rate   = params->maxBitRate;
+        h->frame_rate = params->maxFrameRate;
+
+        if (h->codec_id == CODEC_ID_H264 && params->size >= sizeof(IH264VENC_Params)) {
+            IH264VENC_Params *p = (IH264VENC_Params *) params;
+            h->slice_mode   = p->sliceMode;
+            h->slice_output = p->outputDataMode == IH264VENC_TI_SLICEMODE;
+        }
+    }
+    return h;
+}
+
+Void VIDENC1_delete(VIDENC1_Handle handle)
+{
+    stub_delete(handle);
+}
+
+Int32 VIDENC1_control(VIDENC1_Handle h, VIDENC1_Cmd id,
+                      VIDENC1_DynamicParams *params, VIDENC1_Status *status)
+{
+    status->extendedError = 0;
+
+    switch (id) {
+    case XDM_SETPARAMS:
+        if (params->refFrameRate <= 0 || params->targetBitRate < 0 ||
+            set_enc_params(h, params->inputWidth, params->inputHeight,
+                           params->captureWidth) < 0) {
+            status->extendedError = 1 << XDM_UNSUPPORTEDPARAM;
+            return VIDENC1_EFAIL;
+        }
+        /* rate control changes restart the software encoder */
+        if (params->intraFrameInterval != h->gop ||
+            params->targetBitRate != h->bit_rate ||
+            params->refFrameRate != h->frame_rate)
+            stub_close_codec(h);
+        h->gop         = params->intraFrameInterval;
+        h->bit_rate    = params->targetBitRate;
+        h->frame_rate  = params->refFrameRate;
+        h->force_frame = params->forceFrame;
+        if (h->codec_id == CODEC_ID_H264 && params->size >= sizeof(IH264VENC_DynamicParams)) {
+            IH264VENC_DynamicParams *p = (IH264VENC_DynamicParams *) params;
+            h->slice_size = p->sliceSize;
+            h->mv_sad     = p->mvSADoutFlag;
+            h->enable_roi = p->enableROI;
+        }
+        break;
+    case XDM_GETBUFINFO:
+    case XDM_GETSTATUS:
+        fill_buf_info(h, &status->bufInfo);
+        break;
+    case XDM_SETDEFAULT:
+    case XDM_FLUSH:
+        break;
+    case XDM_RESET:
+        stub_close_codec(h);
+        h->frame_count = 0;
+        h->mb_pos      = 0;
+        break;
+    default:
+        status->extendedError = 1 << XDM_UNSUPPORTEDPARAM;
+        return VIDENC1_EUNSUPPORTED;
+    }
+
+    return VIDENC1_EOK;
+}
+
+Int32 VIDENC1_process(VIDENC1_Handle h, IVIDEO1_BufDescIn *inBufs,
+                      XDM_BufDesc *outBufs, VIDENC1_InArgs *inArgs,
+                      VIDENC1_OutArgs *outArgs)
+{
+    int64_t start = stub_time();
+    uint8_t *dst = (uint8_t *) outBufs->bufs[0];
+    int dst_size = outBufs->bufSizes[0];
+    int ret, frame_type = IVIDEO_NA_FRAME, done = 1;
+
+    stub_check_buf(h, inBufs->bufDesc[0].buf);
+    stub_check_buf(h, inBufs->bufDesc[1].buf);
+    stub_check_buf(h, dst);
+
+    memset(outArgs, 0, sizeof(*outArgs));
+    outArgs->size = sizeof(*outArgs);
+
+    if (inBufs->numBufs < 2 || outBufs->numBufs < 1) {
+        ret = -1;
+    } else if (h->codec_id == CODEC_ID_H264 && h->enable_roi &&
+               (inArgs->size < sizeof(IH264VENC_InArgs) ||
+                check_roi(h, &((IH264VENC_InArgs *) inArgs)->roiParameters) < 0)) {
+        ret = -1;
+    } else if (h->codec_id == CODEC_ID_H264) {
+        ret = encode_pcm(h, inBufs, dst, dst_size, &frame_type, &done);
+        /* the vectors of the picture come with its last slice */
+        if (ret >= 0 && done && h->mv_sad) {
+            stub_check_buf(h, outBufs->numBufs > 1 ? outBufs->bufs[1] : NULL);
+            if (outBufs->numBufs < 2 ||
+                write_mv_sad(h, (const uint8_t *) inBufs->bufDesc[0].buf,
+                             (uint8_t *) outBufs->bufs[1], outBufs->bufSizes[1]) < 0)
+                ret = -1;
+        }
+    } else {
+        ret = encode_software(h, (const uint8_t *) inBufs->bufDesc[0].buf,
+                              inBufs->bufDesc[0].bufSize,
+                              (const uint8_t *) inBufs->bufDesc[1].buf,
+                              inBufs->bufDesc[1].bufSize,
+                              dst, dst_size, &frame_type);
+    }
+    stub_account(h, start);
+
+    if (ret < 0) {
+        outArgs->extendedError = 1 << XDM_UNSUPPORTEDINPUT;
+        return VIDENC1_EFAIL;
+    }
+
+    /* in slice output mode the input is released with the last slice */
+    if (done)
+        h->frame_count++;
+    outArgs->bytesGenerated     = ret;
+    outArgs->encodedFrameType   = frame_type;
+    outArgs->inputFrameSkip     = IVIDEO_FRAME_ENCODED;
+    outArgs->outputID           = done ? inArgs->inputID : 0;
+    outArgs->encodedBuf.buf     = (XDAS_Int8 *) dst;
+    outArgs->encodedBuf.bufSize = ret;
+    return VIDENC1_EOK;
+}
+
+IMGENC1_Handle IMGENC1_create(Engine_Handle e, String name, IMGENC1_Params *params)
+{
+    IMGENC1_Handle h;
+
+    if (!e || !params)
+        return NULL;
+    h = stub_create(name, STUB_IMGENC1, params->maxWidth, params->maxHeight);
+    if (h) {
+        h->width   = params->maxWidth;
+        h->height  = params->maxHeight;
+        h->pitch   = params->maxWidth;
+        h->quality = 75;
+    }
+    return h;
+}
+
+Void IMGENC1_delete(IMGENC1_Handle handle)
+{
+    stub_delete(handle);
+}
+
+Int32 IMGENC1_control(IMGENC1_Handle h, IMGENC1_Cmd id,
+                      IMGENC1_DynamicParams *params, IMGENC1_Status *status)
+{
+    status->extendedError = 0;
+
+    switch (id) {
+    case XDM_SETPARAMS:
+        if (params->qValue < 1 || params->qValue > 100 ||
+            params->inputChromaFormat != XDM_YUV_420SP ||
+            set_enc_params(h, params->inputWidth, params->inputHeight,
+                           params->captureWidth) < 0) {
+            status->extendedError = 1 << XDM_UNSUPPORTEDPARAM;
+            return IMGENC1_EFAIL;
+        }
+        if (params->qValue != h->quality)
+            stub_close_codec(h);
+        h->quality = params->qValue;
+        break;
+    case XDM_GETBUFINFO:
+    case XDM_GETSTATUS:
+        fill_buf_info(h, &status->bufInfo);
+        status->totalAU = 1;
+        break;
+    case XDM_SETDEFAULT:
+    case XDM_FLUSH:
+        break;
+    case XDM_RESET:
+        stub_close_codec(h);
+        break;
+    default:
+        status->extendedError = 1 << XDM_UNSUPPORTEDPARAM;
+        return IMGENC1_EUNSUPPORTED;
+    }
+
+    return IMGENC1_EOK;
+}
+
+Int32 IMGENC1_process(IMGENC1_Handle h, XDM1_BufDesc *inBufs,
+                      XDM1_BufDesc *outBufs, IMGENC1_InArgs *inArgs,
+                      IMGENC1_OutArgs *outArgs)
+{
+    int64_t start = stub_time();
+    int ret, frame_type;
+
+    stub_check_buf(h, inBufs->descs[0].buf);
+    stub_check_buf(h, inBufs->descs[1].buf);
+    stub_check_buf(h, outBufs->descs[0].buf);
+
+    outArgs->extendedError  = 0;
+    outArgs->bytesGenerated = 0;
+    outArgs->currentAU      = 0;
+
+    ret = -1;
+    if (inBufs->numBufs >= 2 && outBufs->numBufs >= 1)
+        ret = encode_software(h, (const uint8_t *) inBufs->descs[0].buf,
+                              inBufs->descs[0].bufSize,
+                              (const uint8_t *) inBufs->descs[1].buf,
+                              inBufs->descs[1].bufSize,
+                              (uint8_t *) outBufs->descs[0].buf,
+                              outBufs->descs[0].bufSize, &frame_type);
+    stub_account(h, start);
+
+    if (ret < 0) {
+        outArgs->extendedError = 1 << XDM_UNSUPPORTEDINPUT;
+        return IMGENC1_EFAIL;
+    }
+
+    h->frame_count++;
+    outArgs->bytesGenerated = ret;
+    outArgs->currentAU      = 1;
+    return IMGENC1_EOK;
+}
+
+IMGDEC1_Handle IMGDEC1_create(Engine_Handle e, String name, IMGDEC1_Params *params)
+{
+    if (!e || !params || params->forceChromaFormat != XDM_YUV_420SP)
+        return NULL;
+    return stub_create(name, STUB_IMGDEC1, params->maxWidth, params->maxHeight);
+}
+
+Void IMGDEC1_delete(IMGDEC1_Handle handle)
+{
+    stub_delete(handle);
+}
+
+Int32 IMGDEC1_control(IMGDEC1_Handle h, IMGDEC1_Cmd id,
+                      IMGDEC1_DynamicParams *params, IMGDEC1_Status *status)
+{
+    int height = FFALIGN(h->max_height, 16);
+
+    status->extendedError = 0;
+
+    switch (id) {
+    case XDM_GETBUFINFO:
+        status->bufInfo.minNumInBufs     = 1;
+        status->bufInfo.minInBufSize[0]  = h->pitch * height * 2;
+        status->bufInfo.minNumOutBufs    = 2;
+        status->bufInfo.minOutBufSize[0] = h->pitch * height;
+        status->bufInfo.minOutBufSize[1] = h->pitch * height / 2;
+        break;
+    case XDM_GETSTATUS:
+        status->outputWidth     = h->avctx ? h->avctx->width  : 0;
+        status->outputHeight    = h->avctx ? h->avctx->height : 0;
+        status->imageWidth      = status->outputWidth;
+        status->outChromaFormat = XDM_YUV_420SP;
+        status->totalAU         = 1;
+        status->totalScan       = 1;
+        break;
+    case XDM_SETPARAMS:
+        if (params->displayWidth) {
+            if (params->displayWidth < h->max_width ||
+                params->displayWidth & 1) {
+                status->extendedError = 1 << XDM_UNSUPPORTEDPARAM;
+                return IMGDEC1_EFAIL;
+            }
+            h->pitch = params->displayWidth;
+        }
+        break;
+    case XDM_SETDEFAULT:
+    case XDM_RESET:
+        break;
+    default:
+        return IMGDEC1_EUNSUPPORTED;
+    }
+
+    return IMGDEC1_EOK;
+}
+
+static Int32 imgdec1_process(IMGDEC1_Handle h, XDM1_BufDesc *inBufs,
+                             XDM1_BufDesc *outBufs, IMGDEC1_InArgs *inArgs,
+                             IMGDEC1_OutArgs *outArgs)
+{
+    AVPacket pkt;
+    StubOutBuf ob;
+    IVIDEO1_BufDesc bd;
+    int got_picture = 0, ret;
+
+    outArgs->extendedError = 0;
+    outArgs->bytesConsumed = 0;
+    outArgs->currentAU     = 0;
+    outArgs->currentScan   = 0;
+
+    if (stub_open_codec(h) < 0) {
+        outArgs->extendedError = 1 << XDM_FATALERROR;
+        return IMGDEC1_EFAIL;
+    }
+    if (outBufs->numBufs < 2) {
+        outArgs->extendedError = 1 << XDM_UNSUPPORTEDPARAM;
+        return IMGDEC1_EFAIL;
+    }
+
+    av_init_packet(&pkt);
+    if (load_packet(h, &pkt, inBufs->descs[0].buf, inArgs->numBytes) < 0) {
+        outArgs->extendedError = 1 << XDM_FATALERROR;
+        return IMGDEC1_EFAIL;
+    }
+
+    ret = avcodec_decode_video2(h->avctx, h->frame, &got_picture, &pkt);
+    if (ret < 0 || !got_picture) {
+        outArgs->extendedError = 1 << XDM_CORRUPTEDDATA;
+        return IMGDEC1_EFAIL;
+    }
+    if (stub_too_large(h)) {
+        outArgs->extendedError = 1 << XDM_UNSUPPORTEDPARAM;
+        return IMGDEC1_EFAIL;
+    }
+
+    ob.id       = 0;
+    ob.bufs[0]  = outBufs->descs[0].buf;
+    ob.bufs[1]  = outBufs->descs[1].buf;
+    ob.sizes[0] = outBufs->descs[0].bufSize;
+    ob.sizes[1] = outBufs->descs[1].bufSize;
+    if (store_nv12(h, &ob, h->frame, &bd) < 0) {
+        outArgs->extendedError = 1 << XDM_UNSUPPORTEDINPUT;
+        return IMGDEC1_EFAIL;
+    }
+
+    outArgs->bytesConsumed = inArgs->numBytes;
+    outArgs->currentAU     = (h->avctx->width  + 15 >> 4) *
+                             (h->avctx->height + 15 >> 4);
+    outArgs->currentScan   = 1;
+    return IMGDEC1_EOK;
+}
+
+Int32 IMGDEC1_process(IMGDEC1_Handle h, XDM1_BufDesc *inBufs,
+                      XDM1_BufDesc *outBufs, IMGDEC1_InArgs *inArgs,
+                      IMGDEC1_OutArgs *outArgs)
+{
+    int64_t start = stub_time();
+    Int32 ret;
+    int i;
+
+    stub_check_buf(h, inBufs->descs[0].buf);
+    for (i = 0; i < outBufs->numBufs; i++)
+        stub_check_buf(h, outBufs->descs[i].buf);
+
+    ret = imgdec1_process(h, inBufs, outBufs, inArgs, outArgs);
+    stub_account(h, start);
+    return ret;
+}
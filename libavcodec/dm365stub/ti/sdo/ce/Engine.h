@@ -0,0 +1,44 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_SDO_CE_ENGINE_H
+#define DM365STUB_TI_SDO_CE_ENGINE_H
+
+#include <xdc/std.h>
+
+typedef struct Engine_Obj *Engine_Handle;
+
+typedef Int Engine_Error;
+
+#define Engine_EOK      0
+#define Engine_EEXIST   1
+#define Engine_ENOMEM   2
+#define Engine_ENOTFOUND 6
+
+typedef struct Engine_Attrs {
+    String procId;
+} Engine_Attrs;
+
+Engine_Handle Engine_open(String name, Engine_Attrs *attrs, Engine_Error *ec);
+Void Engine_close(Engine_Handle engine);
+Engine_Error Engine_getLastError(Engine_Handle engine);
+
+#endif /* DM365STUB_TI_SDO_CE_ENGINE_H */
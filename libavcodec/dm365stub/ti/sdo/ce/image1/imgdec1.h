@@ -0,0 +1,50 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_SDO_CE_IMAGE1_IMGDEC1_H
+#define DM365STUB_TI_SDO_CE_IMAGE1_IMGDEC1_H
+
+#include <xdc/std.h>
+#include <ti/xdais/dm/iimgdec1.h>
+#include <ti/sdo/ce/Engine.h>
+#include <ti/sdo/ce/visa.h>
+
+#define IMGDEC1_EOK             IIMGDEC1_EOK
+#define IMGDEC1_EFAIL           IIMGDEC1_EFAIL
+#define IMGDEC1_EUNSUPPORTED    IIMGDEC1_EUNSUPPORTED
+
+typedef VISA_Handle IMGDEC1_Handle;
+typedef IIMGDEC1_Params IMGDEC1_Params;
+typedef IIMGDEC1_DynamicParams IMGDEC1_DynamicParams;
+typedef IIMGDEC1_InArgs IMGDEC1_InArgs;
+typedef IIMGDEC1_OutArgs IMGDEC1_OutArgs;
+typedef IIMGDEC1_Status IMGDEC1_Status;
+typedef IIMGDEC1_Cmd IMGDEC1_Cmd;
+
+IMGDEC1_Handle IMGDEC1_create(Engine_Handle e, String name, IMGDEC1_Params *params);
+Int32 IMGDEC1_process(IMGDEC1_Handle handle, XDM1_BufDesc *inBufs,
+                      XDM1_BufDesc *outBufs, IMGDEC1_InArgs *inArgs,
+                      IMGDEC1_OutArgs *outArgs);
+Int32 IMGDEC1_control(IMGDEC1_Handle handle, IMGDEC1_Cmd id,
+                      IMGDEC1_DynamicParams *params, IMGDEC1_Status *status);
+Void IMGDEC1_delete(IMGDEC1_Handle handle);
+
+#endif /* DM365STUB_TI_SDO_CE_IMAGE1_IMGDEC1_H */
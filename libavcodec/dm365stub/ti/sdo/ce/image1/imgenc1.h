@@ -0,0 +1,50 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_SDO_CE_IMAGE1_IMGENC1_H
+#define DM365STUB_TI_SDO_CE_IMAGE1_IMGENC1_H
+
+#include <xdc/std.h>
+#include <ti/xdais/dm/iimgenc1.h>
+#include <ti/sdo/ce/Engine.h>
+#include <ti/sdo/ce/visa.h>
+
+#define IMGENC1_EOK             IIMGENC1_EOK
+#define IMGENC1_EFAIL           IIMGENC1_EFAIL
+#define IMGENC1_EUNSUPPORTED    IIMGENC1_EUNSUPPORTED
+
+typedef VISA_Handle IMGENC1_Handle;
+typedef IIMGENC1_Params IMGENC1_Params;
+typedef IIMGENC1_DynamicParams IMGENC1_DynamicParams;
+typedef IIMGENC1_InArgs IMGENC1_InArgs;
+typedef IIMGENC1_OutArgs IMGENC1_OutArgs;
+typedef IIMGENC1_Status IMGENC1_Status;
+typedef IIMGENC1_Cmd IMGENC1_Cmd;
+
+IMGENC1_Handle IMGENC1_create(Engine_Handle e, String name, IMGENC1_Params *params);
+Int32 IMGENC1_process(IMGENC1_Handle handle, XDM1_BufDesc *inBufs,
+                      XDM1_BufDesc *outBufs, IMGENC1_InArgs *inArgs,
+                      IMGENC1_OutArgs *outArgs);
+Int32 IMGENC1_control(IMGENC1_Handle handle, IMGENC1_Cmd id,
+                      IMGENC1_DynamicParams *params, IMGENC1_Status *status);
+Void IMGENC1_delete(IMGENC1_Handle handle);
+
+#endif /* DM365STUB_TI_SDO_CE_IMAGE1_IMGENC1_H */
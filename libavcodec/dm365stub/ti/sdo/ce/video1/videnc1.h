@@ -0,0 +1,50 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_SDO_CE_VIDEO1_VIDENC1_H
+#define DM365STUB_TI_SDO_CE_VIDEO1_VIDENC1_H
+
+#include <xdc/std.h>
+#include <ti/xdais/dm/ividenc1.h>
+#include <ti/sdo/ce/Engine.h>
+#include <ti/sdo/ce/visa.h>
+
+#define VIDENC1_EOK             IVIDENC1_EOK
+#define VIDENC1_EFAIL           IVIDENC1_EFAIL
+#define VIDENC1_EUNSUPPORTED    IVIDENC1_EUNSUPPORTED
+
+typedef VISA_Handle VIDENC1_Handle;
+typedef IVIDENC1_Params VIDENC1_Params;
+typedef IVIDENC1_DynamicParams VIDENC1_DynamicParams;
+typedef IVIDENC1_InArgs VIDENC1_InArgs;
+typedef IVIDENC1_OutArgs VIDENC1_OutArgs;
+typedef IVIDENC1_Status VIDENC1_Status;
+typedef IVIDENC1_Cmd VIDENC1_Cmd;
+
+VIDENC1_Handle VIDENC1_create(Engine_Handle e, String name, VIDENC1_Params *params);
+Int32 VIDENC1_process(VIDENC1_Handle handle, IVIDEO1_BufDescIn *inBufs,
+                      XDM_BufDesc *outBufs, VIDENC1_InArgs *inArgs,
+                      VIDENC1_OutArgs *outArgs);
+Int32 VIDENC1_control(VIDENC1_Handle handle, VIDENC1_Cmd id,
+                      VIDENC1_DynamicParams *params, VIDENC1_Status *status);
+Void VIDENC1_delete(VIDENC1_Handle handle);
+
+#endif /* DM365STUB_TI_SDO_CE_VIDEO1_VIDENC1_H */
@@ -0,0 +1,50 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_SDO_CE_VIDEO2_VIDDEC2_H
+#define DM365STUB_TI_SDO_CE_VIDEO2_VIDDEC2_H
+
+#include <xdc/std.h>
+#include <ti/xdais/dm/ividdec2.h>
+#include <ti/sdo/ce/Engine.h>
+#include <ti/sdo/ce/visa.h>
+
+#define VIDDEC2_EOK             IVIDDEC2_EOK
+#define VIDDEC2_EFAIL           IVIDDEC2_EFAIL
+#define VIDDEC2_EUNSUPPORTED    IVIDDEC2_EUNSUPPORTED
+
+typedef VISA_Handle VIDDEC2_Handle;
+typedef IVIDDEC2_Params VIDDEC2_Params;
+typedef IVIDDEC2_DynamicParams VIDDEC2_DynamicParams;
+typedef IVIDDEC2_InArgs VIDDEC2_InArgs;
+typedef IVIDDEC2_OutArgs VIDDEC2_OutArgs;
+typedef IVIDDEC2_Status VIDDEC2_Status;
+typedef IVIDDEC2_Cmd VIDDEC2_Cmd;
+
+VIDDEC2_Handle VIDDEC2_create(Engine_Handle e, String name, VIDDEC2_Params *params);
+Int32 VIDDEC2_process(VIDDEC2_Handle handle, XDM1_BufDesc *inBufs,
+                      XDM_BufDesc *outBufs, VIDDEC2_InArgs *inArgs,
+                      VIDDEC2_OutArgs *outArgs);
+Int32 VIDDEC2_control(VIDDEC2_Handle handle, VIDDEC2_Cmd id,
+                      VIDDEC2_DynamicParams *params, VIDDEC2_Status *status);
+Void VIDDEC2_delete(VIDDEC2_Handle handle);
+
+#endif /* DM365STUB_TI_SDO_CE_VIDEO2_VIDDEC2_H */
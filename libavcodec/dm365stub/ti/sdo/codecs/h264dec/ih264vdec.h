@@ -0,0 +1,78 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_SDO_CODECS_H264DEC_IH264VDEC_H
+#define DM365STUB_TI_SDO_CODECS_H264DEC_IH264VDEC_H
+
+#include <ti/xdais/dm/ividdec2.h>
+
+typedef enum {
+    LEVEL_1_0 = 10,
+    LEVEL_1_1 = 11,
+    LEVEL_1_2 = 12,
+    LEVEL_1_3 = 13,
+    LEVEL_2_0 = 20,
+    LEVEL_2_1 = 21,
+    LEVEL_2_2 = 22,
+    LEVEL_3_0 = 30,
+    LEVEL_3_1 = 31,
+    LEVEL_3_2 = 32,
+    LEVEL_4_0 = 40,
+    LEVEL_4_1 = 41,
+    LEVEL_4_2 = 42,
+    LEVEL_5_0 = 50,
+    LEVEL_5_1 = 51
+} IH264VDEC_LevelLimit;
+
+typedef enum {
+    IH264VDEC_TI_ENTIREFRAME = 0,
+    IH264VDEC_TI_SLICEMODE = 1
+} IH264VDEC_InputDataMode;
+
+typedef enum {
+    IH264VDEC_TI_NALSTREAM = 0,
+    IH264VDEC_TI_BYTESTREAM = 1
+} IH264VDEC_SliceFormat;
+
+typedef XDAS_Int32 IH264VDEC_ExtendedError;
+
+typedef struct IH264VDEC_Params {
+    IVIDDEC2_Params viddecParams;
+    XDAS_Int32  displayDelay;
+    XDAS_Int32  hdvicpHandle;
+    XDAS_Int32  disableHDVICPeveryFrame;
+    XDAS_Int32  levelLimit;
+    XDAS_Int32  frame_closedloop_flag;
+    XDAS_Int32  inputDataMode;
+    XDAS_Int32  sliceFormat;
+} IH264VDEC_Params;
+
+typedef struct IH264VDEC_DynamicParams {
+    IVIDDEC2_DynamicParams viddecDynamicParams;
+    XDAS_Int32  mbErrorBufFlag;
+    XDAS_Int32  Sei_Vui_parse_flag;
+    XDAS_Int32  numNALunits;
+    XDAS_Int32  resetHDVICPeveryFrame;
+} IH264VDEC_DynamicParams;
+
+extern IH264VDEC_Params IH264VDEC_PARAMS;
+
+#endif /* DM365STUB_TI_SDO_CODECS_H264DEC_IH264VDEC_H */
@@ -0,0 +1,150 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_SDO_CODECS_H264ENC_IH264VENC_H
+#define DM365STUB_TI_SDO_CODECS_H264ENC_IH264VENC_H
+
+#include <ti/xdais/dm/ividenc1.h>
+
+typedef XDAS_Int32 IH264VENC_STATUS;
+
+typedef enum {
+    IH264VENC_TI_ENTIREFRAME = 0,
+    IH264VENC_TI_SLICEMODE = 1
+} IH264VENC_OutputDataMode;
+
+typedef enum {
+    IH264VENC_SLICEMODE_NONE = 0,
+    IH264VENC_SLICEMODE_MBUNIT = 1,
+    IH264VENC_SLICEMODE_BYTES = 2
+} IH264VENC_SliceMode;
+
+#define MAX_ROI 5
+
+typedef enum {
+    FACE_OBJECT = 0,
+    BACKGROUND_OBJECT = 1,
+    FOREGROUND_OBJECT = 2,
+    DEFAULT_OBJECT = 3,
+    PRIVACY_MASK = 4
+} ROI_type;
+
+typedef struct ROI_Interface {
+    XDM_Rect    listROI[MAX_ROI];
+    ROI_type    roiType[MAX_ROI];
+    XDAS_Int32  numOfROI;
+    XDAS_Int32  roiPriority[MAX_ROI];
+} ROI_Interface;
+
+typedef struct IH264VENC_VUIDataStructure {
+    XDAS_UInt8  aspectRatioInfoPresentFlag;
+    XDAS_UInt8  overscanInfoPresentFlag;
+    XDAS_UInt8  videoSignalTypePresentFlag;
+    XDAS_UInt8  videoFormat;
+    XDAS_UInt8  videoFullRangeFlag;
+    XDAS_UInt8  timingInfoPresentFlag;
+    XDAS_UInt32 numUnitsInTicks;
+    XDAS_UInt32 timeScale;
+    XDAS_UInt8  fixedFrameRateFlag;
+    XDAS_UInt8  nalHrdParameterspresentflag;
+    XDAS_UInt8  picStructPresentFlag;
+    XDAS_UInt8  bitstreamRestrictionFlag;
+} IH264VENC_VUIDataStructure;
+
+typedef struct IH264VENC_Params {
+    IVIDENC1_Params videncParams;
+    XDAS_Int32  profileIdc;
+    XDAS_Int32  levelIdc;
+    XDAS_Int32  Log2MaxFrameNumMinus4;
+    XDAS_Int32  ConstraintSetFlag;
+    XDAS_Int32  entropyMode;
+    XDAS_Int32  transform8x8FlagIntraFrame;
+    XDAS_Int32  transform8x8FlagInterFrame;
+    XDAS_Int32  enableVUIparams;
+    XDAS_Int32  meAlgo;
+    XDAS_Int32  seqScalingFlag;
+    XDAS_Int32  encQuality;
+    XDAS_Int32  enableARM926Tcm;
+    XDAS_Int32  enableDDRbuff;
+    XDAS_Int32  sliceMode;
+    XDAS_Int32  numTemporalLayers;
+    XDAS_Int32  svcSyntaxEnable;
+    XDAS_Int32  EnableLongTermFrame;
+    XDAS_Int32  outputDataMode;
+    XDAS_Int32  sliceFormat;
+} IH264VENC_Params;
+
+typedef struct IH264VENC_DynamicParams {
+    IVIDENC1_DynamicParams videncDynamicParams;
+    XDAS_Int32  sliceSize;
+    XDAS_Int32  airRate;
+    XDAS_Int32  intraFrameQP;
+    XDAS_Int32  interPFrameQP;
+    XDAS_Int32  initQ;
+    XDAS_Int32  rcQMax;
+    XDAS_Int32  rcQMin;
+    XDAS_Int32  rcQMaxI;
+    XDAS_Int32  rcQMinI;
+    XDAS_Int32  rcAlgo;
+    XDAS_Int32  maxDelay;
+    XDAS_Int32  aspectRatioX;
+    XDAS_Int32  aspectRatioY;
+    XDAS_Int32  lfDisableIdc;
+    XDAS_Int32  enableBufSEI;
+    XDAS_Int32  enablePicTimSEI;
+    XDAS_Int32  perceptualRC;
+    XDAS_Int32  idrFrameInterval;
+    XDAS_Int32  mvSADoutFlag;
+    XDAS_Int32  resetHDVICPeveryFrame;
+    XDAS_Int32  enableROI;
+    XDAS_Int32  metaDataGenerateConsume;
+    XDAS_Int32  maxBitrateCVBR;
+    XDAS_Int32  interlaceRefMode;
+    XDAS_Int32  enableGDR;
+    XDAS_Int32  GDRduration;
+    XDAS_Int32  GDRinterval;
+    XDAS_Int32  LongTermRefreshInterval;
+    XDAS_Int32  UseLongTermFrame;
+    XDAS_Int32  SetLongTermFrame;
+    XDAS_Int32  CVBRsensitivity;
+    XDAS_Int32  CVBRminbitrate;
+    XDAS_Int32  LBRmaxpicsize;
+    XDAS_Int32  LBRminpicsize;
+    XDAS_Int32  LBRskipcontrol;
+    XDAS_Int32  maxHighCmpxIntCVBR;
+    XDAS_Int32  disableMVDCostFactor;
+    IH264VENC_VUIDataStructure *VUI_Buffer;
+} IH264VENC_DynamicParams;
+
+typedef struct IH264VENC_InArgs {
+    IVIDENC1_InArgs videncInArgs;
+    XDAS_UInt32 timeStamp;
+    XDAS_Int32  insertUserData;
+    XDAS_Int32  lengthUserData;
+    ROI_Interface roiParameters;
+    XDAS_Int32  numOutputDataUnits;
+} IH264VENC_InArgs;
+
+extern IH264VENC_Params IH264VENC_PARAMS;
+extern IH264VENC_DynamicParams H264VENC_TI_IH264VENC_DYNAMICPARAMS;
+extern IH264VENC_VUIDataStructure H264VENC_TI_VUIPARAMBUFFER;
+
+#endif /* DM365STUB_TI_SDO_CODECS_H264ENC_IH264VENC_H */
@@ -0,0 +1,47 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_SDO_CODECS_JPEGDEC_IJPEGDEC_H
+#define DM365STUB_TI_SDO_CODECS_JPEGDEC_IJPEGDEC_H
+
+#include <ti/xdais/dm/iimgdec1.h>
+
+typedef enum {
+    JPEGDEC_SUCCESS = 0,
+    JPEGDEC_ERR_INVALID_PARAMS = 1,
+    JPEGDEC_ERR_UNSUPPORTED = 2,
+    JPEGDEC_ERR_CORRUPTED_DATA = 3
+} DM365_JPEGDEC_ERROR;
+
+typedef struct IJPEGDEC_Params {
+    IIMGDEC1_Params imgdecParams;
+    XDAS_Void   (*halfBufCB)(XDAS_Int32 bufPtr, void *arg);
+    XDAS_Void   *halfBufCBarg;
+} IJPEGDEC_Params;
+
+typedef struct IJPEGDEC_DynamicParams {
+    IIMGDEC1_DynamicParams imgdecDynamicParams;
+    XDAS_Int32  disableEOI;
+    XDAS_Int32  resizeOption;
+    XDAS_Int32  rotation;
+} IJPEGDEC_DynamicParams;
+
+#endif /* DM365STUB_TI_SDO_CODECS_JPEGDEC_IJPEGDEC_H */
@@ -0,0 +1,48 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_SDO_CODECS_JPEGENC_IJPEGENC_H
+#define DM365STUB_TI_SDO_CODECS_JPEGENC_IJPEGENC_H
+
+#include <ti/xdais/dm/iimgenc1.h>
+
+typedef enum {
+    JPEGENC_SUCCESS = 0,
+    JPEGENC_ERR_INVALID_PARAMS = 1,
+    JPEGENC_ERR_UNSUPPORTED = 2,
+    JPEGENC_ERR_OUTPUT_BUFFER = 3
+} DM365_JPEGENC_ERROR;
+
+typedef struct IJPEGENC_Params {
+    IIMGENC1_Params imgencParams;
+    XDAS_Void   (*halfBufCB)(XDAS_Int32 bufPtr, void *arg);
+    XDAS_Void   *halfBufCBarg;
+} IJPEGENC_Params;
+
+typedef struct IJPEGENC_DynamicParams {
+    IIMGENC1_DynamicParams imgencDynamicParams;
+    XDAS_Int32  rstInterval;
+    XDAS_Int32  disableEOI;
+    XDAS_Int32  rotation;
+    XDAS_Int32  *customQ;
+} IJPEGENC_DynamicParams;
+
+#endif /* DM365STUB_TI_SDO_CODECS_JPEGENC_IJPEGENC_H */
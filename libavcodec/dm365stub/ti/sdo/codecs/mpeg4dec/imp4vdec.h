@@ -0,0 +1,44 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_SDO_CODECS_MPEG4DEC_IMP4VDEC_H
+#define DM365STUB_TI_SDO_CODECS_MPEG4DEC_IMP4VDEC_H
+
+#include <ti/xdais/dm/ividdec2.h>
+
+typedef XDAS_Int32 IMP4VDEC_ExtendedError;
+
+typedef struct IMP4VDEC_Params {
+    IVIDDEC2_Params viddecParams;
+    XDAS_Int32  displayDelay;
+    XDAS_Int32  hdvicpHandle;
+    XDAS_Int32  disableHDVICPeveryFrame;
+} IMP4VDEC_Params;
+
+typedef struct IMP4VDEC_DynamicParams {
+    IVIDDEC2_DynamicParams viddecDynamicParams;
+    XDAS_Int32  postDeblock;
+    XDAS_Int32  resetHDVICPeveryFrame;
+} IMP4VDEC_DynamicParams;
+
+extern IMP4VDEC_Params IMP4VDEC_PARAMS;
+
+#endif /* DM365STUB_TI_SDO_CODECS_MPEG4DEC_IMP4VDEC_H */
@@ -0,0 +1,78 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_SDO_CODECS_MPEG4ENC_IMP4VENC_H
+#define DM365STUB_TI_SDO_CODECS_MPEG4ENC_IMP4VENC_H
+
+#include <ti/xdais/dm/ividenc1.h>
+
+typedef enum {
+    IMP4VENC_INTRA_INTER_DECISION_LQ_HP = 0,
+    IMP4VENC_INTRA_INTER_DECISION_HQ_LP = 1
+} IMP4VENC_IntraAlgo;
+
+typedef enum {
+    IMP4VENC_ME_MQ_MP = 0,
+    IMP4VENC_ME_HQ_MP = 1,
+    IMP4VENC_ME_HQ_LP = 2
+} IMP4VENC_MeAlgo;
+
+typedef enum {
+    IMP4VENC_SKIP_MB_LQ_HP = 0,
+    IMP4VENC_SKIP_MB_HQ_LP = 1
+} IMP4VENC_SkipMBAlgo;
+
+typedef enum {
+    IMP4VENC_UMV_LQ_HP = 0,
+    IMP4VENC_UMV_HQ_LP = 1
+} IMP4VENC_UnrestrictedMV;
+
+typedef struct IMP4VENC_Params {
+    IVIDENC1_Params videncParams;
+    XDAS_Int32  subWindowHeight;
+    XDAS_Int32  subWindowWidth;
+    XDAS_Int32  rotation;
+    XDAS_Int32  vbvSize;
+    XDAS_Int32  svhMode;
+    XDAS_Int32  IFrameBitRateBiasFactor;
+    XDAS_Int32  PFrameBitRateBiasFactor;
+    XDAS_Int32  peakBufWindow;
+    XDAS_Int32  minBitRate;
+} IMP4VENC_Params;
+
+typedef struct IMP4VENC_DynamicParams {
+    IVIDENC1_DynamicParams videncDynamicParams;
+    XDAS_Int32  intraAlgo;
+    XDAS_Int32  numMBRows;
+    XDAS_Int32  initQ;
+    XDAS_Int32  rcQMax;
+    XDAS_Int32  rcQMin;
+    XDAS_Int32  intraFrameQP;
+    XDAS_Int32  interFrameQP;
+    XDAS_Int32  rateFix;
+    XDAS_Int32  rateFixRange;
+    XDAS_Int32  meAlgo;
+    XDAS_Int32  skipMBAlgo;
+    XDAS_Int32  unrestrictedMV;
+    XDAS_Int32  mvDataEnable;
+} IMP4VENC_DynamicParams;
+
+#endif /* DM365STUB_TI_SDO_CODECS_MPEG4ENC_IMP4VENC_H */
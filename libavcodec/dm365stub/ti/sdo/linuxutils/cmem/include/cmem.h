@@ -0,0 +1,51 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_SDO_LINUXUTILS_CMEM_CMEM_H
+#define DM365STUB_TI_SDO_LINUXUTILS_CMEM_CMEM_H
+
+#include <stddef.h>
+
+#define CMEM_NONCACHED  0x0000
+#define CMEM_CACHED     0x0020
+
+typedef enum {
+    CMEM_POOL = 0,
+    CMEM_HEAP = 1
+} CMEM_Type;
+
+typedef struct CMEM_AllocParams {
+    CMEM_Type   type;
+    int         flags;
+    size_t      alignment;
+} CMEM_AllocParams;
+
+extern CMEM_AllocParams CMEM_DEFAULTPARAMS;
+
+int CMEM_init(void);
+int CMEM_exit(void);
+void *CMEM_alloc(size_t size, CMEM_AllocParams *params);
+int CMEM_free(void *ptr, CMEM_AllocParams *params);
+unsigned long CMEM_getPhys(void *ptr);
+int CMEM_cacheWb(void *ptr, size_t size);
+int CMEM_cacheInv(void *ptr, size_t size);
+
+#endif /* DM365STUB_TI_SDO_LINUXUTILS_CMEM_CMEM_H */
@@ -0,0 +1,75 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_XDAIS_DM_IIMGDEC1_H
+#define DM365STUB_TI_XDAIS_DM_IIMGDEC1_H
+
+#include <ti/xdais/dm/xdm.h>
+
+#define IIMGDEC1_EOK            XDM_EOK
+#define IIMGDEC1_EFAIL          XDM_EFAIL
+#define IIMGDEC1_EUNSUPPORTED   XDM_EUNSUPPORTED
+
+typedef struct IIMGDEC1_Params {
+    XDAS_Int32  size;
+    XDAS_Int32  maxHeight;
+    XDAS_Int32  maxWidth;
+    XDAS_Int32  maxScans;
+    XDAS_Int32  dataEndianness;
+    XDAS_Int32  forceChromaFormat;
+} IIMGDEC1_Params;
+
+typedef struct IIMGDEC1_DynamicParams {
+    XDAS_Int32  size;
+    XDAS_Int32  numAU;
+    XDAS_Int32  decodeHeader;
+    XDAS_Int32  displayWidth;
+} IIMGDEC1_DynamicParams;
+
+typedef struct IIMGDEC1_InArgs {
+    XDAS_Int32  size;
+    XDAS_Int32  numBytes;
+} IIMGDEC1_InArgs;
+
+typedef struct IIMGDEC1_OutArgs {
+    XDAS_Int32  size;
+    XDAS_Int32  extendedError;
+    XDAS_Int32  bytesConsumed;
+    XDAS_Int32  currentAU;
+    XDAS_Int32  currentScan;
+} IIMGDEC1_OutArgs;
+
+typedef struct IIMGDEC1_Status {
+    XDAS_Int32  size;
+    XDAS_Int32  extendedError;
+    XDM1_SingleBufDesc data;
+    XDAS_Int32  outputHeight;
+    XDAS_Int32  outputWidth;
+    XDAS_Int32  imageWidth;
+    XDAS_Int32  outChromaFormat;
+    XDAS_Int32  totalAU;
+    XDAS_Int32  totalScan;
+    XDM_AlgBufInfo bufInfo;
+} IIMGDEC1_Status;
+
+typedef XDM_CmdId IIMGDEC1_Cmd;
+
+#endif /* DM365STUB_TI_XDAIS_DM_IIMGDEC1_H */
@@ -0,0 +1,72 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_XDAIS_DM_IIMGENC1_H
+#define DM365STUB_TI_XDAIS_DM_IIMGENC1_H
+
+#include <ti/xdais/dm/xdm.h>
+
+#define IIMGENC1_EOK            XDM_EOK
+#define IIMGENC1_EFAIL          XDM_EFAIL
+#define IIMGENC1_EUNSUPPORTED   XDM_EUNSUPPORTED
+
+typedef struct IIMGENC1_Params {
+    XDAS_Int32  size;
+    XDAS_Int32  maxHeight;
+    XDAS_Int32  maxWidth;
+    XDAS_Int32  maxScans;
+    XDAS_Int32  dataEndianness;
+    XDAS_Int32  forceChromaFormat;
+} IIMGENC1_Params;
+
+typedef struct IIMGENC1_DynamicParams {
+    XDAS_Int32  size;
+    XDAS_Int32  numAU;
+    XDAS_Int32  inputChromaFormat;
+    XDAS_Int32  inputHeight;
+    XDAS_Int32  inputWidth;
+    XDAS_Int32  captureWidth;
+    XDAS_Int32  generateHeader;
+    XDAS_Int32  qValue;
+} IIMGENC1_DynamicParams;
+
+typedef struct IIMGENC1_InArgs {
+    XDAS_Int32  size;
+} IIMGENC1_InArgs;
+
+typedef struct IIMGENC1_OutArgs {
+    XDAS_Int32  size;
+    XDAS_Int32  extendedError;
+    XDAS_Int32  bytesGenerated;
+    XDAS_Int32  currentAU;
+} IIMGENC1_OutArgs;
+
+typedef struct IIMGENC1_Status {
+    XDAS_Int32  size;
+    XDAS_Int32  extendedError;
+    XDM1_SingleBufDesc data;
+    XDAS_Int32  totalAU;
+    XDM_AlgBufInfo bufInfo;
+} IIMGENC1_Status;
+
+typedef XDM_CmdId IIMGENC1_Cmd;
+
+#endif /* DM365STUB_TI_XDAIS_DM_IIMGENC1_H */
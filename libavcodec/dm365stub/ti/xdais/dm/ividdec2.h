@@ -0,0 +1,93 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_XDAIS_DM_IVIDDEC2_H
+#define DM365STUB_TI_XDAIS_DM_IVIDDEC2_H
+
+#include <ti/xdais/dm/ivideo.h>
+
+#define IVIDDEC2_EOK            XDM_EOK
+#define IVIDDEC2_EFAIL          XDM_EFAIL
+#define IVIDDEC2_EUNSUPPORTED   XDM_EUNSUPPORTED
+
+#define IVIDEO2_MAX_IO_BUFFERS  20
+
+typedef enum {
+    IVIDDEC2_DISPLAY_ORDER = 0,
+    IVIDDEC2_DECODE_ORDER = 1
+} IVIDDEC2_FrameOrder;
+
+typedef struct IVIDDEC2_Params {
+    XDAS_Int32  size;
+    XDAS_Int32  maxHeight;
+    XDAS_Int32  maxWidth;
+    XDAS_Int32  maxFrameRate;
+    XDAS_Int32  maxBitRate;
+    XDAS_Int32  dataEndianness;
+    XDAS_Int32  forceChromaFormat;
+} IVIDDEC2_Params;
+
+typedef struct IVIDDEC2_DynamicParams {
+    XDAS_Int32  size;
+    XDAS_Int32  decodeHeader;
+    XDAS_Int32  displayWidth;
+    XDAS_Int32  frameSkipMode;
+    XDAS_Int32  frameOrder;
+    XDAS_Int32  newFrameFlag;
+    XDAS_Int32  mbDataFlag;
+} IVIDDEC2_DynamicParams;
+
+typedef struct IVIDDEC2_InArgs {
+    XDAS_Int32  size;
+    XDAS_Int32  numBytes;
+    XDAS_Int32  inputID;
+} IVIDDEC2_InArgs;
+
+typedef struct IVIDDEC2_OutArgs {
+    XDAS_Int32  size;
+    XDAS_Int32  extendedError;
+    XDAS_Int32  bytesConsumed;
+    XDAS_Int32  outputID[IVIDEO2_MAX_IO_BUFFERS];
+    IVIDEO1_BufDesc decodedBufs;
+    IVIDEO1_BufDesc displayBufs[IVIDEO2_MAX_IO_BUFFERS];
+    XDAS_Int32  outputMbDataID;
+    XDM1_SingleBufDesc mbDataBuf;
+    XDAS_Int32  freeBufID[IVIDEO2_MAX_IO_BUFFERS];
+    XDAS_Int32  outBufsInUseFlag;
+} IVIDDEC2_OutArgs;
+
+typedef struct IVIDDEC2_Status {
+    XDAS_Int32  size;
+    XDAS_Int32  extendedError;
+    XDM1_SingleBufDesc data;
+    XDAS_Int32  maxNumDisplayBufs;
+    XDAS_Int32  outputHeight;
+    XDAS_Int32  outputWidth;
+    XDAS_Int32  frameRate;
+    XDAS_Int32  bitRate;
+    XDAS_Int32  contentType;
+    XDAS_Int32  outputChromaFormat;
+    XDM_AlgBufInfo bufInfo;
+} IVIDDEC2_Status;
+
+typedef XDM_CmdId IVIDDEC2_Cmd;
+
+#endif /* DM365STUB_TI_XDAIS_DM_IVIDDEC2_H */
@@ -0,0 +1,87 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_XDAIS_DM_IVIDENC1_H
+#define DM365STUB_TI_XDAIS_DM_IVIDENC1_H
+
+#include <ti/xdais/dm/ivideo.h>
+
+#define IVIDENC1_EOK            XDM_EOK
+#define IVIDENC1_EFAIL          XDM_EFAIL
+#define IVIDENC1_EUNSUPPORTED   XDM_EUNSUPPORTED
+
+typedef struct IVIDENC1_Params {
+    XDAS_Int32  size;
+    XDAS_Int32  encodingPreset;
+    XDAS_Int32  rateControlPreset;
+    XDAS_Int32  maxHeight;
+    XDAS_Int32  maxWidth;
+    XDAS_Int32  maxFrameRate;
+    XDAS_Int32  maxBitRate;
+    XDAS_Int32  dataEndianness;
+    XDAS_Int32  maxInterFrameInterval;
+    XDAS_Int32  inputChromaFormat;
+    XDAS_Int32  inputContentType;
+    XDAS_Int32  reconChromaFormat;
+} IVIDENC1_Params;
+
+typedef struct IVIDENC1_DynamicParams {
+    XDAS_Int32  size;
+    XDAS_Int32  inputHeight;
+    XDAS_Int32  inputWidth;
+    XDAS_Int32  refFrameRate;
+    XDAS_Int32  targetFrameRate;
+    XDAS_Int32  targetBitRate;
+    XDAS_Int32  intraFrameInterval;
+    XDAS_Int32  generateHeader;
+    XDAS_Int32  captureWidth;
+    XDAS_Int32  forceFrame;
+    XDAS_Int32  interFrameInterval;
+    XDAS_Int32  mbDataFlag;
+} IVIDENC1_DynamicParams;
+
+typedef struct IVIDENC1_InArgs {
+    XDAS_Int32  size;
+    XDAS_Int32  inputID;
+    XDAS_Int32  topFieldFirstFlag;
+} IVIDENC1_InArgs;
+
+typedef struct IVIDENC1_OutArgs {
+    XDAS_Int32  size;
+    XDAS_Int32  extendedError;
+    XDAS_Int32  bytesGenerated;
+    XDAS_Int32  encodedFrameType;
+    XDAS_Int32  inputFrameSkip;
+    XDAS_Int32  outputID;
+    XDM1_SingleBufDesc encodedBuf;
+    IVIDEO1_BufDesc reconBufs;
+} IVIDENC1_OutArgs;
+
+typedef struct IVIDENC1_Status {
+    XDAS_Int32  size;
+    XDAS_Int32  extendedError;
+    XDM1_SingleBufDesc data;
+    XDM_AlgBufInfo bufInfo;
+} IVIDENC1_Status;
+
+typedef XDM_CmdId IVIDENC1_Cmd;
+
+#endif /* DM365STUB_TI_XDAIS_DM_IVIDENC1_H */
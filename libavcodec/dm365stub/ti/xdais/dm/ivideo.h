@@ -0,0 +1,87 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_XDAIS_DM_IVIDEO_H
+#define DM365STUB_TI_XDAIS_DM_IVIDEO_H
+
+#include <ti/xdais/dm/xdm.h>
+
+#define IVIDEO_MAX_YUV_BUFFERS  3
+
+typedef enum {
+    IVIDEO_NA_FRAME = -1,
+    IVIDEO_I_FRAME = 0,
+    IVIDEO_P_FRAME = 1,
+    IVIDEO_B_FRAME = 2,
+    IVIDEO_IDR_FRAME = 3
+} IVIDEO_FrameType;
+
+typedef enum {
+    IVIDEO_CONTENTTYPE_NA = -1,
+    IVIDEO_PROGRESSIVE = 0,
+    IVIDEO_INTERLACED = 1
+} IVIDEO_ContentType;
+
+typedef enum {
+    IVIDEO_LOW_DELAY = 1,
+    IVIDEO_STORAGE = 2,
+    IVIDEO_TWOPASS = 3,
+    IVIDEO_NONE = 4,
+    IVIDEO_USER_DEFINED = 5
+} IVIDEO_RateControlPreset;
+
+typedef enum {
+    IVIDEO_NO_SKIP = 0,
+    IVIDEO_SKIP_P = 1,
+    IVIDEO_SKIP_B = 2,
+    IVIDEO_SKIP_I = 3
+} IVIDEO_SkipMode;
+
+typedef enum {
+    IVIDEO_FRAME_ENCODED = 0,
+    IVIDEO_FRAME_SKIPPED = 1
+} IVIDEO_FrameSkip;
+
+typedef struct IVIDEO1_BufDesc {
+    XDAS_Int32  numBufs;
+    XDAS_Int32  frameWidth;
+    XDAS_Int32  frameHeight;
+    XDAS_Int32  framePitch;
+    XDM1_SingleBufDesc bufDesc[IVIDEO_MAX_YUV_BUFFERS];
+    XDAS_Int32  extendedError;
+    XDAS_Int32  frameType;
+    XDAS_Int32  topFieldFirstFlag;
+    XDAS_Int32  repeatFirstFieldFlag;
+    XDAS_Int32  frameStatus;
+    XDAS_Int32  repeatFrame;
+    XDAS_Int32  contentType;
+    XDAS_Int32  chromaFormat;
+} IVIDEO1_BufDesc;
+
+typedef struct IVIDEO1_BufDescIn {
+    XDAS_Int32  numBufs;
+    XDAS_Int32  frameWidth;
+    XDAS_Int32  frameHeight;
+    XDAS_Int32  framePitch;
+    XDM1_SingleBufDesc bufDesc[IVIDEO_MAX_YUV_BUFFERS];
+} IVIDEO1_BufDescIn;
+
+#endif /* DM365STUB_TI_XDAIS_DM_IVIDEO_H */
@@ -0,0 +1,126 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_XDAIS_DM_XDM_H
+#define DM365STUB_TI_XDAIS_DM_XDM_H
+
+#include <ti/xdais/xdas.h>
+
+#define XDM_MAX_IO_BUFFERS      16
+
+#define XDM_EOK                 0
+#define XDM_EFAIL               -1
+#define XDM_EUNSUPPORTED        -3
+
+/* bits of extendedError */
+#define XDM_PARAMSCHANGE        8
+#define XDM_APPLIEDCONCEALMENT  9
+#define XDM_INSUFFICIENTDATA    10
+#define XDM_CORRUPTEDDATA       11
+#define XDM_CORRUPTEDHEADER     12
+#define XDM_UNSUPPORTEDINPUT    13
+#define XDM_UNSUPPORTEDPARAM    14
+#define XDM_FATALERROR          15
+
+#define XDM_ISFATALERROR(x)     (((x) >> XDM_FATALERROR) & 0x1)
+
+typedef struct XDM_BufDesc {
+    XDAS_Int8   **bufs;
+    XDAS_Int32  numBufs;
+    XDAS_Int32  *bufSizes;
+} XDM_BufDesc;
+
+typedef struct XDM1_SingleBufDesc {
+    XDAS_Int8   *buf;
+    XDAS_Int32  bufSize;
+    XDAS_Int32  accessMask;
+} XDM1_SingleBufDesc;
+
+typedef struct XDM1_BufDesc {
+    XDAS_Int32  numBufs;
+    XDM1_SingleBufDesc descs[XDM_MAX_IO_BUFFERS];
+} XDM1_BufDesc;
+
+typedef struct XDM_Point {
+    XDAS_Int32  x;
+    XDAS_Int32  y;
+} XDM_Point;
+
+typedef struct XDM_Rect {
+    XDM_Point   topLeft;
+    XDM_Point   bottomRight;
+} XDM_Rect;
+
+typedef struct XDM_AlgBufInfo {
+    XDAS_Int32  minNumInBufs;
+    XDAS_Int32  minNumOutBufs;
+    XDAS_Int32  minInBufSize[XDM_MAX_IO_BUFFERS];
+    XDAS_Int32  minOutBufSize[XDM_MAX_IO_BUFFERS];
+} XDM_AlgBufInfo;
+
+typedef enum {
+    XDM_GETSTATUS = 0,
+    XDM_SETPARAMS = 1,
+    XDM_RESET = 2,
+    XDM_SETDEFAULT = 3,
+    XDM_FLUSH = 4,
+    XDM_GETBUFINFO = 5,
+    XDM_GETVERSION = 6,
+    XDM_GETCONTEXTINFO = 7
+} XDM_CmdId;
+
+typedef enum {
+    XDM_BYTE = 1,
+    XDM_LE_16 = 2,
+    XDM_LE_32 = 3
+} XDM_DataFormat;
+
+typedef enum {
+    XDM_CHROMA_NA = -1,
+    XDM_YUV_420P = 1,
+    XDM_YUV_422P = 2,
+    XDM_YUV_422IBE = 3,
+    XDM_YUV_422ILE = 4,
+    XDM_YUV_444P = 5,
+    XDM_YUV_411P = 6,
+    XDM_GRAY = 7,
+    XDM_RGB = 8,
+    XDM_YUV_420SP = 9
+} XDM_ChromaFormat;
+
+typedef enum {
+    XDM_DEFAULT = 0,
+    XDM_HIGH_QUALITY = 1,
+    XDM_HIGH_SPEED = 2,
+    XDM_USER_DEFINED = 3
+} XDM_EncodingPreset;
+
+typedef enum {
+    XDM_DECODE_AU = 0,
+    XDM_PARSE_HEADER = 1
+} XDM_DecMode;
+
+typedef enum {
+    XDM_ENCODE_AU = 0,
+    XDM_GENERATE_HEADER = 1
+} XDM_EncMode;
+
+#endif /* DM365STUB_TI_XDAIS_DM_XDM_H */
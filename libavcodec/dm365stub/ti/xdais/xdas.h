@@ -0,0 +1,37 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef DM365STUB_TI_XDAIS_XDAS_H
+#define DM365STUB_TI_XDAIS_XDAS_H
+
+typedef void            XDAS_Void;
+typedef unsigned char   XDAS_Bool;
+typedef char            XDAS_Int8;
+typedef unsigned char   XDAS_UInt8;
+typedef short           XDAS_Int16;
+typedef unsigned short  XDAS_UInt16;
+typedef int             XDAS_Int32;
+typedef unsigned int    XDAS_UInt32;
+
+#define XDAS_TRUE       1
+#define XDAS_FALSE      0
+
+#endif /* DM365STUB_TI_XDAIS_XDAS_H */
@@ -0,0 +1,57 @@
+/*
+ * Software stand-in for the TI DVSDK headers used by libdm365
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * The headers below dm365stub/ mirror the subset of the XDC, XDAIS,
+ * Codec Engine and CMEM interfaces used by libdm365*.c. They are only
+ * put on the include path by configure --enable-libdm365-stub, which
+ * links the software implementation in dm365stub.c instead of the
+ * DVSDK libraries.
+ */
+
+#ifndef DM365STUB_XDC_STD_H
+#define DM365STUB_XDC_STD_H
+
+#include <stddef.h>
+
+typedef void            Void;
+typedef char            Char;
+typedef unsigned char   UChar;
+typedef short           Short;
+typedef unsigned short  UShort;
+typedef int             Int;
+typedef unsigned int    UInt;
+typedef long            Long;
+typedef unsigned long   ULong;
+typedef int             Int32;
+typedef unsigned int    Uns;
+typedef unsigned int    UInt32;
+typedef unsigned short  Bool;
+typedef char           *String;
+typedef void           *Ptr;
+
+#ifndef TRUE
+#define TRUE  ((Bool) 1)
+#define FALSE ((Bool) 0)
+#endif
+
+#endif /* DM365STUB_XDC_STD_H */
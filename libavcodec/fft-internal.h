@@ -34,6 +34,31 @@
         (dim) = (are) * (bim) + (aim) * (bre);  \
     } while (0)
 
+#elif CONFIG_FFT_FIXED_32
+
+#include "libavutil/common.h"
+
+/* The tables are Q31 in this build. */
+#define FIX15(a) av_clipl_int32(llrint((a) * 2147483648.0))
+
+#define sqrthalf 1518500250 // Q31 of M_SQRT1_2
+
+/* No scaling in the butterflies, the caller has to leave enough headroom. */
+#define BF(x, y, a, b) do {                     \
+        x = (a) - (b);                          \
+        y = (a) + (b);                          \
+    } while (0)
+
+#define CMUL(dre, dim, are, aim, bre, bim) do {                         \
+        int64_t accu;                                                   \
+        accu  = (int64_t)(bre) * (are);                                 \
+        accu -= (int64_t)(bim) * (aim);                                 \
+        (dre) = (int)((accu + 0x40000000) >> 31);                       \
+        accu  = (int64_t)(bre) * (aim);                                 \
+        accu += (int64_t)(bim) * (are);                                 \
+        (dim) = (int)((accu + 0x40000000) >> 31);                       \
+    } while (0)
+
 #else
 
 #include "libavutil/intmath.h"
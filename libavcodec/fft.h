@@ -26,6 +26,10 @@
 #define CONFIG_FFT_FLOAT 1
 #endif
 
+#ifndef CONFIG_FFT_FIXED_32
+#define CONFIG_FFT_FIXED_32 0
+#endif
+
 #include <stdint.h>
 #include "config.h"
 #include "libavutil/mem.h"
@@ -38,6 +42,19 @@
 
 typedef float FFTDouble;
 
+#elif CONFIG_FFT_FIXED_32
+
+#define FFT_NAME(x) x ## _fixed_32
+
+typedef int32_t FFTSample;
+typedef int     FFTDouble;
+
+typedef struct FFTComplex {
+    int32_t re, im;
+} FFTComplex;
+
+typedef struct FFTContext FFTContext;
+
 #else
 
 #define FFT_NAME(x) x ## _fixed
@@ -137,7 +154,7 @@ int ff_fft_init(FFTContext *s, int nbits, int inverse);
 void ff_fft_init_altivec(FFTContext *s);
 void ff_fft_init_mmx(FFTContext *s);
 void ff_fft_init_arm(FFTContext *s);
-#else
+#elif !CONFIG_FFT_FIXED_32
 void ff_fft_fixed_init_arm(FFTContext *s);
 #endif
 
@@ -1858,7 +1858,7 @@ AVCodec ff_ffv1_encoder = {
     encode_init,
     encode_frame,
     common_end,
-    .capabilities = CODEC_CAP_SLICE_THREADS,
+    .capabilities = CODEC_CAP_SLICE_THREADS | CODEC_CAP_FRAME_THREADS,
     .pix_fmts= (const enum PixelFormat[]){PIX_FMT_YUV420P, PIX_FMT_YUV444P, PIX_FMT_YUV422P, PIX_FMT_YUV411P, PIX_FMT_YUV410P, PIX_FMT_RGB32, PIX_FMT_YUV420P16, PIX_FMT_YUV422P16, PIX_FMT_YUV444P16, PIX_FMT_YUV420P9, PIX_FMT_YUV420P10, PIX_FMT_YUV422P10, PIX_FMT_NONE},
     .long_name= NULL_IF_CONFIG_SMALL("FFmpeg video codec #1"),
 };
@@ -438,13 +438,16 @@ retry:
     if (ret < 0){
         av_log(s->avctx, AV_LOG_ERROR, "header damaged\n");
         return -1;
-    } else if ((s->width  != avctx->coded_width  ||
+    } else if (avctx->coded_width && avctx->coded_height &&
+               (s->width  != avctx->coded_width  ||
                 s->height != avctx->coded_height ||
                 (s->width  + 15) >> 4 != s->mb_width ||
                 (s->height + 15) >> 4 != s->mb_height) &&
-               (HAVE_THREADS && (s->avctx->active_thread_type & FF_THREAD_FRAME))) {
-        av_log_missing_feature(s->avctx, "Width/height/bit depth/chroma idc changing with threads is", 0);
-        return AVERROR_PATCHWELCOME;   // width / height changed during parallelized decoding
+               (HAVE_PTHREADS && (s->avctx->active_thread_type & FF_THREAD_FRAME))) {
+        // the other threads still decode the size of the previous picture, reopen all of them
+        avcodec_set_dimensions(avctx, s->width, s->height);
+        ff_thread_request_reinit(avctx);
+        return AVERROR(EAGAIN);
     }
 
     avctx->has_b_frames= !s->low_delay;
@@ -584,13 +587,9 @@ retry:
     if (   s->width  != avctx->coded_width
         || s->height != avctx->coded_height) {
         /* H.263 could change picture size any time */
+        /* with frame threads this is the first picture, no other thread has a size yet */
         ParseContext pc= s->parse_context; //FIXME move these demuxng hack to avformat
 
-        if (HAVE_THREADS && (s->avctx->active_thread_type&FF_THREAD_FRAME)) {
-            av_log_missing_feature(s->avctx, "Width/height/bit depth/chroma idc changing with threads is", 0);
-            return -1;   // width / height changed during parallelized decoding
-        }
-
         s->parse_context.buffer=0;
         MPV_common_end(s);
         s->parse_context= pc;
@@ -997,6 +997,7 @@ fail:
 }
 
 static int decode_nal_units(H264Context *h, const uint8_t *buf, int buf_size);
+static void init_scan_tables(H264Context *h);
 
 static av_cold void common_init(H264Context *h){
     MpegEncContext * const s = &h->s;
@@ -1162,6 +1163,39 @@ static int decode_init_thread_copy(AVCodecContext *avctx){
 }
 
 #define copy_fields(to, from, start_field, end_field) memcpy(&to->start_field, &from->start_field, (char*)&to->end_field - (char*)&to->start_field)
+/**
+ * Init the slice contexts, or only the master context
+ * if slices are not decoded in parallel.
+ */
+static int thread_contexts_init(H264Context *h){
+    MpegEncContext * const s = &h->s;
+    int i;
+
+    if (!HAVE_THREADS || !(s->avctx->active_thread_type&FF_THREAD_SLICE))
+        return context_init(h);
+
+    for(i = 1; i < s->avctx->thread_count; i++) {
+        H264Context *c;
+        c = h->thread_context[i] = av_malloc(sizeof(H264Context));
+        if (!c)
+            return -1;
+        memcpy(c, h->s.thread_context[i], sizeof(MpegEncContext));
+        memset(&c->s + 1, 0, sizeof(H264Context) - sizeof(MpegEncContext));
+        c->h264dsp = h->h264dsp;
+        c->sps = h->sps;
+        c->pps = h->pps;
+        c->pixel_shift = h->pixel_shift;
+        init_scan_tables(c);
+        clone_tables(c, h, i);
+    }
+
+    for(i = 0; i < s->avctx->thread_count; i++)
+        if (context_init(h->thread_context[i]) < 0)
+            return -1;
+
+    return 0;
+}
+
 static int decode_update_thread_context(AVCodecContext *dst, const AVCodecContext *src){
     H264Context *h= dst->priv_data, *h1= src->priv_data;
     MpegEncContext * const s = &h->s, * const s1 = &h1->s;
@@ -1188,18 +1222,25 @@ static int decode_update_thread_context(AVCodecContext *dst, const AVCodecContex
             av_log(dst, AV_LOG_ERROR, "Could not allocate memory for h264\n");
             return AVERROR(ENOMEM);
         }
-        context_init(h);
 
         for(i=0; i<2; i++){
             h->rbsp_buffer[i] = NULL;
             h->rbsp_buffer_size[i] = 0;
         }
 
+        // the slice contexts of the source thread are its own
+        memset(h->thread_context, 0, sizeof(h->thread_context));
         h->thread_context[0] = h;
+        if (thread_contexts_init(h) < 0) {
+            av_log(dst, AV_LOG_ERROR, "context_init() failed.\n");
+            return AVERROR(ENOMEM);
+        }
 
         // frame_start may not be called for the next thread (if it's decoding a bottom field)
         // so this has to be allocated here
-        h->s.obmc_scratchpad = av_malloc(16*6*s->linesize);
+        for(i = 0; i < MAX_THREADS; i++)
+            if (h->thread_context[i])
+                h->thread_context[i]->s.obmc_scratchpad = av_malloc(16*6*s->linesize);
 
         s->dsp.clear_blocks(h->mb);
         s->dsp.clear_blocks(h->mb+(24*16<<h->pixel_shift));
@@ -2620,10 +2661,15 @@ static int decode_slice_header(H264Context *h, H264Context *h0){
     if (s->context_initialized
         && (   s->width != s->avctx->width || s->height != s->avctx->height
             || av_cmp_q(h->sps.sar, s->avctx->sample_aspect_ratio))) {
-        if(h != h0 || (HAVE_THREADS && h->s.avctx->active_thread_type & FF_THREAD_FRAME)) {
+        if(h != h0) {
             av_log_missing_feature(s->avctx, "Width/height changing with threads is", 0);
             return AVERROR_PATCHWELCOME;   // width / height changed during parallelized decoding
         }
+        if (HAVE_PTHREADS && h->s.avctx->active_thread_type & FF_THREAD_FRAME) {
+            // the other threads still decode the old size, reopen all of them
+            ff_thread_request_reinit(s->avctx);
+            return AVERROR(EAGAIN);
+        }
         free_tables(h, 0);
         flush_dpb(s->avctx);
         MPV_common_end(s);
@@ -2694,30 +2740,9 @@ static int decode_slice_header(H264Context *h, H264Context *h0){
             return AVERROR(ENOMEM);
         }
 
-        if (!HAVE_THREADS || !(s->avctx->active_thread_type&FF_THREAD_SLICE)) {
-            if (context_init(h) < 0) {
-                av_log(h->s.avctx, AV_LOG_ERROR, "context_init() failed.\n");
-                return -1;
-            }
-        } else {
-            for(i = 1; i < s->avctx->thread_count; i++) {
-                H264Context *c;
-                c = h->thread_context[i] = av_malloc(sizeof(H264Context));
-                memcpy(c, h->s.thread_context[i], sizeof(MpegEncContext));
-                memset(&c->s + 1, 0, sizeof(H264Context) - sizeof(MpegEncContext));
-                c->h264dsp = h->h264dsp;
-                c->sps = h->sps;
-                c->pps = h->pps;
-                c->pixel_shift = h->pixel_shift;
-                init_scan_tables(c);
-                clone_tables(c, h, i);
-            }
-
-            for(i = 0; i < s->avctx->thread_count; i++)
-                if (context_init(h->thread_context[i]) < 0) {
-                    av_log(h->s.avctx, AV_LOG_ERROR, "context_init() failed.\n");
-                    return -1;
-                }
+        if (thread_contexts_init(h) < 0) {
+            av_log(h->s.avctx, AV_LOG_ERROR, "context_init() failed.\n");
+            return -1;
         }
     }
 
@@ -3428,12 +3453,26 @@ static void decode_finish_row(H264Context *h){
 
     ff_draw_horiz_band(s, top, height);
 
-    if (s->dropable) return;
+    if (s->dropable || h->defer_progress) return;
 
     ff_thread_report_progress((AVFrame*)s->current_picture_ptr, top + height - 1,
                              s->picture_structure==PICT_BOTTOM_FIELD);
 }
 
+/**
+ * Reports the rows above the end of the last slice decoded in parallel,
+ * less the ones the deblocking filter may still change.
+ */
+static void report_slices_progress(H264Context *h){
+    MpegEncContext * const s = &h->s;
+    int top = 16*(s->mb_y >> FIELD_PICTURE) - ((16 + 4) << FRAME_MBAFF);
+
+    if (s->dropable || top <= 0) return;
+
+    ff_thread_report_progress((AVFrame*)s->current_picture_ptr, top - 1,
+                             s->picture_structure==PICT_BOTTOM_FIELD);
+}
+
 static int decode_slice(struct AVCodecContext *avctx, void *arg){
     H264Context *h = *(void**)arg;
     MpegEncContext * const s = &h->s;
@@ -3635,16 +3674,22 @@ static void execute_decode_slices(H264Context *h, int context_count){
     if(context_count == 1) {
         decode_slice(avctx, &h);
     } else {
+        int defer_progress = HAVE_THREADS && (avctx->active_thread_type & FF_THREAD_FRAME);
+
         for(i = 1; i < context_count; i++) {
             hx = h->thread_context[i];
             hx->s.error_recognition = avctx->error_recognition;
             hx->s.error_count = 0;
             hx->x264_build= h->x264_build;
+            hx->defer_progress = defer_progress;
         }
+        h->defer_progress = defer_progress;
 
         avctx->execute(avctx, (void *)decode_slice,
                        h->thread_context, NULL, context_count, sizeof(void*));
 
+        h->defer_progress = 0;
+
         /* pull back stuff from slices to master context */
         hx = h->thread_context[context_count - 1];
         s->mb_x = hx->s.mb_x;
@@ -3653,6 +3698,9 @@ static void execute_decode_slices(H264Context *h, int context_count){
         s->picture_structure = hx->s.picture_structure;
         for(i = 1; i < context_count; i++)
             h->s.error_count += h->thread_context[i]->s.error_count;
+
+        if (defer_progress)
+            report_slices_progress(h);
     }
 }
 
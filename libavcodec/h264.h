@@ -533,6 +533,12 @@ typedef struct H264Context{
      */
     int single_decode_warning;
 
+    /**
+     * Set while slices are decoded in parallel by frame threads. They
+     * finish out of order, so progress is reported once all are done.
+     */
+    int defer_progress;
+
     int last_slice_type;
     /** @} */
 
@@ -0,0 +1,301 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * H.264 DSP test.
+ *
+ * The 8-bit IDCT, loop filter and chroma MC functions selected by
+ * ff_h264dsp_init() and dsputil_init() for this CPU are checked against
+ * the C versions on random input. On ARM this covers the ARMv5TE and NEON
+ * assembly.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "config.h"
+#include "libavutil/lfg.h"
+#include "avcodec.h"
+#include "dsputil.h"
+#include "h264dsp.h"
+
+/* the C functions of h264dsp.c, without the architecture specific init */
+#undef  ARCH_ARM
+#define ARCH_ARM     0
+#undef  HAVE_ALTIVEC
+#define HAVE_ALTIVEC 0
+#undef  HAVE_MMX
+#define HAVE_MMX     0
+#define ff_h264dsp_init h264dsp_init_c
+void ff_h264dsp_init(H264DSPContext *c, const int bit_depth);
+#include "h264dsp.c"
+#undef  ff_h264dsp_init
+
+#undef printf
+
+#define STRIDE   32
+#define NB_ITS 2000
+
+static AVLFG prng;
+static int failed;
+
+static const uint8_t scan8[16 * 3] = {
+    4 +  1 * 8, 5 +  1 * 8, 4 +  2 * 8, 5 +  2 * 8,
+    6 +  1 * 8, 7 +  1 * 8, 6 +  2 * 8, 7 +  2 * 8,
+    4 +  3 * 8, 5 +  3 * 8, 4 +  4 * 8, 5 +  4 * 8,
+    6 +  3 * 8, 7 +  3 * 8, 6 +  4 * 8, 7 +  4 * 8,
+    4 +  6 * 8, 5 +  6 * 8, 4 +  7 * 8, 5 +  7 * 8,
+    6 +  6 * 8, 7 +  6 * 8, 6 +  7 * 8, 7 +  7 * 8,
+    4 +  8 * 8, 5 +  8 * 8, 4 +  9 * 8, 5 +  9 * 8,
+    6 +  8 * 8, 7 +  8 * 8, 6 +  9 * 8, 7 +  9 * 8,
+    4 + 11 * 8, 5 + 11 * 8, 4 + 12 * 8, 5 + 12 * 8,
+    6 + 11 * 8, 7 + 11 * 8, 6 + 12 * 8, 7 + 12 * 8,
+    4 + 13 * 8, 5 + 13 * 8, 4 + 14 * 8, 5 + 14 * 8,
+    6 + 13 * 8, 7 + 13 * 8, 6 + 14 * 8, 7 + 14 * 8,
+};
+
+static int rnd(int n)
+{
+    return av_lfg_get(&prng) % n;
+}
+
+static void fill_random(uint8_t *buf, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+        buf[i] = av_lfg_get(&prng);
+}
+
+static int compare(const char *name, int it, const uint8_t *a, const uint8_t *b, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++) {
+        if (a[i] != b[i]) {
+            printf("%s: iteration %d: byte %d is %d instead of %d\n",
+                   name, it, i, a[i], b[i]);
+            failed++;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Fill a block of 16 (4x4) or 64 (8x8) coefficients and set its number
+ * of nonzero coefficients like the decoder does: 0 for a block with at
+ * most a DC value, 1 for a single coefficient.
+ */
+static void fill_block(DCTELEM *block, uint8_t *nnz, int size, int intra)
+{
+    int i;
+
+    memset(block, 0, size * sizeof(*block));
+    *nnz = 0;
+    switch (rnd(4)) {
+    case 0:
+        if (intra)
+            block[0] = rnd(2048) - 1024;
+        break;
+    case 1:
+        block[rnd(size)] = rnd(1024) - 512;
+        *nnz = 1;
+        break;
+    default:
+        for (i = 0; i < size; i++)
+            if (!rnd(3))
+                block[i] = rnd(512) - 256;
+        *nnz = size;
+        break;
+    }
+}
+
+static void test_idct(H264DSPContext *h, H264DSPContext *c)
+{
+    DECLARE_ALIGNED(16, uint8_t,  dst0)[16 * STRIDE];
+    DECLARE_ALIGNED(16, uint8_t,  dst1)[16 * STRIDE];
+    DECLARE_ALIGNED(16, DCTELEM, block0)[48 * 16];
+    DECLARE_ALIGNED(16, DCTELEM, block1)[48 * 16];
+    uint8_t nnzc[15 * 8];
+    int block_offset[48];
+    uint8_t *dst, *dest[2];
+    DCTELEM *block;
+    int i, it;
+
+    /* the chroma blocks 16 to 19 and 32 to 35 use the 4x4 luma layout */
+    for (i = 0; i < 48; i++)
+        block_offset[i] = 4 * ((scan8[i % 16] - scan8[0]) & 7) +
+                          4 * STRIDE * ((scan8[i % 16] - scan8[0]) >> 3);
+
+/* blocks first to last-1 with the given step, the arguments refer to
+ * dst, dest and block, which point to each copy in turn; intra blocks
+ * are also passed to the functions that have to skip a DC with nnz 0 */
+#define IDCT(func, first, last, step, intra, ...)                      \
+    for (it = 0; it < NB_ITS; it++) {                                   \
+        memset(nnzc, 0, sizeof(nnzc));                                  \
+        memset(block0, 0, sizeof(block0));                              \
+        for (i = first; i < last; i += step) {                          \
+            if (step == 1 && i >= 20 && i < 32)                         \
+                continue;                                               \
+            fill_block(block0 + 16 * i, &nnzc[scan8[i]], 16 * step, intra); \
+        }                                                               \
+        memcpy(block1, block0, sizeof(block0));                         \
+        fill_random(dst0, sizeof(dst0));                                \
+        memcpy(dst1, dst0, sizeof(dst0));                               \
+        dst = dst0; dest[0] = dst0; dest[1] = dst0 + 8; block = block0; \
+        h->func(__VA_ARGS__);                                           \
+        dst = dst1; dest[0] = dst1; dest[1] = dst1 + 8; block = block1; \
+        c->func(__VA_ARGS__);                                           \
+        if (compare(#func, it, dst0, dst1, sizeof(dst0)) < 0)           \
+            break;                                                      \
+    }                                                                   \
+    printf("%s\n", #func);
+
+    IDCT(h264_idct_add,        0,  1, 1, 0, dst, block, STRIDE);
+    IDCT(h264_idct8_add,       0,  4, 4, 0, dst, block, STRIDE);
+    IDCT(h264_idct_dc_add,     0,  1, 1, 1, dst, block, STRIDE);
+    IDCT(h264_idct8_dc_add,    0,  4, 4, 1, dst, block, STRIDE);
+    IDCT(h264_idct_add16,      0, 16, 1, 1, dst, block_offset, block, STRIDE, nnzc);
+    IDCT(h264_idct_add16intra, 0, 16, 1, 1, dst, block_offset, block, STRIDE, nnzc);
+    IDCT(h264_idct8_add4,      0, 16, 4, 1, dst, block_offset, block, STRIDE, nnzc);
+    IDCT(h264_idct_add8,      16, 36, 1, 1, dest, block_offset, block, STRIDE, nnzc);
+}
+
+/**
+ * Fill the area around an edge with small random steps, so that the
+ * filter conditions are met in some places and not in others.
+ */
+static void fill_edge(uint8_t *buf, int size, int alpha, int beta)
+{
+    int i, base = rnd(256), step = rnd(alpha + 8) - alpha / 2 - 4;
+
+    for (i = 0; i < size; i++) {
+        int v = base + rnd(beta + 4) - beta / 2 - 2;
+
+        if ((i % STRIDE >= 16) != (i / STRIDE >= 16) && rnd(2))
+            v += step;
+        buf[i] = av_clip_uint8(v);
+    }
+}
+
+static void test_loop_filter(H264DSPContext *h, H264DSPContext *c)
+{
+    DECLARE_ALIGNED(16, uint8_t, buf0)[32 * STRIDE];
+    DECLARE_ALIGNED(16, uint8_t, buf1)[32 * STRIDE];
+    uint8_t * const pix0 = buf0 + 16 * STRIDE + 16;
+    uint8_t * const pix1 = buf1 + 16 * STRIDE + 16;
+    int8_t tc0[4];
+    int i, it;
+
+#define LOOP_FILTER(func)                                               \
+    for (it = 0; it < NB_ITS; it++) {                                   \
+        int alpha = 1 + rnd(255), beta = 1 + rnd(18);                   \
+        for (i = 0; i < 4; i++)                                         \
+            tc0[i] = rnd(27) - 1;                                       \
+        fill_edge(buf0, sizeof(buf0), alpha, beta);                     \
+        memcpy(buf1, buf0, sizeof(buf0));                               \
+        h->func(pix0, STRIDE, alpha, beta, tc0);                        \
+        c->func(pix1, STRIDE, alpha, beta, tc0);                        \
+        if (compare(#func, it, buf0, buf1, sizeof(buf0)) < 0)           \
+            break;                                                      \
+    }                                                                   \
+    printf("%s\n", #func);
+
+    LOOP_FILTER(h264_v_loop_filter_luma);
+    LOOP_FILTER(h264_h_loop_filter_luma);
+    LOOP_FILTER(h264_v_loop_filter_chroma);
+    LOOP_FILTER(h264_h_loop_filter_chroma);
+}
+
+static void chroma_mc_ref(uint8_t *dst, const uint8_t *src, int stride,
+                          int w, int h, int x, int y, int avg)
+{
+    const int A = (8 - x) * (8 - y), B = x * (8 - y);
+    const int C = (8 - x) * y,       D = x * y;
+    int i, j;
+
+    for (j = 0; j < h; j++) {
+        for (i = 0; i < w; i++) {
+            int v = (A * src[i]          + B * src[i + 1] +
+                     C * src[i + stride] + D * src[i + stride + 1] + 32) >> 6;
+            dst[i] = avg ? (dst[i] + v + 1) >> 1 : v;
+        }
+        dst += stride;
+        src += stride;
+    }
+}
+
+static void test_chroma_mc(DSPContext *dsp)
+{
+    DECLARE_ALIGNED(16, uint8_t, src)[16 * STRIDE];
+    DECLARE_ALIGNED(16, uint8_t, dst0)[16 * STRIDE];
+    DECLARE_ALIGNED(16, uint8_t, dst1)[16 * STRIDE];
+    int avg, size, it;
+
+    for (avg = 0; avg < 2; avg++) {
+        for (size = 0; size < 2; size++) {
+            h264_chroma_mc_func func = avg ? dsp->avg_h264_chroma_pixels_tab[size]
+                                           : dsp->put_h264_chroma_pixels_tab[size];
+            const char *name = avg ? size ? "avg_h264_chroma_mc4" : "avg_h264_chroma_mc8"
+                                   : size ? "put_h264_chroma_mc4" : "put_h264_chroma_mc8";
+
+            for (it = 0; it < NB_ITS; it++) {
+                int x = rnd(8), y = rnd(8), h = size ? 2 << rnd(3) : 4 << rnd(2);
+                int offset = rnd(8);
+
+                fill_random(src,  sizeof(src));
+                fill_random(dst0, sizeof(dst0));
+                memcpy(dst1, dst0, sizeof(dst0));
+                func(dst0, src + offset, STRIDE, h, x, y);
+                chroma_mc_ref(dst1, src + offset, STRIDE, 8 >> size, h, x, y, avg);
+                if (compare(name, it, dst0, dst1, sizeof(dst0)) < 0)
+                    break;
+            }
+            printf("%s\n", name);
+        }
+    }
+}
+
+int main(void)
+{
+    AVCodecContext *avctx;
+    H264DSPContext h, c;
+    DSPContext dsp;
+
+    /* sets up the clipping table used by the C functions */
+    avcodec_init();
+    av_lfg_init(&prng, 1);
+
+    avctx = avcodec_alloc_context3(NULL);
+    if (!avctx)
+        return 1;
+    avctx->codec_id = CODEC_ID_H264;
+    dsputil_init(&dsp, avctx);
+
+    ff_h264dsp_init(&h, 8);
+    h264dsp_init_c(&c, 8);
+    test_idct(&h, &c);
+    test_loop_filter(&h, &c);
+    test_chroma_mc(&dsp);
+    emms_c();
+    av_free(avctx);
+
+    return !!failed;
+}
@@ -0,0 +1,263 @@
+/*
+ * DM365 hardware codec support
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+* @file
+* data and functions shared by the DM365 hardware codecs
+*/
+
+#include "libavutil/avstring.h"
+#include "avcodec.h"
+#include "dm365.h"
+#include "libdm365.h"
+
+#if HAVE_PTHREADS
+#include <pthread.h>
+#endif
+
+#include <ti/sdo/linuxutils/cmem/include/cmem.h>
+
+#define MAX_ENGINES 4
+
+typedef struct DM365Engine {
+    char name[32];
+    Engine_Handle handle;
+    int users;
+} DM365Engine;
+
+static DM365Engine engines[MAX_ENGINES];
+
+/* CMEM blocks holding pictures, encoders read them in place */
+typedef struct DM365PictureBuffer {
+    const uint8_t *mem;
+    int size;
+} DM365PictureBuffer;
+
+static DM365PictureBuffer *buffers;
+static int nb_buffers;
+
+#if HAVE_PTHREADS
+static pthread_mutex_t buffer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t engine_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t engine_cond = PTHREAD_COND_INITIALIZER;
+static unsigned int engine_next_ticket;
+static unsigned int engine_serving;
+#endif
+
+static CMEM_AllocParams packet_alloc_params = {
+    .type = CMEM_HEAP,
+    .flags = CMEM_NONCACHED,
+    .alignment = 32,
+};
+
+static void dm365_destruct_packet(AVPacket *pkt)
+{
+    int i;
+
+    CMEM_free(pkt->data, &packet_alloc_params);
+    CMEM_exit();
+    pkt->data = NULL; pkt->size = 0;
+
+    for (i = 0; i < pkt->side_data_elems; i++)
+        av_free(pkt->side_data[i].data);
+    av_freep(&pkt->side_data);
+    pkt->side_data_elems = 0;
+}
+
+int av_dm365_new_packet(AVPacket *pkt, int size)
+{
+    uint8_t *data = NULL;
+
+    av_init_packet(pkt);
+    pkt->data = NULL;
+    pkt->size = 0;
+
+    if ((unsigned)size >= (unsigned)size + FF_INPUT_BUFFER_PADDING_SIZE)
+        return AVERROR(EINVAL);
+
+    /* keep the CMEM driver open as long as the packet lives */
+    CMEM_init();
+    data = CMEM_alloc(size + FF_INPUT_BUFFER_PADDING_SIZE, &packet_alloc_params);
+    if (!data) {
+        CMEM_exit();
+        return AVERROR(ENOMEM);
+    }
+    memset(data + size, 0, FF_INPUT_BUFFER_PADDING_SIZE);
+
+    pkt->data     = data;
+    pkt->size     = size;
+    pkt->destruct = dm365_destruct_packet;
+    return 0;
+}
+
+int ff_dm365_is_cmem_packet(const AVPacket *pkt)
+{
+    return pkt->destruct == dm365_destruct_packet;
+}
+
+int av_dm365_register_buffer(void *mem, int size)
+{
+    DM365PictureBuffer *tmp;
+    int ret = 0;
+
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&buffer_mutex);
+#endif
+    tmp = av_realloc(buffers, (nb_buffers + 1) * sizeof(*buffers));
+    if (tmp) {
+        buffers = tmp;
+        buffers[nb_buffers].mem  = mem;
+        buffers[nb_buffers].size = size;
+        nb_buffers++;
+    } else {
+        ret = AVERROR(ENOMEM);
+    }
+#if HAVE_PTHREADS
+    pthread_mutex_unlock(&buffer_mutex);
+#endif
+    return ret;
+}
+
+void av_dm365_unregister_buffer(void *mem)
+{
+    int i;
+
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&buffer_mutex);
+#endif
+    for (i = 0; i < nb_buffers; i++) {
+        if (buffers[i].mem == mem) {
+            buffers[i] = buffers[--nb_buffers];
+            break;
+        }
+    }
+    if (!nb_buffers)
+        av_freep(&buffers);
+#if HAVE_PTHREADS
+    pthread_mutex_unlock(&buffer_mutex);
+#endif
+}
+
+static int in_buffer(const uint8_t *ptr, int size)
+{
+    int i;
+
+    for (i = 0; i < nb_buffers; i++)
+        if (ptr >= buffers[i].mem && ptr + size <= buffers[i].mem + buffers[i].size)
+            return 1;
+    return 0;
+}
+
+int ff_dm365_is_cmem_picture(const AVFrame *pic, int height)
+{
+    int ret;
+
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&buffer_mutex);
+#endif
+    ret = in_buffer(pic->data[0], pic->linesize[0] * height) &&
+          in_buffer(pic->data[1], pic->linesize[1] * height / 2);
+#if HAVE_PTHREADS
+    pthread_mutex_unlock(&buffer_mutex);
+#endif
+    return ret;
+}
+
+Engine_Handle ff_dm365_engine_open(AVCodecContext *avctx, const char *name)
+{
+    DM365Engine *e = NULL;
+    int i;
+
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&engine_mutex);
+#endif
+    for (i = 0; i < MAX_ENGINES; i++) {
+        if (engines[i].users && !strcmp(engines[i].name, name)) {
+            e = &engines[i];
+            break;
+        }
+        if (!engines[i].users && !e)
+            e = &engines[i];
+    }
+
+    if (e && !e->users) {
+        /* first user, the engine is opened only once per process */
+        av_strlcpy(e->name, name, sizeof(e->name));
+        e->handle = Engine_open(e->name, NULL, NULL);
+        if (!e->handle)
+            e = NULL;
+    }
+    if (e)
+        e->users++;
+#if HAVE_PTHREADS
+    pthread_mutex_unlock(&engine_mutex);
+#endif
+
+    if (!e) {
+        av_log(avctx, AV_LOG_ERROR, "Cannot open codec engine %s.\n", name);
+        return NULL;
+    }
+    return e->handle;
+}
+
+void ff_dm365_engine_close(Engine_Handle handle)
+{
+    int i;
+
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&engine_mutex);
+#endif
+    for (i = 0; i < MAX_ENGINES; i++) {
+        if (engines[i].users && engines[i].handle == handle) {
+            if (!--engines[i].users) {
+                Engine_close(handle);
+                engines[i].handle = NULL;
+            }
+            break;
+        }
+    }
+#if HAVE_PTHREADS
+    pthread_mutex_unlock(&engine_mutex);
+#endif
+}
+
+void ff_dm365_engine_lock(void)
+{
+#if HAVE_PTHREADS
+    unsigned int ticket;
+
+    pthread_mutex_lock(&engine_mutex);
+    ticket = engine_next_ticket++;
+    while (ticket != engine_serving)
+        pthread_cond_wait(&engine_cond, &engine_mutex);
+    pthread_mutex_unlock(&engine_mutex);
+#endif
+}
+
+void ff_dm365_engine_unlock(void)
+{
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&engine_mutex);
+    engine_serving++;
+    pthread_cond_broadcast(&engine_cond);
+    pthread_mutex_unlock(&engine_mutex);
+#endif
+}
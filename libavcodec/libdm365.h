@@ -0,0 +1,83 @@
+/*
+ * DM365 hardware codec support
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+* @file
+* data and functions shared by the DM365 hardware codecs
+*/
+
+#ifndef AVCODEC_LIBDM365_H
+#define AVCODEC_LIBDM365_H
+
+#include "avcodec.h"
+
+#include <xdc/std.h>
+#include <ti/sdo/ce/Engine.h>
+
+/**
+ * Return nonzero if the packet payload was allocated by
+ * av_dm365_new_packet() and can be handed to the coprocessor directly.
+ */
+int ff_dm365_is_cmem_packet(const AVPacket *pkt);
+
+/**
+ * Return nonzero if both planes of the NV12 picture lie in buffers
+ * registered with av_dm365_register_buffer(), so that it can be handed to
+ * the coprocessor directly.
+ */
+int ff_dm365_is_cmem_picture(const AVFrame *pic, int height);
+
+/**
+ * Open the codec engine with the given name.
+ *
+ * The engine is opened once per process and shared by all libdm365 codec
+ * instances, it is closed when the last of them calls
+ * ff_dm365_engine_close().
+ *
+ * @return engine handle, NULL on failure
+ */
+Engine_Handle ff_dm365_engine_open(AVCodecContext *avctx, const char *name);
+
+void ff_dm365_engine_close(Engine_Handle engine);
+
+/**
+ * Enter the section of the calling thread on the coprocessor.
+ *
+ * Every call into a shared engine (create, control, process, delete) has
+ * to be made between ff_dm365_engine_lock() and ff_dm365_engine_unlock().
+ * Waiting threads are served in the order they arrived, so a codec
+ * instance waits for at most one call of each other instance and
+ * concurrent streams share the coprocessor evenly.
+ */
+void ff_dm365_engine_lock(void);
+
+void ff_dm365_engine_unlock(void);
+
+/**
+ * Pass a codec name to the *_create() calls of the Codec Engine, which
+ * take it as a String (char *) although they never write to it.
+ */
+static inline String ff_dm365_codec_name(const char *name)
+{
+    return (String)(uintptr_t) name;
+}
+
+#endif /* AVCODEC_LIBDM365_H */
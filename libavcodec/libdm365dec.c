@@ -26,14 +26,20 @@
 
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/imgutils.h"
 #include "avcodec.h"
 #include "internal.h"
+#include "libdm365.h"
+#include "dm365.h"
 
 #include <xdc/std.h>
 #include <ti/sdo/ce/CERuntime.h>
 #include <ti/sdo/ce/Engine.h>
 #include <ti/sdo/ce/video2/viddec2.h>
+#include <ti/sdo/ce/image1/imgdec1.h>
 #include <ti/sdo/codecs/h264dec/ih264vdec.h>
+#include <ti/sdo/codecs/mpeg4dec/imp4vdec.h>
+#include <ti/sdo/codecs/jpegdec/ijpegdec.h>
 #include <ti/sdo/linuxutils/cmem/include/cmem.h>
 
 static CMEM_AllocParams alloc_params = {
@@ -42,17 +48,75 @@ static CMEM_AllocParams alloc_params = {
     .alignment = 32,
 };
 
+#define MAX_FRAMES IVIDEO2_MAX_IO_BUFFERS
+
+/**
+ * picture handed to the codec, its index + 1 is used as inputID
+ */
+typedef struct DM365Frame {
+    AVFrame pic;                /* obtained from avctx->get_buffer() */
+    IVIDEO1_BufDesc disp;       /* display geometry reported by the codec */
+    int in_codec;               /* locked by the codec until it is in freeBufID */
+    int queued;                 /* waiting to be returned for display */
+} DM365Frame;
+
+/**
+ * CMEM block of the default get_buffer() pool
+ */
+typedef struct DM365Buffer {
+    void *mem;
+    int size;
+    int used;
+} DM365Buffer;
+
 typedef struct DM365Context {
+    AVClass *class;
     Engine_Handle hEngine;
     VIDDEC2_Handle hDecode;
+    IMGDEC1_Handle hImgDecode;  /* JPEG, used instead of hDecode */
+    int display_width;          /* pitch of the last XDM_SETPARAMS of hImgDecode */
+    int max_width;              /* user limits for the codec instance */
+    int max_height;
+    int codec_width;            /* picture size the codec instance was created for */
+    int codec_height;
     void *codecParams;
     void *codecDynParams;
     void *in_buf;
-    void *out_buf;
+    int in_buf_size;
     XDAS_Int32 minNumOutBufs;
     XDAS_Int32 minOutBufSize[4];
+    int out_buf_size;
+    DM365Frame frames[MAX_FRAMES];
+    int display_queue[MAX_FRAMES];
+    int nb_queued;
+    DM365Buffer pool[MAX_FRAMES];
+    int nb_buffers;
+    int flushing;
+    int zerocopy;
 } DM365Context;
 
+#define OFFSET(x) offsetof(DM365Context, x)
+#define VD AV_OPT_FLAG_VIDEO_PARAM | AV_OPT_FLAG_DECODING_PARAM
+static const AVOption options[] = {
+    { "zerocopy", "pass packets allocated by av_dm365_new_packet() to the codec without copying",
+      OFFSET(zerocopy), FF_OPT_TYPE_INT, {.dbl = 1}, 0, 1, VD },
+    { "output_buffers", "number of pictures in the CMEM pool of av_dm365_default_get_buffer()",
+      OFFSET(nb_buffers), FF_OPT_TYPE_INT, {.dbl = 8}, 2, MAX_FRAMES, VD },
+    { "max_width", "create the codec for pictures up to this width, "
+      "so that resolution changes within it keep the codec instance",
+      OFFSET(max_width), FF_OPT_TYPE_INT, {.dbl = 0}, 0, 4096, VD },
+    { "max_height", "create the codec for pictures up to this height",
+      OFFSET(max_height), FF_OPT_TYPE_INT, {.dbl = 0}, 0, 4096, VD },
+    { NULL },
+};
+
+static const AVClass dm365_dec_class = {
+    .class_name = "libdm365 decoder",
+    .item_name  = av_default_item_name,
+    .option     = options,
+    .version    = LIBAVUTIL_VERSION_INT,
+};
+
 static const VIDDEC2_Params Vdec2_Params_DEFAULT = {
     sizeof(VIDDEC2_Params),             /* size */
     576,                                /* maxHeight */
@@ -73,8 +137,193 @@ static const VIDDEC2_DynamicParams Vdec2_DynamicParams_DEFAULT = {
     0,                                  /* mbDataFlag */
 };
 
+static DM365Context *dm365_context(AVCodecContext *avctx)
+{
+    if (!avctx->codec || avctx->codec->priv_class != &dm365_dec_class)
+        return NULL;
+    return avctx->priv_data;
+}
+
+int av_dm365_default_get_buffer(AVCodecContext *avctx, AVFrame *pic)
+{
+    DM365Context *ctx = dm365_context(avctx);
+    DM365Buffer *buf = NULL;
+    int i;
+
+    if (!ctx) {
+        av_log(avctx, AV_LOG_ERROR, "not a libdm365 decoder\n");
+        return AVERROR(EINVAL);
+    }
+
+    for (i = 0; i < ctx->nb_buffers; i++) {
+        if (!ctx->pool[i].used) {
+            buf = &ctx->pool[i];
+            break;
+        }
+    }
+    if (!buf) {
+        av_log(avctx, AV_LOG_ERROR, "all %d output buffers are in use\n",
+               ctx->nb_buffers);
+        return AVERROR(ENOMEM);
+    }
+
+    /* blocks allocated before the codec was resized are too small */
+    if (buf->mem && buf->size < ctx->out_buf_size) {
+        av_dm365_unregister_buffer(buf->mem);
+        CMEM_free(buf->mem, &alloc_params);
+        buf->mem = NULL;
+    }
+    if (!buf->mem) {
+        buf->mem = CMEM_alloc(ctx->out_buf_size, &alloc_params);
+        if (!buf->mem)
+            return AVERROR(ENOMEM);
+        /* let the libdm365 encoders read the pictures in place */
+        if (av_dm365_register_buffer(buf->mem, ctx->out_buf_size) < 0) {
+            CMEM_free(buf->mem, &alloc_params);
+            buf->mem = NULL;
+            return AVERROR(ENOMEM);
+        }
+        buf->size = ctx->out_buf_size;
+    }
+    buf->used = 1;
+
+    /* the codec reports the real picture geometry on display */
+    memset(pic->data, 0, sizeof(pic->data));
+    memset(pic->base, 0, sizeof(pic->base));
+    pic->data[0] = pic->base[0] = buf->mem;
+    pic->data[1] = pic->base[1] = pic->data[0] + ctx->minOutBufSize[0];
+    pic->linesize[0] = FFALIGN(ctx->codec_width, 32);
+    pic->linesize[1] = pic->linesize[0];
+    pic->linesize[2] = 0;
+    pic->linesize[3] = 0;
+    pic->type = FF_BUFFER_TYPE_USER;
+    pic->age  = 256*256*256*64;
+
+    if (avctx->pkt) {
+        pic->pkt_pts = avctx->pkt->pts;
+        pic->pkt_pos = avctx->pkt->pos;
+    } else {
+        pic->pkt_pts = AV_NOPTS_VALUE;
+        pic->pkt_pos = -1;
+    }
+    pic->reordered_opaque    = avctx->reordered_opaque;
+    pic->sample_aspect_ratio = avctx->sample_aspect_ratio;
+    pic->width               = avctx->width;
+    pic->height              = avctx->height;
+    pic->format              = avctx->pix_fmt;
+
+    return 0;
+}
+
+void av_dm365_default_release_buffer(AVCodecContext *avctx, AVFrame *pic)
+{
+    DM365Context *ctx = dm365_context(avctx);
+    int i;
+
+    if (!ctx)
+        return;
+
+    for (i = 0; i < ctx->nb_buffers; i++) {
+        if (ctx->pool[i].used && ctx->pool[i].mem == pic->base[0]) {
+            ctx->pool[i].used = 0;
+            break;
+        }
+    }
+
+    for (i = 0; i < 4; i++)
+        pic->data[i] = NULL;
+}
+
+static DM365Frame *get_frame(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    DM365Frame *frame = NULL;
+    int i;
+
+    for (i = 0; i < MAX_FRAMES; i++) {
+        if (!ctx->frames[i].pic.data[0]) {
+            frame = &ctx->frames[i];
+            break;
+        }
+    }
+    if (!frame) {
+        av_log(avctx, AV_LOG_ERROR, "no free output frame\n");
+        return NULL;
+    }
+
+    if (avctx->get_buffer(avctx, &frame->pic) < 0) {
+        av_log(avctx, AV_LOG_ERROR, "get_buffer() failed\n");
+        return NULL;
+    }
+    if (!CMEM_getPhys(frame->pic.data[0])) {
+        av_log(avctx, AV_LOG_ERROR, "get_buffer() did not return CMEM memory\n");
+        avctx->release_buffer(avctx, &frame->pic);
+        return NULL;
+    }
+
+    frame->in_codec = 1;
+    frame->queued   = 0;
+
+    return frame;
+}
+
+/*
+ * return pictures which are neither referenced by the codec nor waiting
+ * for display, except the one returned by the current call
+ */
+static void release_frames(AVCodecContext *avctx, int keep_id)
+{
+    DM365Context *ctx = avctx->priv_data;
+    int i;
+
+    for (i = 0; i < MAX_FRAMES; i++) {
+        DM365Frame *frame = &ctx->frames[i];
+
+        if (frame->pic.data[0] && !frame->in_codec && !frame->queued &&
+            i + 1 != keep_id)
+            avctx->release_buffer(avctx, &frame->pic);
+    }
+}
+
+static DM365Frame *frame_from_id(AVCodecContext *avctx, XDAS_Int32 id)
+{
+    DM365Context *ctx = avctx->priv_data;
+
+    if (id < 1 || id > MAX_FRAMES || !ctx->frames[id - 1].pic.data[0]) {
+        av_log(avctx, AV_LOG_WARNING, "codec returned unknown buffer id %d\n",
+               (int) id);
+        return NULL;
+    }
+    return &ctx->frames[id - 1];
+}
+
+/*
+ * follow the display and free lists of the codec
+ */
+static void update_frames(AVCodecContext *avctx, IVIDDEC2_OutArgs *outArgs)
+{
+    DM365Context *ctx = avctx->priv_data;
+    DM365Frame *frame;
+    int i;
+
+    for (i = 0; i < IVIDEO2_MAX_IO_BUFFERS && outArgs->outputID[i]; i++) {
+        frame = frame_from_id(avctx, outArgs->outputID[i]);
+        if (!frame || frame->queued)
+            continue;
+        frame->queued = 1;
+        frame->disp   = outArgs->displayBufs[i];
+        ctx->display_queue[ctx->nb_queued++] = outArgs->outputID[i];
+    }
+
+    for (i = 0; i < IVIDEO2_MAX_IO_BUFFERS && outArgs->freeBufID[i]; i++) {
+        frame = frame_from_id(avctx, outArgs->freeBufID[i]);
+        if (frame)
+            frame->in_codec = 0;
+    }
+}
+
 static VIDDEC2_Handle decoder_create(AVCodecContext *avctx, Engine_Handle hEngine,
-        String codecName, VIDDEC2_Params *params, VIDDEC2_DynamicParams *dynParams)
+        const char *codecName, VIDDEC2_Params *params, VIDDEC2_DynamicParams *dynParams)
 {
     VIDDEC2_Handle         hDecode;
     VIDDEC2_Status         decStatus;
@@ -86,7 +335,9 @@ static VIDDEC2_Handle decoder_create(AVCodecContext *avctx, Engine_Handle hEngin
     }
 
     /* Create video decoder instance */
-    hDecode = VIDDEC2_create(hEngine, (String) codecName, params);
+    ff_dm365_engine_lock();
+    hDecode = VIDDEC2_create(hEngine, ff_dm365_codec_name(codecName), params);
+    ff_dm365_engine_unlock();
     if (hDecode == NULL)
         return NULL;
 
@@ -94,11 +345,15 @@ static VIDDEC2_Handle decoder_create(AVCodecContext *avctx, Engine_Handle hEngin
     decStatus.data.buf = NULL;
     decStatus.size = sizeof(VIDDEC2_Status);
 
+    ff_dm365_engine_lock();
     status = VIDDEC2_control(hDecode, XDM_SETPARAMS, dynParams, &decStatus);
+    ff_dm365_engine_unlock();
     if (status != VIDDEC2_EOK) {
         IH264VDEC_ExtendedError err = decStatus.extendedError;
         av_log(avctx, AV_LOG_ERROR, "extended error: %x", err);
+        ff_dm365_engine_lock();
         VIDDEC2_delete(hDecode);
+        ff_dm365_engine_unlock();
         return NULL;
     }
 
@@ -141,8 +396,8 @@ static int h264_dec_init(AVCodecContext *avctx)
     *params = Vdec2_Params_DEFAULT;
     *dynParams = Vdec2_DynamicParams_DEFAULT;
 
-    params->maxWidth = avctx->width;
-    params->maxHeight = avctx->height;
+    params->maxWidth = ctx->codec_width;
+    params->maxHeight = ctx->codec_height;
 
     params->size = sizeof(IH264VDEC_Params);
     dynParams->size = sizeof(IH264VDEC_DynamicParams);
@@ -163,111 +418,448 @@ static int h264_dec_init(AVCodecContext *avctx)
     return 0;
 }
 
-static av_cold int dm365_decode_init(AVCodecContext *avctx)
+/*
+ * allocates codecParams and codecDynParams, free them later with av_free
+ */
+static int mpeg4_dec_init(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    IMP4VDEC_Params *mpeg4Params;
+    IMP4VDEC_DynamicParams *mpeg4DynParams;
+    IVIDDEC2_Params *params;
+    IVIDDEC2_DynamicParams *dynParams;
+
+    mpeg4Params = av_malloc(sizeof(IMP4VDEC_Params));
+    if (mpeg4Params == NULL)
+        return AVERROR(ENOMEM);
+
+    mpeg4DynParams = av_mallocz(sizeof(IMP4VDEC_DynamicParams));
+    if (mpeg4DynParams == NULL) {
+        av_free(mpeg4Params);
+        return AVERROR(ENOMEM);
+    }
+
+    /* set default params */
+    *mpeg4Params = IMP4VDEC_PARAMS;
+
+    mpeg4DynParams->resetHDVICPeveryFrame = 1;
+
+    params = &mpeg4Params->viddecParams;
+    dynParams = &mpeg4DynParams->viddecDynamicParams;
+
+    *params = Vdec2_Params_DEFAULT;
+    *dynParams = Vdec2_DynamicParams_DEFAULT;
+
+    params->maxWidth = ctx->codec_width;
+    params->maxHeight = ctx->codec_height;
+
+    params->size = sizeof(IMP4VDEC_Params);
+    dynParams->size = sizeof(IMP4VDEC_DynamicParams);
+
+    ctx->codecParams = mpeg4Params;
+    ctx->codecDynParams  = mpeg4DynParams;
+
+    ctx->hDecode = decoder_create(avctx, ctx->hEngine, "mpeg4dec",
+            ctx->codecParams, ctx->codecDynParams);
+
+    if (!ctx->hDecode) {
+        av_log(avctx, AV_LOG_ERROR, "Cannot create decoder\n");
+        av_freep(&ctx->codecParams);
+        av_freep(&ctx->codecDynParams);
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * allocates codecParams and codecDynParams, free them later with av_free
+ */
+static int jpeg_dec_init(AVCodecContext *avctx)
 {
     DM365Context *ctx = avctx->priv_data;
+    IJPEGDEC_Params *jpegParams;
+    IJPEGDEC_DynamicParams *jpegDynParams;
+    IIMGDEC1_Params *params;
+    IIMGDEC1_DynamicParams *dynParams;
+    IMGDEC1_Status decStatus;
     XDAS_Int32 status;
-    VIDDEC2_Status decStatus;
-    int ret, i, buf_size;
 
-    /*
-     * CERuntime_init() has to be called from main application
-     * as well as CERuntime_exit(). Otherwise other dm365 codec
-     * initialization or deinitialization could break everything
-     *
-     * CMEM_init() and CMEM_exit() is implemented more reasonably as it counts
-     * its users, so we just need to assure that calls to init and exit equals.
-     */
+    jpegParams = av_mallocz(sizeof(IJPEGDEC_Params));
+    if (jpegParams == NULL)
+        return AVERROR(ENOMEM);
 
-    CMEM_init();
+    jpegDynParams = av_mallocz(sizeof(IJPEGDEC_DynamicParams));
+    if (jpegDynParams == NULL) {
+        av_free(jpegParams);
+        return AVERROR(ENOMEM);
+    }
 
-    ctx->hEngine = Engine_open("decode", NULL, NULL);
-    if (ctx->hEngine == NULL) {
-        av_log(avctx, AV_LOG_ERROR, "Cannot open codec engine.\n");
+    params = &jpegParams->imgdecParams;
+    dynParams = &jpegDynParams->imgdecDynamicParams;
+
+    params->size              = sizeof(IJPEGDEC_Params);
+    params->maxWidth          = ctx->codec_width;
+    params->maxHeight         = ctx->codec_height;
+    params->maxScans          = 15;
+    params->dataEndianness    = XDM_BYTE;
+    params->forceChromaFormat = XDM_YUV_420SP;
+
+    /* pictures are written with the pitch of av_dm365_default_get_buffer() */
+    ctx->display_width = FFALIGN(ctx->codec_width, 32);
+
+    dynParams->size         = sizeof(IJPEGDEC_DynamicParams);
+    dynParams->numAU        = XDM_DEFAULT;
+    dynParams->decodeHeader = XDM_DECODE_AU;
+    dynParams->displayWidth = ctx->display_width;
+
+    ctx->codecParams = jpegParams;
+    ctx->codecDynParams  = jpegDynParams;
+
+    ff_dm365_engine_lock();
+    ctx->hImgDecode = IMGDEC1_create(ctx->hEngine, ff_dm365_codec_name("jpegdec"),
+                                     params);
+    ff_dm365_engine_unlock();
+    if (!ctx->hImgDecode) {
+        av_log(avctx, AV_LOG_ERROR, "Cannot create decoder\n");
+        goto fail;
+    }
+
+    decStatus.data.buf = NULL;
+    decStatus.size = sizeof(IMGDEC1_Status);
+
+    ff_dm365_engine_lock();
+    status = IMGDEC1_control(ctx->hImgDecode, XDM_SETPARAMS, dynParams,
+                             &decStatus);
+    ff_dm365_engine_unlock();
+    if (status != IMGDEC1_EOK) {
+        av_log(avctx, AV_LOG_ERROR, "XDM_SETPARAMS control failed, "
+               "extended error: %x\n", (int) decStatus.extendedError);
+        ff_dm365_engine_lock();
+        IMGDEC1_delete(ctx->hImgDecode);
+        ff_dm365_engine_unlock();
+        ctx->hImgDecode = NULL;
+        goto fail;
+    }
+
+    return 0;
+
+fail:
+    av_freep(&ctx->codecParams);
+    av_freep(&ctx->codecDynParams);
+    return -1;
+}
+
+static void decoder_delete(DM365Context *ctx)
+{
+    ff_dm365_engine_lock();
+    if (ctx->hImgDecode)
+        IMGDEC1_delete(ctx->hImgDecode);
+    else if (ctx->hDecode)
+        VIDDEC2_delete(ctx->hDecode);
+    ff_dm365_engine_unlock();
+    ctx->hImgDecode = NULL;
+    ctx->hDecode    = NULL;
+}
+
+static int get_buf_info(AVCodecContext *avctx, XDM_AlgBufInfo *bufInfo)
+{
+    DM365Context *ctx = avctx->priv_data;
+    XDAS_Int32 status, err;
+
+    if (ctx->hImgDecode) {
+        IMGDEC1_Status decStatus;
+
+        decStatus.data.buf = NULL;
+        decStatus.size = sizeof(IMGDEC1_Status);
+
+        ff_dm365_engine_lock();
+        status = IMGDEC1_control(ctx->hImgDecode, XDM_GETBUFINFO,
+                ctx->codecDynParams, &decStatus);
+        ff_dm365_engine_unlock();
+        status = status == IMGDEC1_EOK ? 0 : -1;
+        err = decStatus.extendedError;
+        *bufInfo = decStatus.bufInfo;
+    } else {
+        VIDDEC2_Status decStatus;
+
+        decStatus.data.buf = NULL;
+        decStatus.size = sizeof(VIDDEC2_Status);
+        decStatus.maxNumDisplayBufs = 0;
+
+        ff_dm365_engine_lock();
+        status = VIDDEC2_control(ctx->hDecode, XDM_GETBUFINFO,
+                ctx->codecDynParams, &decStatus);
+        ff_dm365_engine_unlock();
+        status = status == VIDDEC2_EOK ? 0 : -1;
+        err = decStatus.extendedError;
+        *bufInfo = decStatus.bufInfo;
+    }
+
+    if (status < 0) {
+        av_log(avctx, AV_LOG_ERROR, "XDM_GETBUFINFO control failed, "
+                "extended error: %x", (int) err);
         return AVERROR(1);
     }
+    return 0;
+}
+
+static void codec_close(DM365Context *ctx)
+{
+    decoder_delete(ctx);
+    av_freep(&ctx->codecParams);
+    av_freep(&ctx->codecDynParams);
+}
+
+/*
+ * create the codec instance for pictures up to codec_width x codec_height
+ * and size the buffers for it
+ */
+static int codec_open(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    XDM_AlgBufInfo bufInfo;
+    int ret, i, buf_size;
 
     switch (avctx->codec_id) {
     case CODEC_ID_H264:
         ret = h264_dec_init(avctx);
         break;
+    case CODEC_ID_MPEG4:
+        ret = mpeg4_dec_init(avctx);
+        break;
+    case CODEC_ID_MJPEG:
+        ret = jpeg_dec_init(avctx);
+        break;
     default:
         ret = -1;
         break;
     }
-
-    if (ret < 0) {
-        Engine_close(ctx->hEngine);
+    if (ret < 0)
         return ret;
-    }
 
     /* get output buffer requirements */
-    decStatus.data.buf = NULL;
-    decStatus.size = sizeof(VIDDEC2_Status);
-    decStatus.maxNumDisplayBufs = 0;
-
-    status = VIDDEC2_control(ctx->hDecode, XDM_GETBUFINFO,
-            ctx->codecDynParams, &decStatus);
-    if (status != VIDDEC2_EOK) {
-        IH264VDEC_ExtendedError err = decStatus.extendedError;
-        av_log(avctx, AV_LOG_ERROR, "XDM_GETBUFINFO control failed, "
-                "extended error: %x", err);
-        ret = AVERROR(1);
-        goto init_cleanup;
-    }
+    ret = get_buf_info(avctx, &bufInfo);
+    if (ret < 0)
+        goto fail;
 
-    ctx->minNumOutBufs = decStatus.bufInfo.minNumOutBufs;
-    memcpy(ctx->minOutBufSize, decStatus.bufInfo.minOutBufSize,
-            4*decStatus.bufInfo.minNumOutBufs);
+    ctx->minNumOutBufs = bufInfo.minNumOutBufs;
+    memcpy(ctx->minOutBufSize, bufInfo.minOutBufSize,
+            4*bufInfo.minNumOutBufs);
 
     buf_size = 0;
     for (i = 0; i < ctx->minNumOutBufs; i++) {
         buf_size += ctx->minOutBufSize[i];
     }
+    ctx->out_buf_size = buf_size;
 
-    /* allocate continous buffers */
-    ctx->out_buf = CMEM_alloc(buf_size, &alloc_params);
-    if (ctx->out_buf == NULL) {
-        ret = AVERROR(ENOMEM);
-        goto init_cleanup;
+    /* TODO: input buffer could be smaller */
+    buf_size = FFMAX(buf_size, bufInfo.minInBufSize[0]);
+    if (buf_size > ctx->in_buf_size) {
+        if (ctx->in_buf)
+            CMEM_free(ctx->in_buf, &alloc_params);
+        ctx->in_buf_size = 0;
+        ctx->in_buf = CMEM_alloc(buf_size, &alloc_params);
+        if (ctx->in_buf == NULL) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        ctx->in_buf_size = buf_size;
     }
 
-    /* TODO: input buffer could be smaller */
-    ctx->in_buf = CMEM_alloc(buf_size, &alloc_params);
-    if (ctx->in_buf == NULL) {
-        ret = AVERROR(ENOMEM);
-        CMEM_free(ctx->out_buf, &alloc_params);
-        goto init_cleanup;
+    return 0;
+
+fail:
+    codec_close(ctx);
+    return ret;
+}
+
+/*
+ * picture size of the current sequence as parsed by the codec
+ */
+static int stream_size(AVCodecContext *avctx, int *width, int *height)
+{
+    DM365Context *ctx = avctx->priv_data;
+    XDAS_Int32 status;
+
+    if (ctx->hImgDecode) {
+        IMGDEC1_Status decStatus;
+
+        decStatus.data.buf = NULL;
+        decStatus.size = sizeof(IMGDEC1_Status);
+
+        ff_dm365_engine_lock();
+        status = IMGDEC1_control(ctx->hImgDecode, XDM_GETSTATUS,
+                                 ctx->codecDynParams, &decStatus);
+        ff_dm365_engine_unlock();
+        if (status != IMGDEC1_EOK)
+            return -1;
+        *width  = decStatus.outputWidth;
+        *height = decStatus.outputHeight;
+    } else {
+        VIDDEC2_Status decStatus;
+
+        decStatus.data.buf = NULL;
+        decStatus.size = sizeof(VIDDEC2_Status);
+
+        ff_dm365_engine_lock();
+        status = VIDDEC2_control(ctx->hDecode, XDM_GETSTATUS,
+                                 ctx->codecDynParams, &decStatus);
+        ff_dm365_engine_unlock();
+        if (status != VIDDEC2_EOK)
+            return -1;
+        *width  = decStatus.outputWidth;
+        *height = decStatus.outputHeight;
+    }
+    return 0;
+}
+
+/*
+ * replace the codec instance by one which can hold the pictures of a
+ * sequence which outgrew it, the engine and the pictures waiting for
+ * display are kept; returns 1 if the codec was resized
+ */
+static int resize_codec(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    int width, height, i, ret;
+
+    if (stream_size(avctx, &width, &height) < 0 ||
+        (width <= ctx->codec_width && height <= ctx->codec_height) ||
+        av_image_check_size(width, height, 0, avctx) < 0)
+        return 0;
+
+    av_log(avctx, AV_LOG_VERBOSE, "resolution changed to %dx%d, "
+           "recreating the codec\n", width, height);
+
+    codec_close(ctx);
+
+    /* the old instance dropped its references */
+    for (i = 0; i < MAX_FRAMES; i++)
+        ctx->frames[i].in_codec = 0;
+    ctx->flushing = 0;
+    release_frames(avctx, 0);
+
+    /* never shrink, streams may switch back and forth */
+    ctx->codec_width  = FFMAX(ctx->codec_width,  width);
+    ctx->codec_height = FFMAX(ctx->codec_height, height);
+
+    ret = codec_open(avctx);
+    if (ret < 0) {
+        av_log(avctx, AV_LOG_ERROR, "cannot recreate the codec for %dx%d\n",
+               width, height);
+        return ret;
+    }
+    return 1;
+}
+
+static av_cold int dm365_decode_init(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    int ret;
+
+    /*
+     * CERuntime_init() has to be called from main application
+     * as well as CERuntime_exit(). Otherwise other dm365 codec
+     * initialization or deinitialization could break everything
+     *
+     * CMEM_init() and CMEM_exit() is implemented more reasonably as it counts
+     * its users, so we just need to assure that calls to init and exit equals.
+     */
+
+    CMEM_init();
+
+    ctx->hEngine = ff_dm365_engine_open(avctx, "decode");
+    if (ctx->hEngine == NULL) {
+        ret = AVERROR(1);
+        goto fail_engine;
     }
 
+    ctx->codec_width  = FFMAX(avctx->width,  ctx->max_width);
+    ctx->codec_height = FFMAX(avctx->height, ctx->max_height);
+
+    ret = codec_open(avctx);
+    if (ret < 0)
+        goto fail_codec;
+
+    /* pictures are decoded in place, they have to live in CMEM */
+    if (avctx->get_buffer == avcodec_default_get_buffer)
+        avctx->get_buffer = av_dm365_default_get_buffer;
+    if (avctx->release_buffer == avcodec_default_release_buffer)
+        avctx->release_buffer = av_dm365_default_release_buffer;
+
     avctx->pix_fmt = avctx->codec->pix_fmts[0];
 
     return 0;
 
-init_cleanup:
-    VIDDEC2_delete(ctx->hDecode);
-    av_free(ctx->codecParams);
-    av_free(ctx->codecDynParams);
-    Engine_close(ctx->hEngine);
+fail_codec:
+    ff_dm365_engine_close(ctx->hEngine);
+    ctx->hEngine = NULL;
+fail_engine:
+    CMEM_exit();
     return ret;
 }
 
 static av_cold int dm365_decode_close(AVCodecContext *avctx)
 {
     DM365Context *ctx = avctx->priv_data;
+    int i;
 
-    VIDDEC2_delete(ctx->hDecode);
-    av_free(ctx->codecParams);
-    av_free(ctx->codecDynParams);
-    Engine_close(ctx->hEngine);
+    codec_close(ctx);
+    ff_dm365_engine_close(ctx->hEngine);
 
-    CMEM_free(ctx->out_buf, &alloc_params);
-    CMEM_free(ctx->in_buf, &alloc_params);
+    for (i = 0; i < MAX_FRAMES; i++) {
+        if (ctx->frames[i].pic.data[0])
+            avctx->release_buffer(avctx, &ctx->frames[i].pic);
+    }
+    for (i = 0; i < MAX_FRAMES; i++) {
+        if (ctx->pool[i].mem) {
+            av_dm365_unregister_buffer(ctx->pool[i].mem);
+            CMEM_free(ctx->pool[i].mem, &alloc_params);
+        }
+    }
+    if (avctx->get_buffer == av_dm365_default_get_buffer)
+        avctx->get_buffer = avcodec_default_get_buffer;
+    if (avctx->release_buffer == av_dm365_default_release_buffer)
+        avctx->release_buffer = avcodec_default_release_buffer;
+
+    if (ctx->in_buf)
+        CMEM_free(ctx->in_buf, &alloc_params);
     CMEM_exit();
 
     return 0;
 }
 
+static void dm365_decode_flush(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    VIDDEC2_Status decStatus;
+    XDAS_Int32 status;
+    int i;
+
+    decStatus.data.buf = NULL;
+    decStatus.size = sizeof(VIDDEC2_Status);
+
+    if (ctx->hDecode) {
+        ff_dm365_engine_lock();
+        status = VIDDEC2_control(ctx->hDecode, XDM_RESET, ctx->codecDynParams,
+                                 &decStatus);
+        ff_dm365_engine_unlock();
+        if (status != VIDDEC2_EOK)
+            av_log(avctx, AV_LOG_ERROR, "XDM_RESET control failed\n");
+    }
+
+    /* the codec dropped all its references */
+    for (i = 0; i < MAX_FRAMES; i++) {
+        ctx->frames[i].in_codec = 0;
+        ctx->frames[i].queued   = 0;
+    }
+    ctx->nb_queued = 0;
+    ctx->flushing  = 0;
+
+    release_frames(avctx, 0);
+}
+
 static enum AVPictureType picture_type(IVIDEO_FrameType frameType)
 {
     enum AVPictureType pict_type;
@@ -293,6 +885,34 @@ static enum AVPictureType picture_type(IVIDEO_FrameType frameType)
     return pict_type;
 }
 
+/*
+ * return the packet data in memory the codec can read
+ */
+static XDAS_Int8 *input_buffer(AVCodecContext *avctx, AVPacket *avpkt)
+{
+    DM365Context *ctx = avctx->priv_data;
+
+    /* packet already lives in contiguous memory */
+    if (ctx->zerocopy && ff_dm365_is_cmem_packet(avpkt))
+        return (XDAS_Int8 *) avpkt->data;
+
+    /* copy input data to CMEM buffer, it grows with the resolution */
+    if (avpkt->size > ctx->in_buf_size) {
+        /* keep the old buffer on failure, flushing uses it as output buffer */
+        void *buf = CMEM_alloc(avpkt->size, &alloc_params);
+        if (!buf) {
+            av_log(avctx, AV_LOG_ERROR, "cannot allocate %d bytes for the "
+                   "packet\n", avpkt->size);
+            return NULL;
+        }
+        CMEM_free(ctx->in_buf, &alloc_params);
+        ctx->in_buf      = buf;
+        ctx->in_buf_size = avpkt->size;
+    }
+    memcpy(ctx->in_buf, avpkt->data, avpkt->size);
+    return ctx->in_buf;
+}
+
 static int dm365_decode_frame(AVCodecContext *avctx,
         void *outdata, int *outdata_size, AVPacket *avpkt)
 {
@@ -304,51 +924,263 @@ static int dm365_decode_frame(AVCodecContext *avctx,
     XDM1_BufDesc inBufDesc;
     XDM_BufDesc outBufDesc;
     XDAS_Int8 *outBufPtrArray[2];
+    XDAS_Int8 *in_buf = ctx->in_buf;
+    DM365Frame *frame = NULL;
+    IVIDEO1_BufDesc *bd;
+    int id, ret;
 
+    *outdata_size = 0;
+    release_frames(avctx, 0);
 
-    outBufPtrArray[0] = ctx->out_buf;
-    outBufPtrArray[1] = outBufPtrArray[0] + ctx->minOutBufSize[0];
+    /* a failed resize left no codec instance */
+    if (!ctx->hDecode)
+        return AVERROR(EINVAL);
 
-    outBufDesc.numBufs  = ctx->minNumOutBufs;
-    outBufDesc.bufSizes = ctx->minOutBufSize;
-    outBufDesc.bufs     = outBufPtrArray;
+    if (avpkt->size && ctx->flushing)
+        dm365_decode_flush(avctx);
 
-    /* copy input data to CMEM buffer */
-    /* TODO: add size check */
-    memcpy(ctx->in_buf, avpkt->data, avpkt->size);
+    if (!avpkt->size) {
+        /* drain the pictures held back by the codec */
+        if (!ctx->flushing) {
+            VIDDEC2_Status decStatus;
+
+            decStatus.data.buf = NULL;
+            decStatus.size = sizeof(VIDDEC2_Status);
+            ff_dm365_engine_lock();
+            status = VIDDEC2_control(ctx->hDecode, XDM_FLUSH,
+                                     ctx->codecDynParams, &decStatus);
+            ff_dm365_engine_unlock();
+            if (status != VIDDEC2_EOK) {
+                av_log(avctx, AV_LOG_ERROR, "XDM_FLUSH control failed\n");
+                return AVERROR_INVALIDDATA;
+            }
+            ctx->flushing = 1;
+        }
+
+        if (!ctx->nb_queued) {
+            /* the codec does not write into the output buffers when flushing */
+            outBufPtrArray[0] = ctx->in_buf;
+            outBufPtrArray[1] = outBufPtrArray[0] + ctx->minOutBufSize[0];
+            inArgs.inputID = 0;
+        }
+    } else {
+        in_buf = input_buffer(avctx, avpkt);
+        if (!in_buf)
+            return AVERROR(ENOMEM);
+
+        frame = get_frame(avctx);
+        if (!frame)
+            return AVERROR(ENOMEM);
+
+        outBufPtrArray[0] = frame->pic.data[0];
+        outBufPtrArray[1] = frame->pic.data[1];
+        inArgs.inputID = frame - ctx->frames + 1;
+    }
+
+    if (avpkt->size || !ctx->nb_queued) {
+        outBufDesc.numBufs  = ctx->minNumOutBufs;
+        outBufDesc.bufSizes = ctx->minOutBufSize;
+        outBufDesc.bufs     = outBufPtrArray;
+
+        inBufDesc.numBufs           = 1;
+        inBufDesc.descs[0].buf      = in_buf;
+        inBufDesc.descs[0].bufSize  = avpkt->size;
+
+        inArgs.size     = sizeof(VIDDEC2_InArgs);
+        inArgs.numBytes = avpkt->size;
+
+        outArgs.size    = sizeof(VIDDEC2_OutArgs);
+
+        ff_dm365_engine_lock();
+        status = VIDDEC2_process(ctx->hDecode, &inBufDesc, &outBufDesc,
+                (IVIDDEC2_InArgs *) &inArgs, (IVIDDEC2_OutArgs *) &outArgs);
+        ff_dm365_engine_unlock();
+
+        /* the lists are valid even if the call failed */
+        update_frames(avctx, &outArgs);
+
+        if (status != VIDDEC2_EOK && avpkt->size) {
+            IH264VDEC_ExtendedError err = outArgs.decodedBufs.extendedError & 0xff;
+
+            /* the codec did not take the picture of the failed call, unless
+             * it is waiting for display it is free again */
+            frame->in_codec = 0;
+            release_frames(avctx, 0);
+
+            /* the sequence may have outgrown the codec instance */
+            ret = resize_codec(avctx);
+            if (ret > 0)
+                return dm365_decode_frame(avctx, outdata, outdata_size, avpkt);
+            if (ret < 0)
+                return ret;
+
+            av_log(avctx, AV_LOG_ERROR, "extended error: %x\n", err);
+            return AVERROR_INVALIDDATA;
+        }
+
+        avpkt->size = outArgs.bytesConsumed;
+    }
+
+    if (!ctx->nb_queued)
+        return avpkt->size;
+
+    /* return the oldest picture in display order */
+    id = ctx->display_queue[0];
+    ctx->nb_queued--;
+    memmove(ctx->display_queue, ctx->display_queue + 1,
+            ctx->nb_queued * sizeof(*ctx->display_queue));
+
+    frame = &ctx->frames[id - 1];
+    frame->queued = 0;
+    bd = &frame->disp;
+
+    *picture = frame->pic;
+    picture->data[0] = bd->bufDesc[0].buf;
+    picture->data[1] = bd->bufDesc[1].buf;
+    picture->data[2] = NULL;
+    picture->data[3] = NULL;
+    picture->linesize[0] = bd->framePitch;
+    picture->linesize[1] = bd->framePitch;
+    picture->linesize[2] = 0;
+    picture->linesize[3] = 0;
+
+    /* the codec instance decodes any size up to the one it was created for */
+    if (bd->frameWidth != avctx->width || bd->frameHeight != avctx->height) {
+        av_log(avctx, AV_LOG_VERBOSE, "resolution changed from %dx%d to %dx%d\n",
+               avctx->width, avctx->height, (int) bd->frameWidth,
+               (int) bd->frameHeight);
+        avcodec_set_dimensions(avctx, bd->frameWidth, bd->frameHeight);
+    }
+    picture->width  = avctx->width;
+    picture->height = avctx->height;
+    picture->pict_type = picture_type(bd->frameType);
+    picture->key_frame = picture->pict_type == AV_PICTURE_TYPE_I;
+    *outdata_size = sizeof(AVFrame);
+
+    /* the returned picture stays valid until the next call */
+    release_frames(avctx, id);
+
+    return avpkt->size;
+}
+
+static int dm365_imgdec_frame(AVCodecContext *avctx,
+        void *outdata, int *outdata_size, AVPacket *avpkt)
+{
+    DM365Context *ctx = avctx->priv_data;
+    AVFrame *picture = outdata;
+    IMGDEC1_InArgs inArgs;
+    IMGDEC1_OutArgs outArgs;
+    IMGDEC1_Status decStatus;
+    XDAS_Int32 status;
+    XDM1_BufDesc inBufDesc;
+    XDM1_BufDesc outBufDesc;
+    XDAS_Int8 *in_buf;
+    DM365Frame *frame;
+    int id, ret;
+
+    *outdata_size = 0;
+    release_frames(avctx, 0);
+
+    if (!avpkt->size)
+        return 0;
+
+    /* a failed resize left no codec instance */
+    if (!ctx->hImgDecode)
+        return AVERROR(EINVAL);
+
+    in_buf = input_buffer(avctx, avpkt);
+    if (!in_buf)
+        return AVERROR(ENOMEM);
+
+    frame = get_frame(avctx);
+    if (!frame)
+        return AVERROR(ENOMEM);
+    id = frame - ctx->frames + 1;
+
+    decStatus.data.buf = NULL;
+    decStatus.size = sizeof(IMGDEC1_Status);
+
+    /* a user supplied get_buffer() may use another pitch */
+    if (frame->pic.linesize[0] != ctx->display_width) {
+        IIMGDEC1_DynamicParams *dynParams = ctx->codecDynParams;
+
+        dynParams->displayWidth = frame->pic.linesize[0];
+        ff_dm365_engine_lock();
+        status = IMGDEC1_control(ctx->hImgDecode, XDM_SETPARAMS,
+                                 ctx->codecDynParams, &decStatus);
+        ff_dm365_engine_unlock();
+        if (status != IMGDEC1_EOK) {
+            av_log(avctx, AV_LOG_ERROR, "XDM_SETPARAMS control failed, "
+                   "extended error: %x\n", (int) decStatus.extendedError);
+            frame->in_codec = 0;
+            release_frames(avctx, 0);
+            return AVERROR(EINVAL);
+        }
+        ctx->display_width = frame->pic.linesize[0];
+    }
 
     inBufDesc.numBufs           = 1;
-    inBufDesc.descs[0].buf      = ctx->in_buf;
+    inBufDesc.descs[0].buf      = in_buf;
     inBufDesc.descs[0].bufSize  = avpkt->size;
 
-    inArgs.size     = sizeof(VIDDEC2_InArgs);
+    outBufDesc.numBufs          = 2;
+    outBufDesc.descs[0].buf     = frame->pic.data[0];
+    outBufDesc.descs[0].bufSize = ctx->minOutBufSize[0];
+    outBufDesc.descs[1].buf     = frame->pic.data[1];
+    outBufDesc.descs[1].bufSize = ctx->minOutBufSize[1];
+
+    inArgs.size     = sizeof(IMGDEC1_InArgs);
     inArgs.numBytes = avpkt->size;
-    inArgs.inputID  = 1;
 
-    outArgs.size    = sizeof(VIDDEC2_OutArgs);
+    outArgs.size    = sizeof(IMGDEC1_OutArgs);
 
-    status = VIDDEC2_process(ctx->hDecode, &inBufDesc, &outBufDesc,
-            (IVIDDEC2_InArgs *) &inArgs, (IVIDDEC2_OutArgs *) &outArgs);
-    if (status != VIDDEC2_EOK) {
-        IH264VDEC_ExtendedError err = outArgs.decodedBufs.extendedError & 0xff;
-        av_log(avctx, AV_LOG_ERROR, "extended error: %x\n", err);
+    ff_dm365_engine_lock();
+    status = IMGDEC1_process(ctx->hImgDecode, &inBufDesc, &outBufDesc,
+                             &inArgs, &outArgs);
+    if (status == IMGDEC1_EOK) {
+        /* the picture size is only reported by the status */
+        status = IMGDEC1_control(ctx->hImgDecode, XDM_GETSTATUS,
+                                 ctx->codecDynParams, &decStatus);
+        outArgs.extendedError = decStatus.extendedError;
+    }
+    ff_dm365_engine_unlock();
+
+    /* the codec does not keep references to the picture */
+    frame->in_codec = 0;
+
+    if (status != IMGDEC1_EOK) {
+        release_frames(avctx, 0);
+
+        /* the picture may be larger than the codec instance */
+        ret = resize_codec(avctx);
+        if (ret > 0)
+            return dm365_imgdec_frame(avctx, outdata, outdata_size, avpkt);
+        if (ret < 0)
+            return ret;
+
+        av_log(avctx, AV_LOG_ERROR, "extended error: %x\n",
+               (int) outArgs.extendedError);
         return AVERROR_INVALIDDATA;
-    } else {
-        IVIDEO1_BufDesc *bd = &outArgs.decodedBufs;
+    }
 
-        picture->data[0] = bd->bufDesc[0].buf;
-        picture->data[1] = bd->bufDesc[1].buf;
-        picture->data[2] = NULL;
-        picture->data[3] = NULL;
-        picture->linesize[0] = bd->framePitch;
-        picture->linesize[1] = bd->framePitch;
-        picture->linesize[2] = 0;
-        picture->linesize[3] = 0;
-        picture->pict_type = picture_type(bd->frameType);
+    if (decStatus.outputWidth  != avctx->width ||
+        decStatus.outputHeight != avctx->height) {
+        av_log(avctx, AV_LOG_VERBOSE, "resolution changed from %dx%d to %dx%d\n",
+               avctx->width, avctx->height, (int) decStatus.outputWidth,
+               (int) decStatus.outputHeight);
+        avcodec_set_dimensions(avctx, decStatus.outputWidth,
+                               decStatus.outputHeight);
     }
-    *outdata_size = sizeof(AVPicture);
 
-    avpkt->size = outArgs.bytesConsumed;
+    *picture = frame->pic;
+    picture->width  = avctx->width;
+    picture->height = avctx->height;
+    picture->pict_type = AV_PICTURE_TYPE_I;
+    picture->key_frame = 1;
+    *outdata_size = sizeof(AVFrame);
+
+    /* the returned picture stays valid until the next call */
+    release_frames(avctx, id);
 
     return avpkt->size;
 }
@@ -363,7 +1195,44 @@ AVCodec ff_libdm365_h264_decoder =
     .init           = dm365_decode_init,
     .close          = dm365_decode_close,
     .decode         = dm365_decode_frame,
+    .flush          = dm365_decode_flush,
+    .capabilities   = CODEC_CAP_DELAY,
     .pix_fmts       = (const enum PixelFormat[]) {PIX_FMT_NV12, PIX_FMT_NONE},
     .long_name      = NULL_IF_CONFIG_SMALL("h.264 hardware decoder on dm365 SoC"),
+    .priv_class     = &dm365_dec_class,
+};
+#endif
+
+#if CONFIG_LIBDM365_MPEG4_DECODER
+AVCodec ff_libdm365_mpeg4_decoder =
+{
+    .name           = "libdm365_mpeg4",
+    .type           = AVMEDIA_TYPE_VIDEO,
+    .id             = CODEC_ID_MPEG4,
+    .priv_data_size = sizeof(DM365Context),
+    .init           = dm365_decode_init,
+    .close          = dm365_decode_close,
+    .decode         = dm365_decode_frame,
+    .flush          = dm365_decode_flush,
+    .capabilities   = CODEC_CAP_DELAY,
+    .pix_fmts       = (const enum PixelFormat[]) {PIX_FMT_NV12, PIX_FMT_NONE},
+    .long_name      = NULL_IF_CONFIG_SMALL("mpeg4 hardware decoder on dm365 SoC"),
+    .priv_class     = &dm365_dec_class,
+};
+#endif
+
+#if CONFIG_LIBDM365_JPEG_DECODER
+AVCodec ff_libdm365_jpeg_decoder =
+{
+    .name           = "libdm365_jpeg",
+    .type           = AVMEDIA_TYPE_VIDEO,
+    .id             = CODEC_ID_MJPEG,
+    .priv_data_size = sizeof(DM365Context),
+    .init           = dm365_decode_init,
+    .close          = dm365_decode_close,
+    .decode         = dm365_imgdec_frame,
+    .pix_fmts       = (const enum PixelFormat[]) {PIX_FMT_NV12, PIX_FMT_NONE},
+    .long_name      = NULL_IF_CONFIG_SMALL("jpeg hardware decoder on dm365 SoC"),
+    .priv_class     = &dm365_dec_class,
 };
 #endif
@@ -26,8 +26,16 @@
 
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/intreadwrite.h"
 #include "avcodec.h"
 #include "internal.h"
+#include "libdm365.h"
+#include "dm365.h"
+
+#if HAVE_PTHREADS
+#include <pthread.h>
+#endif
 
 #include <xdc/std.h>
 #include <ti/sdo/ce/CERuntime.h>
@@ -37,19 +45,108 @@
 #include <ti/sdo/codecs/mpeg4enc/imp4venc.h>
 #include <ti/sdo/ce/image1/imgenc1.h>
 #include <ti/sdo/codecs/jpegenc/ijpegenc.h>
+#include <ti/sdo/linuxutils/cmem/include/cmem.h>
+
+static CMEM_AllocParams alloc_params = {
+    .type = CMEM_HEAP,
+    .flags = CMEM_NONCACHED,
+    .alignment = 32,
+};
 
 typedef struct DM365Context {
+    AVClass *class;
     AVFrame image;
     Engine_Handle hEngine;
     VISA_Handle hEncode;
     void *codecParams;
     void *codecDynParams;
+
+    /* rate control, changes are sent with XDM_SETPARAMS before the next
+     * picture is encoded */
+    int force_idr;
+    AVRational target_fps;
+    int params_changed;
+
+    int slice_output;           /* slices are returned one per process call */
+
+    /* JPEG snapshots of every snapshot_interval-th picture, encoded by a
+     * second codec instance from the same input buffer */
+    int snapshot_interval;
+    int snapshot_quality;
+    VISA_Handle hSnapshot;
+    void *snapParams;
+    void *snapDynParams;
+    int snapshot_count;
+    AVPacket snapshot;          /* latest snapshot not fetched yet */
+
+    /* motion vectors and SAD of the macroblocks, written by the codec into
+     * mb_buf and exported in two sets, one is read by the application while
+     * the async worker fills the other */
+    int mb_info;
+    uint8_t *mb_buf;
+    int mb_buf_size;
+    int16_t (*mb_mv[2])[2];
+    uint32_t *mb_sad[2];
+    int mb_set;
+
+    /* regions of interest, set by the application for the next picture and
+     * passed with the process call of the picture */
+    char *roi_str;
+    AVDM365ROI roi_next[AV_DM365_MAX_ROI];
+    int nb_roi_next;
+    ROI_Interface roi;
+
+    /* asynchronous mode, the worker thread owns hEncode while busy */
+    int async;
+    AVFrame in_frames[2];       /* CMEM copies of the queued pictures */
+    int next_in;
+    uint8_t *out_buf;           /* bitstream of the picture being encoded */
+    int out_buf_size;
+    AVFrame job_coded;
+    int job_ret;
+    int pending;                /* a picture was queued and not returned yet */
+    AVFrame staging;            /* CMEM copy of a picture outside of CMEM */
+#if HAVE_PTHREADS
+    pthread_t worker;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    AVFrame *job;               /* picture the worker has to encode */
+    int busy;
+    int worker_exit;
+#endif
 } DM365Context;
 
+#define OFFSET(x) offsetof(DM365Context, x)
+#define VE AV_OPT_FLAG_VIDEO_PARAM | AV_OPT_FLAG_ENCODING_PARAM
+static const AVOption options[] = {
+    { "async_encode", "encode in a worker thread, packets are returned one frame late",
+      OFFSET(async), FF_OPT_TYPE_INT, {.dbl = 0}, 0, 1, VE },
+    { "force_idr", "code the next picture as IDR (h264) or intra (mpeg4) picture",
+      OFFSET(force_idr), FF_OPT_TYPE_INT, {.dbl = 0}, 0, 1, VE },
+    { "target_fps", "frame rate the rate control aims at, 0 for the stream frame rate",
+      OFFSET(target_fps), FF_OPT_TYPE_RATIONAL, {.dbl = 0}, 0, 120, VE },
+    { "snapshot_interval", "encode every Nth picture also as JPEG, see av_dm365_get_snapshot()",
+      OFFSET(snapshot_interval), FF_OPT_TYPE_INT, {.dbl = 0}, 0, INT_MAX, VE },
+    { "snapshot_quality", "quality factor of the JPEG snapshots",
+      OFFSET(snapshot_quality), FF_OPT_TYPE_INT, {.dbl = 75}, 1, 100, VE },
+    { "mb_info", "export motion vectors and SAD of the macroblocks (h264), see av_dm365_get_mb_sad()",
+      OFFSET(mb_info), FF_OPT_TYPE_INT, {.dbl = 0}, 0, 1, VE },
+    { "roi", "regions of interest (h264), x,y,w,h,qp_offset separated by |",
+      OFFSET(roi_str), FF_OPT_TYPE_STRING, {.str = NULL}, 0, 0, VE },
+    { NULL },
+};
+
+static const AVClass dm365_venc_class = {
+    .class_name = "libdm365 video encoder",
+    .item_name  = av_default_item_name,
+    .option     = options,
+    .version    = LIBAVUTIL_VERSION_INT,
+};
+
 /*
  * Default parameters for hardware encoder
  */
-#if CONFIG_LIBDM365_H264_ENCODER
+#if CONFIG_LIBDM365_H264_ENCODER || CONFIG_LIBDM365_MPEG4_ENCODER
 static const VIDENC1_Params Venc1_Params_DEFAULT = {
     sizeof(VIDENC1_Params),           /* size */
     XDM_DEFAULT,                      /* encodingPreset */
@@ -153,45 +250,52 @@ static IMGENC1_Handle imgenc_create(AVCodecContext *avctx, Engine_Handle hEngine
     IMGENC1_Status encStatus;
     XDAS_Int32 status;
 
-    hEncode = IMGENC1_create(hEngine, (String) encoder, params);
+    ff_dm365_engine_lock();
+    hEncode = IMGENC1_create(hEngine, ff_dm365_codec_name(encoder), params);
+    ff_dm365_engine_unlock();
     if (hEncode == 0)
         return NULL;
 
     encStatus.size = sizeof(IMGENC1_Status);
     encStatus.data.buf = NULL;
 
+    ff_dm365_engine_lock();
     status = IMGENC1_control(hEncode, XDM_SETPARAMS, dynParams, &encStatus);
+    ff_dm365_engine_unlock();
     if (status != VIDENC1_EOK) {
         DM365_JPEGENC_ERROR err = encStatus.extendedError & 0xff;
         av_log(avctx, AV_LOG_ERROR, "extended error: %x\n", err);
+        ff_dm365_engine_lock();
         IMGENC1_delete(hEncode);
+        ff_dm365_engine_unlock();
         return NULL;
     }
 
     return hEncode;
 }
 
-static av_cold int jpeg_enc_init(AVCodecContext *avctx)
+/*
+ * creates a jpeg encoder for pictures of the context size and allocates
+ * its params and dynParams, free them later with av_free
+ */
+static av_cold IMGENC1_Handle jpeg_create(AVCodecContext *avctx, int quality,
+        void **params, void **dynamicParams)
 {
     DM365Context *ctx = avctx->priv_data;
     IJPEGENC_Params *jpegParams;
     IJPEGENC_DynamicParams *jpegDynParams;
     IIMGENC1_Params *encParams;
     IIMGENC1_DynamicParams *dynParams;
-
-    if (avctx->pix_fmt != PIX_FMT_NV12) {
-        av_log(avctx, AV_LOG_INFO, "unsupported pixel format\n");
-        return -1;
-    }
+    IMGENC1_Handle hEncode;
 
     jpegParams = av_malloc(sizeof(IJPEGENC_Params));
     if (!jpegParams)
-        return AVERROR(ENOMEM);
+        return NULL;
 
     jpegDynParams = av_malloc(sizeof(IJPEGENC_DynamicParams));
     if (!jpegDynParams) {
         av_free(jpegParams);
-        return AVERROR(ENOMEM);
+        return NULL;
     }
 
     *jpegParams = IJPEGENC_PARAMS_DEFAULT;
@@ -210,27 +314,222 @@ static av_cold int jpeg_enc_init(AVCodecContext *avctx)
     dynParams->inputHeight = avctx->height;
     dynParams->captureWidth = avctx->width;
     dynParams->inputChromaFormat = XDM_YUV_420SP;
-    dynParams->qValue = avctx->mpeg_quant;              //XXX: ???
+    dynParams->qValue = quality;
     dynParams->size = sizeof(IJPEGENC_DynamicParams);
 
-    ctx->codecParams = jpegParams;
-    ctx->codecDynParams = jpegDynParams;
-
-    ctx->hEncode = imgenc_create(avctx, ctx->hEngine, "jpegenc1",
-            ctx->codecParams, ctx->codecDynParams);
-    if (!ctx->hEncode) {
+    hEncode = imgenc_create(avctx, ctx->hEngine, "jpegenc1",
+            (IMGENC1_Params *) jpegParams, (IMGENC1_DynamicParams *) jpegDynParams);
+    if (!hEncode) {
         av_log(avctx, AV_LOG_ERROR, "Cannot create jpeg encoder\n");
-        av_freep(&ctx->codecParams);
-        av_freep(&ctx->codecDynParams);
+        av_free(jpegParams);
+        av_free(jpegDynParams);
+        return NULL;
+    }
+
+    *params = jpegParams;
+    *dynamicParams = jpegDynParams;
+    return hEncode;
+}
+
+/* encodes an NV12 picture in CMEM, returns the number of bytes written */
+static int jpeg_encode(AVCodecContext *avctx, IMGENC1_Handle hEncode,
+        IIMGENC1_DynamicParams *dynParams, const AVFrame *pic,
+        uint8_t *buf, int buf_size)
+{
+    XDM1_BufDesc inBufs;
+    XDM1_BufDesc outBufs;
+    IMGENC1_InArgs inArgs;
+    IMGENC1_OutArgs outArgs;
+    XDAS_Int32 status;
+
+    /* as with the video encoders, the pitch is set through XDM_SETPARAMS */
+    if (pic->linesize[0] != dynParams->captureWidth) {
+        IMGENC1_Status encStatus;
+        int tmp = dynParams->captureWidth;
+
+        encStatus.size = sizeof(IMGENC1_Status);
+        encStatus.data.buf = NULL;
+
+        dynParams->captureWidth = pic->linesize[0];
+
+        ff_dm365_engine_lock();
+        status = IMGENC1_control(hEncode, XDM_SETPARAMS,
+                (IMGENC1_DynamicParams *) dynParams, &encStatus);
+        ff_dm365_engine_unlock();
+        if (status != IMGENC1_EOK) {
+            DM365_JPEGENC_ERROR err = encStatus.extendedError & 0xff;
+            av_log(avctx, AV_LOG_ERROR, "extended error: %x\n", err);
+            dynParams->captureWidth = tmp;
+            return -1;
+        }
+    }
+
+    /* TODO: only for NV12 */
+    inBufs.descs[0].buf = pic->data[0];
+    inBufs.descs[1].buf = pic->data[1];
+    inBufs.descs[0].bufSize = pic->linesize[0] * avctx->height;
+    inBufs.descs[1].bufSize = pic->linesize[1] * avctx->height/2;
+    inBufs.numBufs = 2;
+
+    outBufs.numBufs = 1;
+    outBufs.descs[0].buf = buf;
+    outBufs.descs[0].bufSize = buf_size;
+
+    inArgs.size = sizeof(IMGENC1_InArgs);
+    outArgs.size = sizeof(IMGENC1_OutArgs);
+
+    ff_dm365_engine_lock();
+    status = IMGENC1_process(hEncode, &inBufs, &outBufs, &inArgs, &outArgs);
+    ff_dm365_engine_unlock();
+    if (status != IMGENC1_EOK) {
+        DM365_JPEGENC_ERROR err = outArgs.extendedError & 0xff;
+        av_log(avctx, AV_LOG_ERROR, "encoding error: %x\n", err);
         return -1;
     }
 
+    av_log(avctx, AV_LOG_DEBUG, "bytes generated: %d\n", (int) outArgs.bytesGenerated);
+
+    return outArgs.bytesGenerated;
+}
+
+static av_cold int jpeg_enc_init(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    int quality;
+
+    if (avctx->pix_fmt != PIX_FMT_NV12) {
+        av_log(avctx, AV_LOG_INFO, "unsupported pixel format\n");
+        return -1;
+    }
+
+    /* quality factor 1..100, derived from -qscale if given */
+    if (avctx->flags & CODEC_FLAG_QSCALE)
+        quality = av_clip(100 - (avctx->global_quality / FF_QP2LAMBDA - 1) * 100 / 30, 1, 100);
+    else
+        quality = Ienc1_DynamicParams_DEFAULT.qValue;
+
+    ctx->hEncode = jpeg_create(avctx, quality, &ctx->codecParams,
+            &ctx->codecDynParams);
+    if (!ctx->hEncode)
+        return -1;
+
     return 0;
 }
+
+static av_cold int snapshot_init(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+
+    if (!ctx->snapshot_interval || avctx->codec_id == CODEC_ID_MJPEG)
+        return 0;
+
+    ctx->hSnapshot = jpeg_create(avctx, ctx->snapshot_quality,
+            &ctx->snapParams, &ctx->snapDynParams);
+    if (!ctx->hSnapshot)
+        return -1;
+
+    return 0;
+}
+
+static av_cold void snapshot_close(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+
+    av_free_packet(&ctx->snapshot);
+    if (!ctx->hSnapshot)
+        return;
+
+    ff_dm365_engine_lock();
+    IMGENC1_delete(ctx->hSnapshot);
+    ff_dm365_engine_unlock();
+    ctx->hSnapshot = NULL;
+    av_freep(&ctx->snapParams);
+    av_freep(&ctx->snapDynParams);
+}
 #else
 static av_cold int jpeg_enc_init(AVCodecContext *avctx) { return -1; }
+
+static av_cold int snapshot_init(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+
+    if (ctx->snapshot_interval)
+        av_log(avctx, AV_LOG_WARNING, "snapshots need the libdm365_jpeg encoder\n");
+    return 0;
+}
+
+static av_cold void snapshot_close(AVCodecContext *avctx) { }
 #endif
 
+static av_cold void mb_info_close(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        av_freep(&ctx->mb_mv[i]);
+        av_freep(&ctx->mb_sad[i]);
+    }
+    if (ctx->mb_buf) {
+        CMEM_free(ctx->mb_buf, &alloc_params);
+        CMEM_exit();
+        ctx->mb_buf = NULL;
+    }
+}
+
+/* NV12 picture in CMEM with the pitch and height the codecs work with */
+static av_cold int alloc_cmem_frame(AVCodecContext *avctx, AVFrame *f)
+{
+    int linesize = FFALIGN(avctx->width, 32);
+    int height = FFALIGN(avctx->height, 16);
+
+    f->data[0] = CMEM_alloc(linesize * height * 3 / 2, &alloc_params);
+    if (!f->data[0])
+        return AVERROR(ENOMEM);
+    f->data[1] = f->data[0] + linesize * height;
+    f->linesize[0] = linesize;
+    f->linesize[1] = linesize;
+    memset(f->data[0], 0, linesize * height);
+    memset(f->data[1], 128, linesize * height / 2);
+    return 0;
+}
+
+static void copy_picture(AVCodecContext *avctx, AVFrame *dst, const AVFrame *src)
+{
+    /* av_image_copy() wants an array of pointers to const planes */
+    const uint8_t *data[4] = { src->data[0], src->data[1], src->data[2], src->data[3] };
+
+    av_image_copy(dst->data, dst->linesize, data, src->linesize,
+                  avctx->pix_fmt, avctx->width, avctx->height);
+}
+
+/*
+ * pictures in registered CMEM buffers, e.g. from a libdm365 decoder, are
+ * read by the codec in place, all others are copied into CMEM first
+ */
+static const AVFrame *input_picture(AVCodecContext *avctx, const AVFrame *pic)
+{
+    DM365Context *ctx = avctx->priv_data;
+    AVFrame *f = &ctx->staging;
+
+    if (ff_dm365_is_cmem_picture(pic, avctx->height))
+        return pic;
+
+    if (!f->data[0]) {
+        av_log(avctx, AV_LOG_VERBOSE, "input pictures are not in CMEM, copying\n");
+        CMEM_init();
+        if (alloc_cmem_frame(avctx, f) < 0) {
+            CMEM_exit();
+            return NULL;
+        }
+    }
+
+    copy_picture(avctx, f, pic);
+    f->pts       = pic->pts;
+    f->pict_type = pic->pict_type;
+    return f;
+}
+
 #if CONFIG_LIBDM365_H264_ENCODER || CONFIG_LIBDM365_MPEG4_ENCODER
 static VIDENC1_Handle encoder_create(AVCodecContext *avctx, Engine_Handle hEngine,
         const char *encoder, VIDENC1_Params *params, VIDENC1_DynamicParams *dynParams)
@@ -239,18 +538,24 @@ static VIDENC1_Handle encoder_create(AVCodecContext *avctx, Engine_Handle hEngin
     VIDENC1_Status encStatus;
     XDAS_Int32 status;
 
-    hEncode = VIDENC1_create(hEngine, (String) encoder, params);
+    ff_dm365_engine_lock();
+    hEncode = VIDENC1_create(hEngine, ff_dm365_codec_name(encoder), params);
+    ff_dm365_engine_unlock();
     if (hEncode == 0)
         return NULL;
 
     encStatus.size = sizeof(VIDENC1_Status);
     encStatus.data.buf = NULL;
 
+    ff_dm365_engine_lock();
     status = VIDENC1_control(hEncode, XDM_SETPARAMS, dynParams, &encStatus);
+    ff_dm365_engine_unlock();
     if (status != VIDENC1_EOK) {
         IH264VENC_STATUS err = encStatus.extendedError;
         av_log(avctx, AV_LOG_ERROR, "extended error: %x\n", err);
+        ff_dm365_engine_lock();
         VIDENC1_delete(hEncode);
+        ff_dm365_engine_unlock();
         return NULL;
     }
 
@@ -258,7 +563,218 @@ static VIDENC1_Handle encoder_create(AVCodecContext *avctx, Engine_Handle hEngin
 }
 #endif
 
+#if CONFIG_LIBDM365_H264_ENCODER || CONFIG_LIBDM365_MPEG4_ENCODER
+/* frame rate in frames per 1000 seconds, as used by the VIDENC1 interface */
+static int videnc_frame_rate(AVRational rate)
+{
+    if (rate.num <= 0 || rate.den <= 0)
+        return 0;
+    return av_rescale(rate.num, 1000, rate.den);
+}
+
+static av_cold void videnc_init_rate_params(AVCodecContext *avctx,
+        IVIDENC1_Params *encParams, IVIDENC1_DynamicParams *dynParams)
+{
+    int rate = videnc_frame_rate((AVRational){ avctx->time_base.den, avctx->time_base.num });
+
+    /* the bitrate may be raised up to maxBitRate later on */
+    if (avctx->rc_max_rate > 0)
+        encParams->maxBitRate = avctx->rc_max_rate;
+    encParams->maxBitRate = FFMAX(encParams->maxBitRate, avctx->bit_rate);
+    if (rate > 0 && rate <= 120000)
+        encParams->maxFrameRate = rate;
+
+    dynParams->targetBitRate      = avctx->bit_rate;
+    dynParams->refFrameRate       = encParams->maxFrameRate;
+    dynParams->targetFrameRate    = encParams->maxFrameRate;
+    dynParams->intraFrameInterval = avctx->gop_size;
+}
+
+/*
+ * the codec spends more bits on foreground regions and less on background
+ * regions, the magnitude of the QP offset gives the priority of the region
+ */
+static void update_roi(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    IH264VENC_DynamicParams *h264DynParams = ctx->codecDynParams;
+    ROI_Interface *roi = &ctx->roi;
+    int i;
+
+    roi->numOfROI = 0;
+    for (i = 0; i < ctx->nb_roi_next; i++) {
+        const AVDM365ROI *r = &ctx->roi_next[i];
+        int x0 = av_clip(r->x, 0, avctx->width);
+        int y0 = av_clip(r->y, 0, avctx->height);
+        int x1 = av_clip(r->x + r->w, 0, avctx->width);
+        int y1 = av_clip(r->y + r->h, 0, avctx->height);
+        int n = roi->numOfROI;
+
+        if (x1 <= x0 || y1 <= y0 || !r->qp_offset)
+            continue;
+        roi->listROI[n].topLeft.x     = x0;
+        roi->listROI[n].topLeft.y     = y0;
+        roi->listROI[n].bottomRight.x = x1 - 1;
+        roi->listROI[n].bottomRight.y = y1 - 1;
+        roi->roiType[n]     = r->qp_offset < 0 ? FOREGROUND_OBJECT : BACKGROUND_OBJECT;
+        roi->roiPriority[n] = FFABS(r->qp_offset);
+        roi->numOfROI++;
+    }
+
+    /* ROI coding is enabled on first use, an empty list codes the picture
+     * uniformly again */
+    if (roi->numOfROI && !h264DynParams->enableROI) {
+        h264DynParams->enableROI = 1;
+        ctx->params_changed = 1;
+    }
+}
+
+/*
+ * pick up the rate control settings changed by the application since the
+ * previous picture, the hardware is reconfigured by videnc_encode()
+ */
+static void videnc_update_params(AVCodecContext *avctx, const AVFrame *pic)
+{
+    DM365Context *ctx = avctx->priv_data;
+    IVIDENC1_Params *encParams = ctx->codecParams;
+    IVIDENC1_DynamicParams *dynParams = ctx->codecDynParams;
+    int bit_rate = FFMIN(avctx->bit_rate, encParams->maxBitRate);
+    int frame_rate = videnc_frame_rate(ctx->target_fps);
+    int qmin = avctx->qmin, qmax = avctx->qmax;
+
+    if (frame_rate <= 0 || frame_rate > dynParams->refFrameRate)
+        frame_rate = dynParams->refFrameRate;
+
+    if (bit_rate != dynParams->targetBitRate && bit_rate != avctx->bit_rate)
+        av_log(avctx, AV_LOG_WARNING, "bitrate %d is above the maximum %d\n",
+               avctx->bit_rate, (int) encParams->maxBitRate);
+
+    if (bit_rate != dynParams->targetBitRate ||
+        frame_rate != dynParams->targetFrameRate ||
+        avctx->gop_size != dynParams->intraFrameInterval) {
+        dynParams->targetBitRate      = bit_rate;
+        dynParams->targetFrameRate    = frame_rate;
+        dynParams->intraFrameInterval = avctx->gop_size;
+        ctx->params_changed = 1;
+    }
+
+    if (avctx->codec_id == CODEC_ID_H264) {
+        IH264VENC_DynamicParams *h264DynParams = ctx->codecDynParams;
+
+        qmin = av_clip(qmin, 0, 51);
+        qmax = av_clip(qmax, qmin, 51);
+        if (h264DynParams->idrFrameInterval != avctx->gop_size ||
+            h264DynParams->rcQMin != qmin || h264DynParams->rcQMax != qmax) {
+            h264DynParams->idrFrameInterval = avctx->gop_size;
+            h264DynParams->rcQMin = qmin;
+            h264DynParams->rcQMax = qmax;
+            ctx->params_changed = 1;
+        }
+
+        update_roi(avctx);
+    } else {
+        IMP4VENC_DynamicParams *mpeg4DynParams = ctx->codecDynParams;
+
+        qmin = av_clip(qmin, 1, 31);
+        qmax = av_clip(qmax, qmin, 31);
+        if (mpeg4DynParams->rcQMin != qmin || mpeg4DynParams->rcQMax != qmax) {
+            mpeg4DynParams->rcQMin = qmin;
+            mpeg4DynParams->rcQMax = qmax;
+            ctx->params_changed = 1;
+        }
+    }
+
+    /* a forced intra picture is requested by the application either through
+     * the force_idr option or with the picture type of the frame */
+    if (ctx->force_idr || pic->pict_type == AV_PICTURE_TYPE_I) {
+        dynParams->forceFrame = avctx->codec_id == CODEC_ID_H264 ?
+                                IVIDEO_IDR_FRAME : IVIDEO_I_FRAME;
+        ctx->force_idr = 0;
+        ctx->params_changed = 1;
+    }
+}
+#endif
+
 #if CONFIG_LIBDM365_H264_ENCODER
+/*
+ * the codec writes 8 bytes per macroblock in raster order: horizontal and
+ * vertical motion vector in quarter pels as 16 bit values, then the 32 bit
+ * luma SAD of the chosen prediction
+ */
+#define MB_INFO_SIZE 8
+
+static av_cold int mb_info_init(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    int mbs = ((avctx->width + 15) >> 4) * ((avctx->height + 15) >> 4);
+    int i;
+
+    CMEM_init();
+    ctx->mb_buf_size = mbs * MB_INFO_SIZE;
+    ctx->mb_buf = CMEM_alloc(ctx->mb_buf_size, &alloc_params);
+    if (!ctx->mb_buf) {
+        CMEM_exit();
+        return AVERROR(ENOMEM);
+    }
+
+    for (i = 0; i < 2; i++) {
+        ctx->mb_mv[i]  = av_mallocz(mbs * sizeof(*ctx->mb_mv[i]));
+        ctx->mb_sad[i] = av_mallocz(mbs * sizeof(*ctx->mb_sad[i]));
+        if (!ctx->mb_mv[i] || !ctx->mb_sad[i]) {
+            mb_info_close(avctx);
+            return AVERROR(ENOMEM);
+        }
+    }
+
+    return 0;
+}
+
+/* converts the codec output into the set not returned by the last call */
+static void mb_info_export(AVCodecContext *avctx, AVFrame *coded)
+{
+    DM365Context *ctx = avctx->priv_data;
+    const uint8_t *src = ctx->mb_buf;
+    int mbs = ctx->mb_buf_size / MB_INFO_SIZE;
+    int set = ctx->mb_set ^= 1;
+    int i;
+
+    for (i = 0; i < mbs; i++, src += MB_INFO_SIZE) {
+        ctx->mb_mv[set][i][0] = AV_RL16(src);
+        ctx->mb_mv[set][i][1] = AV_RL16(src + 2);
+        ctx->mb_sad[set][i]   = AV_RL32(src + 4);
+    }
+
+    coded->motion_val[0] = ctx->mb_mv[set];
+    coded->motion_subsample_log2 = 4;
+}
+
+static av_cold int parse_roi(AVCodecContext *avctx, const char *str)
+{
+    DM365Context *ctx = avctx->priv_data;
+    AVDM365ROI *r;
+
+    ctx->nb_roi_next = 0;
+    while (*str) {
+        int n = 0;
+
+        if (ctx->nb_roi_next == AV_DM365_MAX_ROI) {
+            av_log(avctx, AV_LOG_ERROR, "at most %d regions of interest\n",
+                   AV_DM365_MAX_ROI);
+            return -1;
+        }
+        r = &ctx->roi_next[ctx->nb_roi_next];
+        if (sscanf(str, "%d,%d,%d,%d,%d%n", &r->x, &r->y, &r->w, &r->h,
+                   &r->qp_offset, &n) < 5 || (str[n] && str[n] != '|')) {
+            av_log(avctx, AV_LOG_ERROR, "invalid region of interest '%s'\n", str);
+            return -1;
+        }
+        ctx->nb_roi_next++;
+        str += n + !!str[n];
+    }
+
+    return 0;
+}
+
 static av_cold int h264_enc_init(AVCodecContext *avctx)
 {
     DM365Context *ctx = avctx->priv_data;
@@ -293,17 +809,13 @@ static av_cold int h264_enc_init(AVCodecContext *avctx)
     encParams->encodingPreset  = XDM_HIGH_SPEED;
     encParams->inputChromaFormat = XDM_YUV_420SP;
     encParams->rateControlPreset = IVIDEO_NONE;
-    encParams->maxBitRate = 200000;
     encParams->size = sizeof(IH264VENC_Params);
 
-    dynParams->targetBitRate   = encParams->maxBitRate;
+    videnc_init_rate_params(avctx, encParams, dynParams);
     dynParams->inputWidth      = avctx->width;
     dynParams->inputHeight     = avctx->height;
     dynParams->captureWidth    = avctx->width;
-    dynParams->refFrameRate    = 30000;
-    dynParams->targetFrameRate = 30000;
     dynParams->interFrameInterval = 0;
-    dynParams->intraFrameInterval = avctx->gop_size;
     dynParams->size = sizeof(IH264VENC_DynamicParams);
 
     h264Params->enableVUIparams = 0x04;
@@ -315,11 +827,37 @@ static av_cold int h264_enc_init(AVCodecContext *avctx)
     h246DynParams->VUI_Buffer->fixedFrameRateFlag = 1;
     h246DynParams->enablePicTimSEI = 1;
     h246DynParams->idrFrameInterval = dynParams->intraFrameInterval;
-    h246DynParams->rcQMax = avctx->qmax;
-    h246DynParams->rcQMin = avctx->qmin;
+    h246DynParams->rcQMax = av_clip(avctx->qmax, 0, 51);
+    h246DynParams->rcQMin = av_clip(avctx->qmin, 0, h246DynParams->rcQMax);
     h246DynParams->aspectRatioX = avctx->sample_aspect_ratio.num ? avctx->sample_aspect_ratio.num : 1;
     h246DynParams->aspectRatioY = avctx->sample_aspect_ratio.den ? avctx->sample_aspect_ratio.den : 1;
 
+    /* as with the mpegvideo encoders, -ps limits the size of the slices and
+     * rtp_callback gets each slice as soon as it is coded */
+    if (avctx->rtp_payload_size > 0) {
+        h264Params->sliceMode = IH264VENC_SLICEMODE_BYTES;
+        h246DynParams->sliceSize = avctx->rtp_payload_size;
+        if (avctx->rtp_callback) {
+            h264Params->outputDataMode = IH264VENC_TI_SLICEMODE;
+            ctx->slice_output = 1;
+        }
+    }
+
+    if (ctx->roi_str && parse_roi(avctx, ctx->roi_str) < 0) {
+        av_free(h264Params);
+        av_free(h246DynParams);
+        return AVERROR(EINVAL);
+    }
+
+    if (ctx->mb_info) {
+        if (mb_info_init(avctx) < 0) {
+            av_free(h264Params);
+            av_free(h246DynParams);
+            return AVERROR(ENOMEM);
+        }
+        h246DynParams->mvSADoutFlag = 1;
+    }
+
     ctx->codecParams = h264Params;
     ctx->codecDynParams = h246DynParams;
 
@@ -329,6 +867,7 @@ static av_cold int h264_enc_init(AVCodecContext *avctx)
         av_log(avctx, AV_LOG_ERROR, "Cannot create encoder\n");
         av_freep(&ctx->codecParams);
         av_freep(&ctx->codecDynParams);
+        mb_info_close(avctx);
         return -1;
     }
 
@@ -339,9 +878,10 @@ static av_cold int h264_enc_init(AVCodecContext *avctx)
 }
 #else
 static av_cold int h264_enc_init(AVCodecContext *avctx) { return -1; }
+static void mb_info_export(AVCodecContext *avctx, AVFrame *coded) { }
 #endif
 
-#if CONFIG_LIBDM365_H264_ENCODER
+#if CONFIG_LIBDM365_MPEG4_ENCODER
 static av_cold int mpeg4_enc_init(AVCodecContext *avctx)
 {
     DM365Context *ctx = avctx->priv_data;
@@ -376,24 +916,20 @@ static av_cold int mpeg4_enc_init(AVCodecContext *avctx)
     encParams->encodingPreset  = XDM_HIGH_SPEED;
     encParams->inputChromaFormat = XDM_YUV_420SP;
     encParams->rateControlPreset = IVIDEO_NONE;
-    encParams->maxBitRate = avctx->bit_rate * 3/2;
     encParams->size = sizeof(IMP4VENC_Params);
 
-    dynParams->targetBitRate   = avctx->bit_rate;
+    videnc_init_rate_params(avctx, encParams, dynParams);
     dynParams->inputWidth      = avctx->width;
     dynParams->inputHeight     = avctx->height;
     dynParams->captureWidth    = avctx->width;
-    dynParams->refFrameRate    = 30000;
-    dynParams->targetFrameRate = 30000;
     dynParams->interFrameInterval = 0;
-    dynParams->intraFrameInterval = avctx->gop_size;
     dynParams->size = sizeof(IMP4VENC_DynamicParams);
 
     mpeg4Params->subWindowWidth = avctx->width;
     mpeg4Params->subWindowHeight = avctx->height;
 
-    mpeg4DynParams->rcQMax = avctx->qmax;
-    mpeg4DynParams->rcQMax = avctx->qmin;
+    mpeg4DynParams->rcQMax = av_clip(avctx->qmax, 1, 31);
+    mpeg4DynParams->rcQMin = av_clip(avctx->qmin, 1, mpeg4DynParams->rcQMax);
 
     ctx->codecParams = mpeg4Params;
     ctx->codecDynParams = mpeg4DynParams;
@@ -413,79 +949,31 @@ static av_cold int mpeg4_enc_init(AVCodecContext *avctx)
 static av_cold int mpeg4_enc_init(AVCodecContext *avctx) { return -1; }
 #endif
 
-static av_cold int dm365_encode_init(AVCodecContext *avctx)
-{
-    DM365Context *ctx = avctx->priv_data;
-    int ret;
-
-    /*
-     * CERuntime_init() has to be called from main application
-     * as well as CERuntime_exit(). Otherwise other dm365 codec
-     * initialization or deinitialization could break everything
-     */
-
-    ctx->hEngine = Engine_open("encode", NULL, NULL);
-    if (ctx->hEngine == NULL)
-        return AVERROR(1);
-
-    switch (avctx->codec_id) {
-    case CODEC_ID_H264:
-        ret = h264_enc_init(avctx);
-        break;
-    case CODEC_ID_MPEG4:
-        ret = mpeg4_enc_init(avctx);
-        break;
-    case CODEC_ID_MJPEG:
-        ret = jpeg_enc_init(avctx);
-        break;
-    default:
-        ret = -1;
-        break;
-    }
-
-    if (ret < 0) {
-        Engine_close(ctx->hEngine);
-        return ret;
-    }
-
-    avctx->coded_frame = &ctx->image;
-
-    return 0;
-}
-
-static av_cold int dm365_encode_close(AVCodecContext *avctx)
-{
-    DM365Context *ctx = avctx->priv_data;
-
-    if (avctx->codec_id == CODEC_ID_MJPEG)
-        IMGENC1_delete(ctx->hEncode);
-    else
-        VIDENC1_delete(ctx->hEncode);
-    av_free(ctx->codecDynParams);
-    av_free(ctx->codecParams);
-    Engine_close(ctx->hEngine);
-
-    return 0;
-}
-
 #if CONFIG_LIBDM365_H264_ENCODER || CONFIG_LIBDM365_MPEG4_ENCODER
-static int dm365_videnc_process(AVCodecContext *avctx, uint8_t *buf, int buf_size, void *data)
+/*
+ * encode one picture, the type of the coded picture is stored to coded
+ */
+static int videnc_encode(AVCodecContext *avctx, const AVFrame *pic,
+        uint8_t *buf, int buf_size, AVFrame *coded)
 {
     DM365Context *ctx = avctx->priv_data;
     IVIDEO1_BufDescIn inBufDesc;
     XDM_BufDesc outBufDesc;
-    XDAS_Int32 outBufSizeArray[1];
-    VIDENC1_InArgs inArgs;
+    XDAS_Int32 outBufSizeArray[2];
+    XDAS_Int8 *outBufPtrArray[2];
+    IH264VENC_InArgs h264InArgs;
+    VIDENC1_InArgs *inArgs = &h264InArgs.videncInArgs;
     VIDENC1_OutArgs outArgs;
     XDAS_Int32 status;
-    AVFrame *pic = (AVFrame *)data;
     IVIDENC1_DynamicParams *dynParams = (IVIDENC1_DynamicParams *) ctx->codecDynParams;
     int frameWidth;
     int frameHeight;
+    uint8_t *out;
+    int size = 0;
 
     /* inBufDesc.framePitch field is not used in encoder,
      * different pitch has to be specified through XDM_SETPARAMS */
-    if (pic->linesize[0] != dynParams->captureWidth) {
+    if (pic->linesize[0] != dynParams->captureWidth || ctx->params_changed) {
         VIDENC1_Status encStatus;
         int tmp = dynParams->captureWidth;
 
@@ -493,12 +981,16 @@ static int dm365_videnc_process(AVCodecContext *avctx, uint8_t *buf, int buf_siz
         encStatus.data.buf = NULL;
 
         dynParams->captureWidth = pic->linesize[0];
+        ctx->params_changed = 0;
 
+        ff_dm365_engine_lock();
         status = VIDENC1_control(ctx->hEncode, XDM_SETPARAMS, dynParams, &encStatus);
+        ff_dm365_engine_unlock();
         if (status != VIDENC1_EOK) {
             IH264VENC_STATUS err = encStatus.extendedError;
             av_log(avctx, AV_LOG_ERROR, "extended error: %x\n", err);
             dynParams->captureWidth = tmp;
+            dynParams->forceFrame = IVIDEO_NA_FRAME;
             return -1;
         }
     }
@@ -517,87 +1009,482 @@ static int dm365_videnc_process(AVCodecContext *avctx, uint8_t *buf, int buf_siz
 
     inBufDesc.numBufs = 2;
 
-    outBufSizeArray[0] = buf_size;
-    outBufDesc.numBufs = 1;
-    outBufDesc.bufs = (XDAS_Int8 **) &buf;
+    /* motion vectors and SAD go into a second output buffer */
+    outBufDesc.numBufs = ctx->mb_buf ? 2 : 1;
+    outBufDesc.bufs = outBufPtrArray;
     outBufDesc.bufSizes = outBufSizeArray;
-
-    inArgs.size = sizeof(VIDENC1_InArgs);
-    inArgs.inputID = 1;
-    inArgs.topFieldFirstFlag = 1;
+    outBufPtrArray[1] = (XDAS_Int8 *) ctx->mb_buf;
+    outBufSizeArray[1] = ctx->mb_buf_size;
+
+    inArgs->size = sizeof(VIDENC1_InArgs);
+    inArgs->inputID = 1;
+    inArgs->topFieldFirstFlag = 1;
+
+    /* the regions of interest are passed with the extended h264 arguments */
+    if (avctx->codec_id == CODEC_ID_H264) {
+        inArgs->size = sizeof(IH264VENC_InArgs);
+        h264InArgs.timeStamp          = 0;
+        h264InArgs.insertUserData     = 0;
+        h264InArgs.lengthUserData     = 0;
+        h264InArgs.roiParameters      = ctx->roi;
+        h264InArgs.numOutputDataUnits = 0;
+    }
 
     outArgs.size = sizeof(VIDENC1_OutArgs);
 
-    status = VIDENC1_process(ctx->hEncode, &inBufDesc, &outBufDesc,
-            (VIDENC1_InArgs *) &inArgs, &outArgs);
-    if (status != VIDENC1_EOK) {
-        IH264VENC_STATUS err = outArgs.extendedError;
-        av_log(avctx, AV_LOG_ERROR, "encoding error: %x\n", err);
-        return -1;
-    }
+    /* in slice output mode every call returns the next slice, the input
+     * is released together with the last slice of the picture */
+    do {
+        out = buf + size;
+        outBufPtrArray[0] = (XDAS_Int8 *) out;
+        outBufSizeArray[0] = buf_size - size;
+
+        ff_dm365_engine_lock();
+        status = VIDENC1_process(ctx->hEncode, &inBufDesc, &outBufDesc,
+                inArgs, &outArgs);
+        ff_dm365_engine_unlock();
+
+        /* forceFrame stays in effect until it is cleared */
+        if (dynParams->forceFrame != IVIDEO_NA_FRAME) {
+            dynParams->forceFrame = IVIDEO_NA_FRAME;
+            ctx->params_changed = 1;
+        }
+        if (status != VIDENC1_EOK) {
+            IH264VENC_STATUS err = outArgs.extendedError;
+            av_log(avctx, AV_LOG_ERROR, "encoding error: %x\n", err);
+            return -1;
+        }
 
-    av_log(avctx, AV_LOG_DEBUG, "bytes generated: %d\n", (int) outArgs.bytesGenerated);
+        if (ctx->slice_output && avctx->rtp_callback)
+            avctx->rtp_callback(avctx, out, outArgs.bytesGenerated, 0);
+        size += outArgs.bytesGenerated;
+
+        /* do not spin on a codec which neither progresses nor finishes */
+        if (ctx->slice_output && outArgs.outputID != inArgs->inputID) {
+            if (!outArgs.bytesGenerated) {
+                av_log(avctx, AV_LOG_ERROR, "codec returned an empty slice\n");
+                return -1;
+            }
+            if (size >= buf_size) {
+                av_log(avctx, AV_LOG_ERROR, "output buffer full before the "
+                       "last slice of the picture\n");
+                return -1;
+            }
+        }
+    } while (ctx->slice_output && outArgs.outputID != inArgs->inputID);
 
-    ctx->image.key_frame = 0;
+    av_log(avctx, AV_LOG_DEBUG, "bytes generated: %d\n", size);
+
+    if (ctx->mb_buf)
+        mb_info_export(avctx, coded);
+
+    coded->key_frame = 0;
     switch (outArgs.encodedFrameType) {
     case IVIDEO_I_FRAME:
-        if (avctx->codec_type != CODEC_ID_H264)
-            ctx->image.key_frame = 1;
-        ctx->image.type = AV_PICTURE_TYPE_I;
+        if (avctx->codec_id != CODEC_ID_H264)
+            coded->key_frame = 1;
+        coded->pict_type = AV_PICTURE_TYPE_I;
         break;
     case IVIDEO_IDR_FRAME:
-        ctx->image.key_frame = 1;
-        ctx->image.type = AV_PICTURE_TYPE_I;
+        coded->key_frame = 1;
+        coded->pict_type = AV_PICTURE_TYPE_I;
         break;
     case IVIDEO_P_FRAME:
-        ctx->image.type = AV_PICTURE_TYPE_P;
+        coded->pict_type = AV_PICTURE_TYPE_P;
         break;
     default:
-        ctx->image.type = AV_PICTURE_TYPE_NONE;
+        coded->pict_type = AV_PICTURE_TYPE_NONE;
         av_log(avctx, AV_LOG_WARNING, "unknown picture type\n");
         break;
     }
 
-    return outArgs.bytesGenerated;
+    return size;
+}
+
+/*
+ * encodes every snapshot_interval-th picture into a new CMEM packet, the
+ * picture is read from the same buffer as by the video encoder
+ */
+static void videnc_snapshot(AVCodecContext *avctx, const AVFrame *pic)
+{
+#if CONFIG_LIBDM365_JPEG_ENCODER
+    DM365Context *ctx = avctx->priv_data;
+    AVPacket pkt;
+    int ret;
+
+    if (!ctx->hSnapshot || ctx->snapshot_count++ % ctx->snapshot_interval)
+        return;
+
+    if (av_dm365_new_packet(&pkt, FFALIGN(avctx->width, 16) *
+                            FFALIGN(avctx->height, 16) * 2 + 1024) < 0) {
+        av_log(avctx, AV_LOG_ERROR, "cannot allocate snapshot packet\n");
+        return;
+    }
+
+    ret = jpeg_encode(avctx, ctx->hSnapshot, ctx->snapDynParams, pic,
+            pkt.data, pkt.size);
+    if (ret <= 0) {
+        av_free_packet(&pkt);
+        return;
+    }
+    av_shrink_packet(&pkt, ret);
+    pkt.pts    = pic->pts;
+    pkt.flags |= AV_PKT_FLAG_KEY;
+
+    if (ctx->snapshot.data)
+        av_log(avctx, AV_LOG_DEBUG, "dropping snapshot not fetched in time\n");
+    av_free_packet(&ctx->snapshot);
+    ctx->snapshot = pkt;
+#endif
+}
+
+#if HAVE_PTHREADS
+static void *videnc_worker(void *arg)
+{
+    AVCodecContext *avctx = arg;
+    DM365Context *ctx = avctx->priv_data;
+
+    pthread_mutex_lock(&ctx->lock);
+    for (;;) {
+        while (!ctx->busy && !ctx->worker_exit)
+            pthread_cond_wait(&ctx->cond, &ctx->lock);
+        if (ctx->worker_exit)
+            break;
+        pthread_mutex_unlock(&ctx->lock);
+
+        ctx->job_ret = videnc_encode(avctx, ctx->job, ctx->out_buf,
+                ctx->out_buf_size, &ctx->job_coded);
+
+        pthread_mutex_lock(&ctx->lock);
+        ctx->busy = 0;
+        pthread_cond_broadcast(&ctx->cond);
+    }
+    pthread_mutex_unlock(&ctx->lock);
+
+    return NULL;
+}
+
+static void wait_worker(DM365Context *ctx)
+{
+    pthread_mutex_lock(&ctx->lock);
+    while (ctx->busy)
+        pthread_cond_wait(&ctx->cond, &ctx->lock);
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+static av_cold int async_init(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    int i;
+
+    CMEM_init();
+
+    for (i = 0; i < 2; i++) {
+        if (alloc_cmem_frame(avctx, &ctx->in_frames[i]) < 0)
+            goto fail;
+    }
+
+    pthread_mutex_init(&ctx->lock, NULL);
+    pthread_cond_init(&ctx->cond, NULL);
+    if (pthread_create(&ctx->worker, NULL, videnc_worker, avctx)) {
+        pthread_mutex_destroy(&ctx->lock);
+        pthread_cond_destroy(&ctx->cond);
+        goto fail;
+    }
+
+    return 0;
+
+fail:
+    for (i = 0; i < 2; i++) {
+        if (ctx->in_frames[i].data[0])
+            CMEM_free(ctx->in_frames[i].data[0], &alloc_params);
+    }
+    CMEM_exit();
+    return AVERROR(ENOMEM);
+}
+
+static av_cold void async_close(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    int i;
+
+    wait_worker(ctx);
+
+    pthread_mutex_lock(&ctx->lock);
+    ctx->worker_exit = 1;
+    pthread_cond_broadcast(&ctx->cond);
+    pthread_mutex_unlock(&ctx->lock);
+
+    pthread_join(ctx->worker, NULL);
+    pthread_mutex_destroy(&ctx->lock);
+    pthread_cond_destroy(&ctx->cond);
+
+    for (i = 0; i < 2; i++)
+        CMEM_free(ctx->in_frames[i].data[0], &alloc_params);
+    if (ctx->out_buf)
+        CMEM_free(ctx->out_buf, &alloc_params);
+    CMEM_exit();
+}
+
+/*
+ * queue the picture to the worker and return the packet of the previous one,
+ * the copy of the new picture overlaps with the encoding of the previous one
+ */
+static int videnc_process_async(AVCodecContext *avctx, uint8_t *buf,
+        int buf_size, AVFrame *pic)
+{
+    DM365Context *ctx = avctx->priv_data;
+    AVFrame *in = NULL;
+    int ret = 0;
+
+    if (pic) {
+        in = &ctx->in_frames[ctx->next_in];
+        ctx->next_in ^= 1;
+        copy_picture(avctx, in, pic);
+        in->pts = pic->pts;
+    }
+
+    if (ctx->pending) {
+        wait_worker(ctx);
+        ctx->pending = 0;
+
+        ret = ctx->job_ret;
+        if (ret > buf_size) {
+            av_log(avctx, AV_LOG_ERROR, "output buffer too small\n");
+            ret = -1;
+        } else if (ret > 0) {
+            memcpy(buf, ctx->out_buf, ret);
+        }
+        ctx->image.key_frame = ctx->job_coded.key_frame;
+        ctx->image.pict_type = ctx->job_coded.pict_type;
+        ctx->image.pts       = ctx->job_coded.pts;
+        ctx->image.motion_val[0]        = ctx->job_coded.motion_val[0];
+        ctx->image.motion_subsample_log2 = ctx->job_coded.motion_subsample_log2;
+    }
+
+    if (in) {
+        if (ctx->out_buf_size < buf_size) {
+            if (ctx->out_buf)
+                CMEM_free(ctx->out_buf, &alloc_params);
+            ctx->out_buf_size = 0;
+            ctx->out_buf = CMEM_alloc(buf_size, &alloc_params);
+            if (!ctx->out_buf)
+                return AVERROR(ENOMEM);
+            ctx->out_buf_size = buf_size;
+        }
+
+        ctx->job_coded.pts = in->pts;
+        videnc_snapshot(avctx, in);
+        videnc_update_params(avctx, pic);
+
+        pthread_mutex_lock(&ctx->lock);
+        ctx->job  = in;
+        ctx->busy = 1;
+        pthread_cond_broadcast(&ctx->cond);
+        pthread_mutex_unlock(&ctx->lock);
+        ctx->pending = 1;
+    }
+
+    return ret;
+}
+#endif
+
+static int dm365_videnc_process(AVCodecContext *avctx, uint8_t *buf, int buf_size, void *data)
+{
+    DM365Context *ctx = avctx->priv_data;
+    AVFrame *pic = data;
+    const AVFrame *in;
+
+#if HAVE_PTHREADS
+    if (ctx->async)
+        return videnc_process_async(avctx, buf, buf_size, pic);
+#endif
+
+    /* nothing is delayed in synchronous mode */
+    if (!pic)
+        return 0;
+
+    in = input_picture(avctx, pic);
+    if (!in)
+        return AVERROR(ENOMEM);
+
+    ctx->image.pts = pic->pts;
+    videnc_snapshot(avctx, in);
+    videnc_update_params(avctx, pic);
+    return videnc_encode(avctx, in, buf, buf_size, &ctx->image);
+}
+#endif
+
+int av_dm365_get_snapshot(AVCodecContext *avctx, AVPacket *pkt)
+{
+    DM365Context *ctx;
+
+    if (!avctx->codec || avctx->codec->priv_class != &dm365_venc_class)
+        return AVERROR(EINVAL);
+
+    ctx = avctx->priv_data;
+    if (!ctx->snapshot.data)
+        return AVERROR(EAGAIN);
+
+    *pkt = ctx->snapshot;
+    av_init_packet(&ctx->snapshot);
+    ctx->snapshot.data = NULL;
+    ctx->snapshot.size = 0;
+    return 0;
+}
+
+int av_dm365_set_roi(AVCodecContext *avctx, const AVDM365ROI *roi, int nb_roi)
+{
+    DM365Context *ctx;
+
+    if (!avctx->codec || avctx->codec->priv_class != &dm365_venc_class ||
+        avctx->codec_id != CODEC_ID_H264 || nb_roi < 0 || nb_roi > AV_DM365_MAX_ROI)
+        return AVERROR(EINVAL);
+
+    ctx = avctx->priv_data;
+    memcpy(ctx->roi_next, roi, nb_roi * sizeof(*roi));
+    ctx->nb_roi_next = nb_roi;
+    return 0;
+}
+
+const uint32_t *av_dm365_get_mb_sad(AVCodecContext *avctx)
+{
+    DM365Context *ctx;
+
+    if (!avctx->codec || avctx->codec->priv_class != &dm365_venc_class)
+        return NULL;
+
+    ctx = avctx->priv_data;
+    if (!ctx->mb_buf || !ctx->image.motion_val[0])
+        return NULL;
+
+    return ctx->mb_sad[ctx->image.motion_val[0] == ctx->mb_mv[1]];
+}
+
+static av_cold int dm365_encode_close(AVCodecContext *avctx);
+
+static av_cold int dm365_encode_init(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+    int ret;
+
+    /*
+     * CERuntime_init() has to be called from main application
+     * as well as CERuntime_exit(). Otherwise other dm365 codec
+     * initialization or deinitialization could break everything
+     */
+
+    ctx->hEngine = ff_dm365_engine_open(avctx, "encode");
+    if (ctx->hEngine == NULL)
+        return AVERROR(1);
+
+    switch (avctx->codec_id) {
+    case CODEC_ID_H264:
+        ret = h264_enc_init(avctx);
+        break;
+    case CODEC_ID_MPEG4:
+        ret = mpeg4_enc_init(avctx);
+        break;
+    case CODEC_ID_MJPEG:
+        ret = jpeg_enc_init(avctx);
+        break;
+    default:
+        ret = -1;
+        break;
+    }
+
+    if (ret < 0) {
+        ff_dm365_engine_close(ctx->hEngine);
+        return ret;
+    }
+
+    if (ctx->mb_info && !ctx->mb_buf)
+        av_log(avctx, AV_LOG_WARNING, "mb_info is only supported for h264\n");
+    if (ctx->roi_str && avctx->codec_id != CODEC_ID_H264)
+        av_log(avctx, AV_LOG_WARNING, "roi is only supported for h264\n");
+
+    ret = snapshot_init(avctx);
+    if (ret < 0) {
+        /* async_init() has not run yet, there is no thread to stop */
+        ctx->async = 0;
+        dm365_encode_close(avctx);
+        return ret;
+    }
+
+    if (ctx->async && ctx->slice_output) {
+        av_log(avctx, AV_LOG_WARNING, "slice output needs synchronous encoding\n");
+        ctx->async = 0;
+    }
+
+    if (ctx->async) {
+#if HAVE_PTHREADS
+        ret = async_init(avctx);
+        if (ret < 0) {
+            ctx->async = 0;
+            dm365_encode_close(avctx);
+            return ret;
+        }
+#else
+        av_log(avctx, AV_LOG_WARNING, "no thread support, encoding synchronously\n");
+        ctx->async = 0;
+#endif
+    }
+
+    avctx->coded_frame = &ctx->image;
+
+    return 0;
 }
+
+static av_cold int dm365_encode_close(AVCodecContext *avctx)
+{
+    DM365Context *ctx = avctx->priv_data;
+
+#if HAVE_PTHREADS
+    if (ctx->async)
+        async_close(avctx);
 #endif
+    snapshot_close(avctx);
+
+    ff_dm365_engine_lock();
+    if (avctx->codec_id == CODEC_ID_MJPEG)
+        IMGENC1_delete(ctx->hEncode);
+    else
+        VIDENC1_delete(ctx->hEncode);
+    ff_dm365_engine_unlock();
+    av_free(ctx->codecDynParams);
+    av_free(ctx->codecParams);
+    mb_info_close(avctx);
+    if (ctx->staging.data[0]) {
+        CMEM_free(ctx->staging.data[0], &alloc_params);
+        CMEM_exit();
+    }
+    ff_dm365_engine_close(ctx->hEngine);
+
+    return 0;
+}
 
 #if CONFIG_LIBDM365_JPEG_ENCODER
 static int dm365_imgenc_process(AVCodecContext *avctx, uint8_t *buf,
         int buf_size, void *data)
 {
     DM365Context *ctx = avctx->priv_data;
-    XDM1_BufDesc inBufs;
-    XDM1_BufDesc outBufs;
-    IMGENC1_InArgs inArgs;
-    IMGENC1_OutArgs outArgs;
-    XDAS_Int32 status;
     AVFrame *pic = (AVFrame *)data;
+    const AVFrame *in = input_picture(avctx, pic);
+    int ret;
 
-    /* TODO: only for NV12 */
-    inBufs.descs[0].buf = pic->data[0];
-    inBufs.descs[1].buf = pic->data[1];
-    inBufs.descs[0].bufSize = pic->linesize[0] * avctx->height;
-    inBufs.descs[1].bufSize = pic->linesize[1] * avctx->height/2;
-    inBufs.numBufs = 2;
-
-    outBufs.numBufs = 1;
-    outBufs.descs[0].buf = buf;
-    outBufs.descs[0].bufSize = buf_size;
-
-    inArgs.size = sizeof(IMGENC1_InArgs);
-    outArgs.size = sizeof(IMGENC1_OutArgs);
+    if (!in)
+        return AVERROR(ENOMEM);
 
-    status = IMGENC1_process(ctx->hEncode, &inBufs, &outBufs, &inArgs, &outArgs);
-    if (status != IMGENC1_EOK) {
-        DM365_JPEGENC_ERROR err = outArgs.extendedError & 0xff;
-        av_log(avctx, AV_LOG_ERROR, "encoding error: %x\n", err);
-        return -1;
-    }
+    ret = jpeg_encode(avctx, ctx->hEncode, ctx->codecDynParams, in,
+            buf, buf_size);
+    if (ret < 0)
+        return ret;
 
-    av_log(avctx, AV_LOG_DEBUG, "bytes generated: %d\n", (int) outArgs.bytesGenerated);
+    ctx->image.key_frame = 1;
+    ctx->image.pict_type = AV_PICTURE_TYPE_I;
+    ctx->image.pts       = pic->pts;
 
-    return outArgs.bytesGenerated;
+    return ret;
 }
 #endif
 
@@ -611,9 +1498,10 @@ AVCodec ff_libdm365_h264_encoder =
     .init           = dm365_encode_init,
     .close          = dm365_encode_close,
     .encode         = dm365_videnc_process,
-    .capabilities   = CODEC_CAP_EXPERIMENTAL | CODEC_CAP_DR1,
+    .capabilities   = CODEC_CAP_EXPERIMENTAL | CODEC_CAP_DR1 | CODEC_CAP_DELAY,
     .pix_fmts       = (const enum PixelFormat[]) {PIX_FMT_NV12, PIX_FMT_NONE},
     .long_name      = NULL_IF_CONFIG_SMALL("h.264 hardware encoder on dm365 SoC"),
+    .priv_class     = &dm365_venc_class,
 };
 #endif
 
@@ -627,9 +1515,10 @@ AVCodec ff_libdm365_mpeg4_encoder =
     .init           = dm365_encode_init,
     .close          = dm365_encode_close,
     .encode         = dm365_videnc_process,
-    .capabilities   = CODEC_CAP_EXPERIMENTAL | CODEC_CAP_DR1,
+    .capabilities   = CODEC_CAP_EXPERIMENTAL | CODEC_CAP_DR1 | CODEC_CAP_DELAY,
     .pix_fmts       = (const enum PixelFormat[]) {PIX_FMT_NV12, PIX_FMT_NONE},
     .long_name      = NULL_IF_CONFIG_SMALL("mpeg4 hardware encoder on dm365 SoC"),
+    .priv_class     = &dm365_venc_class,
 };
 #endif
 
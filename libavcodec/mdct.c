@@ -31,7 +31,7 @@
  * MDCT/IMDCT transforms.
  */
 
-#if CONFIG_FFT_FLOAT
+#if CONFIG_FFT_FLOAT || CONFIG_FFT_FIXED_32
 #   define RSCALE(x) (x)
 #else
 #   define RSCALE(x) ((x) >> 1)
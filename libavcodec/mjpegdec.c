@@ -795,16 +795,151 @@ static av_always_inline void mjpeg_copy_block(uint8_t *dst, const uint8_t *src,
     }
 }
 
-static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah, int Al,
-                             const uint8_t *mb_bitmask, const AVFrame *reference){
-    int i, mb_x, mb_y;
-    uint8_t* data[MAX_COMPONENTS];
+typedef struct MJpegScan {
+    MJpegDecodeContext *s;
+    int nb_components, Ah, Al;
+    uint8_t *data[MAX_COMPONENTS];
     const uint8_t *reference_data[MAX_COMPONENTS];
     int linesize[MAX_COMPONENTS];
+    GetBitContext *mb_bitmask_gb;
+    GetBitContext end_gb; ///< reader state after the last restart interval
+} MJpegScan;
+
+/**
+ * Decodes the MCUs from start to end of a sequential scan.
+ */
+static int mjpeg_decode_scan_mcus(MJpegDecodeContext *s, MJpegScan *scan, int start, int end){
+    int i, mcu, mb_x, mb_y;
+    const int nb_components = scan->nb_components;
+    const int Ah = scan->Ah, Al = scan->Al;
+    uint8_t * const *data = scan->data;
+    const uint8_t * const *reference_data = scan->reference_data;
+    const int *linesize = scan->linesize;
+
+    mb_x = start % s->mb_width;
+    mb_y = start / s->mb_width;
+    for(mcu = start; mcu < end; mcu++) {
+        const int copy_mb = scan->mb_bitmask_gb && !get_bits1(scan->mb_bitmask_gb);
+
+        if (s->restart_interval && !s->restart_count)
+            s->restart_count = s->restart_interval;
+
+        if(get_bits_count(&s->gb)>s->gb.size_in_bits){
+            av_log(s->avctx, AV_LOG_ERROR, "overread %d\n", get_bits_count(&s->gb) - s->gb.size_in_bits);
+            return -1;
+        }
+        for(i=0;i<nb_components;i++) {
+            uint8_t *ptr;
+            int n, h, v, x, y, c, j;
+            int block_offset;
+            n = s->nb_blocks[i];
+            c = s->comp_index[i];
+            h = s->h_scount[i];
+            v = s->v_scount[i];
+            x = 0;
+            y = 0;
+            for(j=0;j<n;j++) {
+                block_offset = (((linesize[c] * (v * mb_y + y) * 8) +
+                                 (h * mb_x + x) * 8) >> s->avctx->lowres);
+
+                if(s->interlaced && s->bottom_field)
+                    block_offset += linesize[c] >> 1;
+                ptr = data[c] + block_offset;
+                if(!s->progressive) {
+                    if (copy_mb) {
+                        mjpeg_copy_block(ptr, reference_data[c] + block_offset, linesize[c], s->avctx->lowres);
+                    } else {
+                    s->dsp.clear_block(s->block);
+                    if(decode_block(s, s->block, i,
+                                 s->dc_index[i], s->ac_index[i],
+                                 s->quant_matrixes[ s->quant_index[c] ]) < 0) {
+                        av_log(s->avctx, AV_LOG_ERROR, "error y=%d x=%d\n", mb_y, mb_x);
+                        return -1;
+                    }
+                    s->dsp.idct_put(ptr, linesize[c], s->block);
+                    }
+                } else {
+                    int block_idx = s->block_stride[c] * (v * mb_y + y) + (h * mb_x + x);
+                    DCTELEM *block = s->blocks[c][block_idx];
+                    if(Ah)
+                        block[0] += get_bits1(&s->gb) * s->quant_matrixes[ s->quant_index[c] ][0] << Al;
+                    else if(decode_dc_progressive(s, block, i, s->dc_index[i], s->quant_matrixes[ s->quant_index[c] ], Al) < 0) {
+                        av_log(s->avctx, AV_LOG_ERROR, "error y=%d x=%d\n", mb_y, mb_x);
+                        return -1;
+                    }
+                }
+//                    av_log(s->avctx, AV_LOG_DEBUG, "mb: %d %d processed\n", mb_y, mb_x);
+//av_log(NULL, AV_LOG_DEBUG, "%d %d %d %d %d %d %d %d \n", mb_x, mb_y, x, y, c, s->bottom_field, (v * mb_y + y) * 8, (h * mb_x + x) * 8);
+                if (++x == h) {
+                    x = 0;
+                    y++;
+                }
+            }
+        }
+
+        if (s->restart_interval) --s->restart_count;
+        i= 8+((-get_bits_count(&s->gb))&7);
+        if (s->restart_interval && show_bits(&s->gb, i)  == (1<<i)-1){ /* skip RSTn */
+            int pos= get_bits_count(&s->gb);
+            align_get_bits(&s->gb);
+            while(show_bits(&s->gb, 8) == 0xFF)
+                skip_bits(&s->gb, 8);
+            if((get_bits(&s->gb, 8)&0xF8) == 0xD0){
+                for (i=0; i<nb_components; i++) /* reset dc */
+                    s->last_dc[i] = 1024;
+            }else{
+                skip_bits_long(&s->gb, pos - get_bits_count(&s->gb));
+            }
+        }
+
+        if (++mb_x == s->mb_width) {
+            mb_x = 0;
+            mb_y++;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Decodes one restart interval on a private copy of the context, starting
+ * at the RSTn marker found while unescaping the scan.
+ */
+static int mjpeg_decode_scan_segment(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    MJpegScan *scan = arg;
+    MJpegDecodeContext *s = scan->s;
+    MJpegDecodeContext sc = *s;
+    const int nb_mcus = s->mb_width * s->mb_height;
+    const int start = jobnr * s->restart_interval;
+    const int offset = jobnr ? s->rst_offsets[jobnr - 1] : get_bits_count(&s->gb) >> 3;
+    int i, ret;
+
+    init_get_bits(&sc.gb, s->gb.buffer + offset, s->gb.size_in_bits - offset * 8);
+    for (i = 0; i < scan->nb_components; i++)
+        sc.last_dc[i] = 1024;
+    sc.restart_count = 0;
+
+    ret = mjpeg_decode_scan_mcus(&sc, scan, start, FFMIN(start + s->restart_interval, nb_mcus));
+    if (start + s->restart_interval >= nb_mcus)
+        scan->end_gb = sc.gb;
+    return ret;
+}
+
+static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah, int Al,
+                             const uint8_t *mb_bitmask, const AVFrame *reference){
+    int i;
+    MJpegScan scan;
     GetBitContext mb_bitmask_gb;
+    const int nb_mcus = s->mb_width * s->mb_height;
 
+    scan.s             = s;
+    scan.nb_components = nb_components;
+    scan.Ah            = Ah;
+    scan.Al            = Al;
+    scan.mb_bitmask_gb = NULL;
     if (mb_bitmask) {
         init_get_bits(&mb_bitmask_gb, mb_bitmask, s->mb_width*s->mb_height);
+        scan.mb_bitmask_gb = &mb_bitmask_gb;
     }
 
     if(s->flipped && s->avctx->flags & CODEC_FLAG_EMU_EDGE) {
@@ -813,96 +948,46 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah, i
     }
     for(i=0; i < nb_components; i++) {
         int c = s->comp_index[i];
-        data[c] = s->picture_ptr->data[c];
-        reference_data[c] = reference ? reference->data[c] : NULL;
-        linesize[c]=s->linesize[c];
+        scan.data[c] = s->picture_ptr->data[c];
+        scan.reference_data[c] = reference ? reference->data[c] : NULL;
+        scan.linesize[c]=s->linesize[c];
         s->coefs_finished[c] |= 1;
         if(s->flipped) {
             //picture should be flipped upside-down for this codec
-            int offset = (linesize[c] * (s->v_scount[i] * (8 * s->mb_height -((s->height/s->v_max)&7)) - 1 ));
-            data[c] += offset;
-            reference_data[c] += offset;
-            linesize[c] *= -1;
+            int offset = (scan.linesize[c] * (s->v_scount[i] * (8 * s->mb_height -((s->height/s->v_max)&7)) - 1 ));
+            scan.data[c] += offset;
+            scan.reference_data[c] += offset;
+            scan.linesize[c] *= -1;
         }
     }
 
-    for(mb_y = 0; mb_y < s->mb_height; mb_y++) {
-        for(mb_x = 0; mb_x < s->mb_width; mb_x++) {
-            const int copy_mb = mb_bitmask && !get_bits1(&mb_bitmask_gb);
-
-            if (s->restart_interval && !s->restart_count)
-                s->restart_count = s->restart_interval;
-
-            if(get_bits_count(&s->gb)>s->gb.size_in_bits){
-                av_log(s->avctx, AV_LOG_ERROR, "overread %d\n", get_bits_count(&s->gb) - s->gb.size_in_bits);
+    /* restart intervals are independent, decode them in parallel when the
+     * unescaping found a marker at the end of every one of them */
+    if (s->avctx->active_thread_type & FF_THREAD_SLICE && !mb_bitmask &&
+        s->restart_interval && nb_mcus > s->restart_interval &&
+        s->gb.buffer == s->buffer &&
+        s->nb_rst_offsets >= (nb_mcus - 1) / s->restart_interval) {
+        const int nb_segments = (nb_mcus + s->restart_interval - 1) / s->restart_interval;
+        int *ret = av_malloc(nb_segments * sizeof(*ret));
+
+        if (ret) {
+            int err = 0;
+
+            s->avctx->execute2(s->avctx, mjpeg_decode_scan_segment, &scan, ret, nb_segments);
+            for (i = 0; i < nb_segments; i++)
+                err |= ret[i];
+            av_free(ret);
+            s->nb_rst_offsets = 0;
+            if (err < 0)
                 return -1;
-            }
-            for(i=0;i<nb_components;i++) {
-                uint8_t *ptr;
-                int n, h, v, x, y, c, j;
-                int block_offset;
-                n = s->nb_blocks[i];
-                c = s->comp_index[i];
-                h = s->h_scount[i];
-                v = s->v_scount[i];
-                x = 0;
-                y = 0;
-                for(j=0;j<n;j++) {
-                    block_offset = (((linesize[c] * (v * mb_y + y) * 8) +
-                                     (h * mb_x + x) * 8) >> s->avctx->lowres);
-
-                    if(s->interlaced && s->bottom_field)
-                        block_offset += linesize[c] >> 1;
-                    ptr = data[c] + block_offset;
-                    if(!s->progressive) {
-                        if (copy_mb) {
-                            mjpeg_copy_block(ptr, reference_data[c] + block_offset, linesize[c], s->avctx->lowres);
-                        } else {
-                        s->dsp.clear_block(s->block);
-                        if(decode_block(s, s->block, i,
-                                     s->dc_index[i], s->ac_index[i],
-                                     s->quant_matrixes[ s->quant_index[c] ]) < 0) {
-                            av_log(s->avctx, AV_LOG_ERROR, "error y=%d x=%d\n", mb_y, mb_x);
-                            return -1;
-                        }
-                        s->dsp.idct_put(ptr, linesize[c], s->block);
-                        }
-                    } else {
-                        int block_idx = s->block_stride[c] * (v * mb_y + y) + (h * mb_x + x);
-                        DCTELEM *block = s->blocks[c][block_idx];
-                        if(Ah)
-                            block[0] += get_bits1(&s->gb) * s->quant_matrixes[ s->quant_index[c] ][0] << Al;
-                        else if(decode_dc_progressive(s, block, i, s->dc_index[i], s->quant_matrixes[ s->quant_index[c] ], Al) < 0) {
-                            av_log(s->avctx, AV_LOG_ERROR, "error y=%d x=%d\n", mb_y, mb_x);
-                            return -1;
-                        }
-                    }
-//                    av_log(s->avctx, AV_LOG_DEBUG, "mb: %d %d processed\n", mb_y, mb_x);
-//av_log(NULL, AV_LOG_DEBUG, "%d %d %d %d %d %d %d %d \n", mb_x, mb_y, x, y, c, s->bottom_field, (v * mb_y + y) * 8, (h * mb_x + x) * 8);
-                    if (++x == h) {
-                        x = 0;
-                        y++;
-                    }
-                }
-            }
-
-            if (s->restart_interval) --s->restart_count;
-            i= 8+((-get_bits_count(&s->gb))&7);
-            if (s->restart_interval && show_bits(&s->gb, i)  == (1<<i)-1){ /* skip RSTn */
-                int pos= get_bits_count(&s->gb);
-                align_get_bits(&s->gb);
-                while(show_bits(&s->gb, 8) == 0xFF)
-                    skip_bits(&s->gb, 8);
-                if((get_bits(&s->gb, 8)&0xF8) == 0xD0){
-                    for (i=0; i<nb_components; i++) /* reset dc */
-                        s->last_dc[i] = 1024;
-                }else{
-                    skip_bits_long(&s->gb, pos - get_bits_count(&s->gb));
-                }
-            }
+            skip_bits_long(&s->gb, (scan.end_gb.buffer - s->gb.buffer) * 8 +
+                                   get_bits_count(&scan.end_gb) - get_bits_count(&s->gb));
+            return 0;
         }
     }
-    return 0;
+    s->nb_rst_offsets = 0;
+
+    return mjpeg_decode_scan_mcus(s, &scan, 0, nb_mcus);
 }
 
 static int mjpeg_decode_scan_progressive_ac(MJpegDecodeContext *s, int ss, int se, int Ah, int Al){
@@ -1327,6 +1412,8 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
                 if ((buf_end - *buf_ptr) > s->buffer_size)
                 {
                     av_free(s->buffer);
+                    av_freep(&s->rst_offsets);
+                    s->rst_offsets_size = 0;
                     s->buffer_size = buf_end - *buf_ptr;
                     s->buffer = av_malloc(s->buffer_size + FF_INPUT_BUFFER_PADDING_SIZE);
                     av_log(s->avctx, AV_LOG_DEBUG, "buffer too small, expanding to %d bytes\n",
@@ -1338,7 +1425,10 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
                 {
                     const uint8_t *src = *buf_ptr;
                     uint8_t *dst = s->buffer;
+                    /* remember where the restart intervals start for slice threading */
+                    int find_rst = s->restart_interval && s->avctx->active_thread_type & FF_THREAD_SLICE;
 
+                    s->nb_rst_offsets = 0;
                     while (src<buf_end)
                     {
                         uint8_t x = *(src++);
@@ -1350,9 +1440,19 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
                                 while (src < buf_end && x == 0xff)
                                     x = *(src++);
 
-                                if (x >= 0xd0 && x <= 0xd7)
+                                if (x >= 0xd0 && x <= 0xd7) {
                                     *(dst++) = x;
-                                else if (x)
+                                    if (find_rst) {
+                                        int *offsets = av_fast_realloc(s->rst_offsets, &s->rst_offsets_size,
+                                                                       (s->nb_rst_offsets + 1) * sizeof(*offsets));
+                                        if (!offsets) {
+                                            s->nb_rst_offsets = find_rst = 0;
+                                        } else {
+                                            s->rst_offsets = offsets;
+                                            s->rst_offsets[s->nb_rst_offsets++] = dst - s->buffer;
+                                        }
+                                    }
+                                } else if (x)
                                     break;
                             }
                         }
@@ -1601,6 +1701,7 @@ av_cold int ff_mjpeg_decode_end(AVCodecContext *avctx)
     av_free(s->qscale_table);
     av_freep(&s->ljpeg_buffer);
     s->ljpeg_buffer_size=0;
+    av_freep(&s->rst_offsets);
 
     for(i=0;i<3;i++) {
         for(j=0;j<4;j++)
@@ -1622,7 +1723,7 @@ AVCodec ff_mjpeg_decoder = {
     NULL,
     ff_mjpeg_decode_end,
     ff_mjpeg_decode_frame,
-    CODEC_CAP_DR1,
+    CODEC_CAP_DR1 | CODEC_CAP_SLICE_THREADS,
     NULL,
     .max_lowres = 3,
     .long_name = NULL_IF_CONFIG_SMALL("MJPEG (Motion JPEG)"),
@@ -94,6 +94,9 @@ typedef struct MJpegDecodeContext {
 
     int restart_interval;
     int restart_count;
+    int *rst_offsets;       ///< positions in buffer just after each RSTn marker of the current scan
+    unsigned int rst_offsets_size;
+    int nb_rst_offsets;
 
     int buggy_avid;
     int cs_itu601;
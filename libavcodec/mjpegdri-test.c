@@ -0,0 +1,256 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * MJPEG restart interval slice threading test.
+ *
+ * The MJPEG encoder writes no restart markers, so each picture is encoded
+ * as horizontal strips with a fixed quantizer. The entropy coded data of
+ * the strips is joined with RSTn markers below the headers of the first
+ * strip, with the height patched and a DRI segment added. Every strip
+ * starts with reset DC predictors, so the result is a valid picture with
+ * one restart interval per strip.
+ *
+ * The stream starts at CIF/4 and continues at CIF, so the decoder has to
+ * grow its buffers mid-stream. It is decoded once single threaded and once
+ * with slice threads and both runs have to return the same frames. The DCT
+ * and IDCT are fixed, so the checksums do not depend on the cpu.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/intreadwrite.h"
+#include "libavutil/imgutils.h"
+#include "avcodec.h"
+#include "bytestream.h"
+#include "mjpeg.h"
+#include "threadtest.h"
+
+#undef printf
+#undef fprintf
+
+#define NB_FRAMES    10
+#define NB_THREADS    4
+#define MAX_WIDTH   352
+#define MAX_HEIGHT  288
+
+static const struct {
+    int width, height, strip_height;
+} sizes[] = {
+    { 176, 144, 16 },
+    { 352, 288, 32 },
+};
+
+static ThreadTestStream stream;
+
+/* return the offset of the first marker m or -1 */
+static int find_marker(const uint8_t *buf, int size, int m)
+{
+    int i;
+
+    for (i = 0; i < size - 1; i++)
+        if (buf[i] == 0xFF && buf[i + 1] == m)
+            return i;
+    return -1;
+}
+
+/**
+ * Encode the picture strip by strip and assemble one packet with a restart
+ * interval per strip.
+ */
+static int encode_picture(AVCodecContext *avctx, AVFrame *pic, int width, int height,
+                          int strip_height, uint8_t *buf, int buf_size)
+{
+    const int nb_strips = height / strip_height;
+    AVPacket *pkt = ff_threadtest_new_packet(&stream, buf_size);
+    AVFrame strip = *pic;
+    uint8_t *p;
+    int i, j, size, sof, sos, data_start, data_size;
+
+    if (!pkt)
+        return -1;
+    p = pkt->data;
+
+    for (i = 0; i < nb_strips; i++) {
+        for (j = 0; j < 3; j++)
+            strip.data[j] = pic->data[j] + (i * strip_height >> !!j) * pic->linesize[j];
+
+        size = avcodec_encode_video(avctx, buf, buf_size, &strip);
+        sos  = find_marker(buf, size, SOS);
+        if (size < 4 || sos < 0)
+            return -1;
+        data_start = sos + 2 + AV_RB16(buf + sos + 2);
+
+        if (!i) {
+            /* headers of the whole picture: SOI to SOF0, SOF0 with the
+             * picture height, DRI and the scan header */
+            sof = find_marker(buf, sos, SOF0);
+            if (sof < 0)
+                return -1;
+            memcpy(p, buf, sos);
+            AV_WB16(p + sof + 5, height);
+            p += sos;
+            bytestream_put_be16(&p, 0xFF00 | DRI);
+            bytestream_put_be16(&p, 4);
+            bytestream_put_be16(&p, width / 16 * strip_height / 16);
+            memcpy(p, buf + sos, data_start - sos);
+            p += data_start - sos;
+        } else {
+            bytestream_put_be16(&p, 0xFF00 | (RST0 + ((i - 1) & 7)));
+        }
+        data_size = size - 2 - data_start;
+        if (p + data_size + 4 > pkt->data + pkt->size)
+            return -1;
+        memcpy(p, buf + data_start, data_size);
+        p += data_size;
+    }
+    bytestream_put_be16(&p, 0xFF00 | EOI);
+    pkt->size = p - pkt->data;
+    return 0;
+}
+
+static int encode_stream(void)
+{
+    AVCodec *codec = avcodec_find_encoder(CODEC_ID_MJPEG);
+    AVFrame *pic = avcodec_alloc_frame();
+    int buf_size = MAX_WIDTH * MAX_HEIGHT * 4;
+    uint8_t *buf = av_malloc(buf_size);
+    int i, n, ret = -1;
+
+    if (!pic || !buf ||
+        av_image_alloc(pic->data, pic->linesize, MAX_WIDTH, MAX_HEIGHT,
+                       PIX_FMT_YUVJ420P, 16) < 0)
+        goto end;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(sizes); i++) {
+        AVCodecContext *avctx = avcodec_alloc_context3(codec);
+
+        if (!avctx)
+            goto end;
+        avctx->width          = sizes[i].width;
+        avctx->height         = sizes[i].strip_height;
+        avctx->time_base      = (AVRational){ 1, 25 };
+        avctx->pix_fmt        = PIX_FMT_YUVJ420P;
+        avctx->flags         |= CODEC_FLAG_BITEXACT | CODEC_FLAG_QSCALE;
+        avctx->global_quality = FF_QP2LAMBDA * 4;
+        avctx->dct_algo       = FF_DCT_FASTINT;
+        avctx->idct_algo      = FF_IDCT_SIMPLE;
+        if (avcodec_open2(avctx, codec, NULL) < 0) {
+            av_free(avctx);
+            goto end;
+        }
+
+        for (n = 0; n < NB_FRAMES; n++) {
+            ff_threadtest_fill_picture(pic, sizes[i].width, sizes[i].height,
+                                       stream.nb_packets);
+            if (encode_picture(avctx, pic, sizes[i].width, sizes[i].height,
+                               sizes[i].strip_height, buf, buf_size) < 0) {
+                avcodec_close(avctx);
+                av_free(avctx);
+                goto end;
+            }
+        }
+        avcodec_close(avctx);
+        av_free(avctx);
+    }
+    ret = 0;
+
+end:
+    if (pic)
+        av_free(pic->data[0]);
+    av_free(pic);
+    av_free(buf);
+    return ret;
+}
+
+static int decode_stream(int threads, uint32_t *sums, int *widths, int *heights)
+{
+    AVCodec *codec = avcodec_find_decoder(CODEC_ID_MJPEG);
+    AVCodecContext *avctx = avcodec_alloc_context3(codec);
+    AVFrame *pic = avcodec_alloc_frame();
+    int i, got_picture, nb = -1;
+
+    if (!avctx || !pic)
+        goto end;
+    avctx->thread_count = threads;
+    avctx->thread_type  = FF_THREAD_SLICE;
+    avctx->flags       |= CODEC_FLAG_BITEXACT;
+    avctx->idct_algo    = FF_IDCT_SIMPLE;
+    if (avcodec_open2(avctx, codec, NULL) < 0)
+        goto end;
+    if (threads > 1 && !(avctx->active_thread_type & FF_THREAD_SLICE)) {
+        fprintf(stderr, "slice threads are not active\n");
+        goto end;
+    }
+
+    for (nb = 0, i = 0; i < stream.nb_packets; i++) {
+        AVPacket pkt = stream.packets[i];
+
+        if (avcodec_decode_video2(avctx, pic, &got_picture, &pkt) < 0 || !got_picture) {
+            fprintf(stderr, "packet %d was not decoded\n", i);
+            nb = -1;
+            break;
+        }
+        widths[nb]  = avctx->width;
+        heights[nb] = avctx->height;
+        sums[nb++]  = ff_threadtest_checksum(pic->data, pic->linesize,
+                                             avctx->width, avctx->height);
+    }
+
+end:
+    if (avctx)
+        avcodec_close(avctx);
+    av_free(avctx);
+    av_free(pic);
+    return nb;
+}
+
+int main(void)
+{
+    uint32_t ref[2 * NB_FRAMES], sums[2 * NB_FRAMES];
+    int widths[2 * NB_FRAMES], heights[2 * NB_FRAMES];
+    int nb_ref, nb, i;
+
+    avcodec_register_all();
+    av_log_set_level(AV_LOG_ERROR);
+
+    if (encode_stream() < 0) {
+        fprintf(stderr, "encoding the test stream failed\n");
+        return 1;
+    }
+
+    nb_ref = decode_stream(1, ref, widths, heights);
+    nb     = decode_stream(NB_THREADS, sums, widths, heights);
+    if (nb_ref < 0 || nb < 0) {
+        fprintf(stderr, "decoding failed\n");
+        return 1;
+    }
+
+    for (i = 0; i < nb; i++) {
+        if (sums[i] != ref[i]) {
+            fprintf(stderr, "frame %d differs\n", i);
+            return 1;
+        }
+        printf("%d, %dx%d, 0x%08x\n", i, widths[i], heights[i], sums[i]);
+    }
+
+    ff_threadtest_free_stream(&stream);
+    return 0;
+}
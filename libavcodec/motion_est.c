@@ -30,6 +30,10 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <limits.h>
+#include "config.h"
+#if HAVE_PTHREADS
+#include <pthread.h>
+#endif
 #include "libavutil/intmath.h"
 #include "avcodec.h"
 #include "dsputil.h"
@@ -2011,3 +2015,369 @@ void ff_fix_long_mvs(MpegEncContext * s, uint8_t *field_select_table, int field_
         }
     }
 }
+
+/* motion estimation lookahead */
+
+#define LA_BORDER   16  ///< border around the half resolution pictures
+#define LA_BAND      4  ///< MB rows searched by one lookahead job
+#define LA_MAX_ITER 32  ///< maximum number of diamond steps per MB
+
+typedef struct MELookaheadPicture{
+    uint8_t *base;
+    uint8_t *plane;                    ///< half resolution luma
+    int16_t (*mv)[2];                  ///< vector of each MB to the previous picture, in half resolution pixels
+    int display_picture_number;
+    int ref;                           ///< slot of the previous picture, -1 if there is none
+    int bands_done;
+}MELookaheadPicture;
+
+typedef struct MELookahead{
+    me_cmp_func sad;
+    void (*shrink)(uint8_t *dst, int dst_wrap, const uint8_t *src, int src_wrap, int width, int height);
+    int mb_width, mb_height;
+    int width, height;                 ///< visible size of the half resolution pictures
+    int stride;
+    int nb_bands;
+    int nb_pics;
+    MELookaheadPicture *pics;
+    int next;                          ///< slot of the next picture
+    int last;                          ///< slot of the last picture, -1 if there is none
+#if HAVE_PTHREADS
+    pthread_t *workers;
+    int nb_workers;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int *jobs;                         ///< queued jobs, slot * nb_bands + band
+    int job_head;
+    int job_count;
+    int exit;
+#endif
+}MELookahead;
+
+static inline int lookahead_cost(MELookahead *la, uint8_t *src, uint8_t *ref,
+                                 int mx, int my, int px, int py){
+    return la->sad(NULL, src, ref + my*la->stride + mx, la->stride, 8)
+           + 4*(FFABS(mx - px) + FFABS(my - py));
+}
+
+/**
+ * Search the vectors of one band of MB rows with a diamond search started
+ * at the best of the zero vector and the vectors of the left, top and
+ * top right MB. Bands do not depend on each other, so the result does not
+ * depend on the number of threads.
+ */
+static void lookahead_search_band(MELookahead *la, MELookaheadPicture *p, int band){
+    static const int8_t dia[4][2]= {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+    const MELookaheadPicture *ref= &la->pics[p->ref];
+    const int stride= la->stride;
+    const int y_start= band*LA_BAND;
+    const int y_end= FFMIN(y_start + LA_BAND, la->mb_height);
+    int mb_x, mb_y;
+
+    for(mb_y= y_start; mb_y < y_end; mb_y++){
+        for(mb_x= 0; mb_x < la->mb_width; mb_x++){
+            const int xy= mb_y*la->mb_width + mb_x;
+            uint8_t *src= p->plane   + 8*(mb_y*stride + mb_x);
+            uint8_t *dst= ref->plane + 8*(mb_y*stride + mb_x);
+            const int xmin= -8*mb_x - LA_BORDER, xmax= 8*(la->mb_width  - mb_x - 1) + LA_BORDER;
+            const int ymin= -8*mb_y - LA_BORDER, ymax= 8*(la->mb_height - mb_y - 1) + LA_BORDER;
+            int cand[3][2];
+            int nb_cand= 0, px= 0, py= 0, bx= 0, by= 0;
+            int dmin, d, i, iter;
+
+            if(mb_x){
+                cand[nb_cand][0]= p->mv[xy - 1][0];
+                cand[nb_cand][1]= p->mv[xy - 1][1];
+                nb_cand++;
+            }
+            if(mb_y > y_start){
+                cand[nb_cand][0]= p->mv[xy - la->mb_width][0];
+                cand[nb_cand][1]= p->mv[xy - la->mb_width][1];
+                nb_cand++;
+                if(mb_x + 1 < la->mb_width){
+                    cand[nb_cand][0]= p->mv[xy - la->mb_width + 1][0];
+                    cand[nb_cand][1]= p->mv[xy - la->mb_width + 1][1];
+                    nb_cand++;
+                }
+            }
+            if(nb_cand == 3){
+                px= mid_pred(cand[0][0], cand[1][0], cand[2][0]);
+                py= mid_pred(cand[0][1], cand[1][1], cand[2][1]);
+            }else if(nb_cand){
+                px= cand[0][0];
+                py= cand[0][1];
+            }
+
+            dmin= lookahead_cost(la, src, dst, 0, 0, px, py);
+            for(i=0; i<nb_cand; i++){
+                int mx= av_clip(cand[i][0], xmin, xmax);
+                int my= av_clip(cand[i][1], ymin, ymax);
+
+                d= lookahead_cost(la, src, dst, mx, my, px, py);
+                if(d < dmin){
+                    dmin= d;
+                    bx= mx;
+                    by= my;
+                }
+            }
+
+            for(iter=0; iter<LA_MAX_ITER; iter++){
+                const int cx= bx, cy= by;
+
+                for(i=0; i<4; i++){
+                    int mx= cx + dia[i][0];
+                    int my= cy + dia[i][1];
+
+                    if(mx < xmin || mx > xmax || my < ymin || my > ymax)
+                        continue;
+                    d= lookahead_cost(la, src, dst, mx, my, px, py);
+                    if(d < dmin){
+                        dmin= d;
+                        bx= mx;
+                        by= my;
+                    }
+                }
+                if(bx == cx && by == cy)
+                    break;
+            }
+
+            p->mv[xy][0]= bx;
+            p->mv[xy][1]= by;
+        }
+    }
+}
+
+#if HAVE_PTHREADS
+static void *lookahead_worker(void *arg){
+    MELookahead *la= arg;
+
+    pthread_mutex_lock(&la->lock);
+    for(;;){
+        int job, slot;
+
+        while(!la->job_count && !la->exit)
+            pthread_cond_wait(&la->cond, &la->lock);
+        if(la->exit)
+            break;
+        job= la->jobs[la->job_head];
+        la->job_head= (la->job_head + 1) % (la->nb_pics*la->nb_bands);
+        la->job_count--;
+        pthread_mutex_unlock(&la->lock);
+
+        slot= job / la->nb_bands;
+        lookahead_search_band(la, &la->pics[slot], job % la->nb_bands);
+
+        pthread_mutex_lock(&la->lock);
+        if(++la->pics[slot].bands_done == la->nb_bands)
+            pthread_cond_broadcast(&la->cond);
+    }
+    pthread_mutex_unlock(&la->lock);
+
+    return NULL;
+}
+#endif
+
+static void lookahead_wait(MELookahead *la, MELookaheadPicture *p){
+#if HAVE_PTHREADS
+    pthread_mutex_lock(&la->lock);
+    while(p->bands_done < la->nb_bands)
+        pthread_cond_wait(&la->cond, &la->lock);
+    pthread_mutex_unlock(&la->lock);
+#endif
+}
+
+/**
+ * Start the motion estimation lookahead with avctx->me_lookahead_threads
+ * worker threads. Without threads support, the lookahead runs when the
+ * pictures are submitted.
+ */
+av_cold int ff_me_lookahead_init(MpegEncContext *s){
+    MELookahead *la;
+    int i;
+
+    if(s->width < 16 || s->height < 16)
+        return 0;
+
+    la= av_mallocz(sizeof(MELookahead));
+    if(!la)
+        return AVERROR(ENOMEM);
+    s->me.lookahead= la;
+
+    la->sad      = s->dsp.sad[1];
+    la->shrink   = s->dsp.shrink[1];
+    la->mb_width = s->mb_width;
+    la->mb_height= s->mb_height;
+    la->width    = s->width  >> 1;
+    la->height   = s->height >> 1;
+    la->stride   = 8*s->mb_width + 2*LA_BORDER;
+    la->nb_bands = (s->mb_height + LA_BAND - 1) / LA_BAND;
+    /* the pictures waiting for encoding, and the reference of the oldest */
+    la->nb_pics  = s->max_b_frames + 3;
+    la->last     = -1;
+#if HAVE_PTHREADS
+    pthread_mutex_init(&la->lock, NULL);
+    pthread_cond_init(&la->cond, NULL);
+#endif
+
+    la->pics= av_mallocz(la->nb_pics * sizeof(MELookaheadPicture));
+    if(!la->pics)
+        goto fail;
+    for(i=0; i<la->nb_pics; i++){
+        MELookaheadPicture *p= &la->pics[i];
+
+        p->base= av_malloc(la->stride * (8*s->mb_height + 2*LA_BORDER));
+        p->mv  = av_malloc(s->mb_width * s->mb_height * sizeof(*p->mv));
+        if(!p->base || !p->mv)
+            goto fail;
+        p->plane= p->base + LA_BORDER*la->stride + LA_BORDER;
+        p->display_picture_number= -1;
+        p->ref= -1;
+        p->bands_done= la->nb_bands;
+    }
+
+#if HAVE_PTHREADS
+    la->jobs   = av_malloc(la->nb_pics * la->nb_bands * sizeof(int));
+    la->workers= av_mallocz(s->avctx->me_lookahead_threads * sizeof(pthread_t));
+    if(!la->jobs || !la->workers)
+        goto fail;
+    for(i=0; i<s->avctx->me_lookahead_threads; i++){
+        if(pthread_create(&la->workers[i], NULL, lookahead_worker, la))
+            break;
+    }
+    la->nb_workers= i;
+    if(!la->nb_workers)
+        av_log(s->avctx, AV_LOG_WARNING, "could not start the motion estimation lookahead threads\n");
+#endif
+
+    return 0;
+fail:
+    ff_me_lookahead_end(s);
+    return AVERROR(ENOMEM);
+}
+
+av_cold void ff_me_lookahead_end(MpegEncContext *s){
+    MELookahead *la= s->me.lookahead;
+    int i;
+
+    if(!la)
+        return;
+
+#if HAVE_PTHREADS
+    if(la->nb_workers){
+        for(i=0; i<la->nb_pics; i++)
+            lookahead_wait(la, &la->pics[i]);
+
+        pthread_mutex_lock(&la->lock);
+        la->exit= 1;
+        pthread_cond_broadcast(&la->cond);
+        pthread_mutex_unlock(&la->lock);
+
+        for(i=0; i<la->nb_workers; i++)
+            pthread_join(la->workers[i], NULL);
+    }
+    pthread_mutex_destroy(&la->lock);
+    pthread_cond_destroy(&la->cond);
+    av_freep(&la->workers);
+    av_freep(&la->jobs);
+#endif
+
+    if(la->pics){
+        for(i=0; i<la->nb_pics; i++){
+            av_freep(&la->pics[i].base);
+            av_freep(&la->pics[i].mv);
+        }
+    }
+    av_freep(&la->pics);
+    av_freep(&s->me.lookahead);
+}
+
+/**
+ * Queue the motion estimation of an input picture against the previous one.
+ * Only the luma plane is read, and only during this call.
+ */
+void ff_me_lookahead_submit(MpegEncContext *s, const AVFrame *pic){
+    MELookahead *la= s->me.lookahead;
+    const int slot= la->next;
+    MELookaheadPicture *p= &la->pics[slot];
+    const int w= 8*la->mb_width  + LA_BORDER;
+    const int h= 8*la->mb_height + LA_BORDER;
+    uint8_t *dst= p->plane;
+    int band, y;
+
+    /* the slot is reused, and it is the reference of the next one */
+    lookahead_wait(la, p);
+    lookahead_wait(la, &la->pics[(slot + 1) % la->nb_pics]);
+
+    la->shrink(dst, la->stride, pic->data[0], pic->linesize[0], la->width, la->height);
+    for(y=0; y<la->height; y++){
+        uint8_t *line= dst + y*la->stride;
+
+        memset(line - LA_BORDER, line[0], LA_BORDER);
+        memset(line + la->width, line[la->width - 1], w - la->width);
+    }
+    for(y=-LA_BORDER; y<0; y++)
+        memcpy(dst + y*la->stride - LA_BORDER, dst - LA_BORDER, la->stride);
+    for(y=la->height; y<h; y++)
+        memcpy(dst + y*la->stride - LA_BORDER, dst + (la->height - 1)*la->stride - LA_BORDER, la->stride);
+
+    p->display_picture_number= pic->display_picture_number;
+    p->ref= la->last;
+    la->last= slot;
+    la->next= (slot + 1) % la->nb_pics;
+
+    if(p->ref < 0)
+        return;
+
+#if HAVE_PTHREADS
+    if(la->nb_workers){
+        const int queue_size= la->nb_pics * la->nb_bands;
+
+        pthread_mutex_lock(&la->lock);
+        p->bands_done= 0;
+        for(band=0; band<la->nb_bands; band++)
+            la->jobs[(la->job_head + la->job_count++) % queue_size]= slot*la->nb_bands + band;
+        pthread_cond_broadcast(&la->cond);
+        pthread_mutex_unlock(&la->lock);
+        return;
+    }
+#endif
+    for(band=0; band<la->nb_bands; band++)
+        lookahead_search_band(la, p, band);
+}
+
+/**
+ * Store the lookahead vectors of the current P-frame, scaled to the distance
+ * to its reference, in p_mv_table, where the motion estimation takes them
+ * as predictors instead of the vectors of the pre-pass.
+ * @return 1 if the vectors were stored, 0 if there are none for this picture
+ */
+int ff_me_lookahead_fill(MpegEncContext *s){
+    MELookahead *la= s->me.lookahead;
+    const int scale= 2 << (1 + s->quarter_sample);
+    MELookaheadPicture *p= NULL;
+    int i, x, y, dist;
+
+    if(!s->last_picture_ptr)
+        return 0;
+    for(i=0; i<la->nb_pics; i++){
+        if(   la->pics[i].ref >= 0
+           && la->pics[i].display_picture_number == s->current_picture_ptr->display_picture_number)
+            p= &la->pics[i];
+    }
+    dist= s->current_picture_ptr->display_picture_number - s->last_picture_ptr->display_picture_number;
+    if(!p || dist <= 0)
+        return 0;
+
+    lookahead_wait(la, p);
+
+    for(y=0; y<s->mb_height; y++){
+        for(x=0; x<s->mb_width; x++){
+            const int16_t *mv= p->mv[y*la->mb_width + x];
+
+            s->p_mv_table[y*s->mb_stride + x][0]= av_clip_int16(mv[0] * scale * dist);
+            s->p_mv_table[y*s->mb_stride + x][1]= av_clip_int16(mv[1] * scale * dist);
+        }
+    }
+
+    return 1;
+}
@@ -192,6 +192,8 @@ typedef struct MotionEstContext{
                                   int *mx_ptr, int *my_ptr, int dmin,
                                   int src_index, int ref_index,
                                   int size, int h);
+    struct MELookahead *lookahead;     ///< motion estimation of upcoming input pictures, NULL if disabled
+    int lookahead_mvs;                 ///< = 1 if p_mv_table holds the lookahead vectors of the current picture
 }MotionEstContext;
 
 /**
@@ -785,6 +787,10 @@ int ff_epzs_motion_search(MpegEncContext * s, int *mx_ptr, int *my_ptr,
                              int ref_mv_scale, int size, int h);
 int ff_get_mb_score(MpegEncContext * s, int mx, int my, int src_index,
                                int ref_index, int size, int h, int add_rate);
+int ff_me_lookahead_init(MpegEncContext *s);
+void ff_me_lookahead_end(MpegEncContext *s);
+void ff_me_lookahead_submit(MpegEncContext *s, const AVFrame *pic);
+int ff_me_lookahead_fill(MpegEncContext *s);
 
 /* mpeg12.c */
 extern const uint8_t ff_mpeg1_dc_scale_table[128];
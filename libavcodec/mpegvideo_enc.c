@@ -747,6 +747,11 @@ av_cold int MPV_encode_init(AVCodecContext *avctx)
     if(ff_rate_control_init(s) < 0)
         return -1;
 
+    if(avctx->me_lookahead_threads > 0 && !s->intra_only){
+        if(ff_me_lookahead_init(s) < 0)
+            return -1;
+    }
+
     return 0;
 }
 
@@ -755,6 +760,7 @@ av_cold int MPV_encode_end(AVCodecContext *avctx)
     MpegEncContext *s = avctx->priv_data;
 
     ff_rate_control_uninit(s);
+    ff_me_lookahead_end(s);
 
     MPV_common_end(s);
     if ((CONFIG_MJPEG_ENCODER || CONFIG_LJPEG_ENCODER) && s->out_format == FMT_MJPEG)
@@ -898,6 +904,9 @@ static int load_input_picture(MpegEncContext *s, AVFrame *pic_arg){
     }
     copy_picture_attributes(s, pic, pic_arg);
     pic->pts= pts; //we set this here to avoid modifiying pic_arg
+
+    if(s->me.lookahead)
+        ff_me_lookahead_submit(s, pic_arg);
   }
 
     /* shift buffer entries */
@@ -1971,7 +1980,8 @@ static int estimate_motion_thread(AVCodecContext *c, void *arg){
 
     ff_check_alignment();
 
-    s->me.dia_size= s->avctx->dia_size;
+    /* the lookahead vectors are close to the final ones, a small diamond is enough to refine them */
+    s->me.dia_size= s->me.lookahead_mvs ? FFMIN(s->avctx->dia_size, 1) : s->avctx->dia_size;
     s->first_slice_line=1;
     for(s->mb_y= s->start_mb_y; s->mb_y < s->end_mb_y; s->mb_y++) {
         s->mb_x=0; //for block init below
@@ -2800,6 +2810,9 @@ static int encode_picture(MpegEncContext *s, int picture_number)
     }
 
     s->mb_intra=0; //for the rate distortion & bit compare functions
+    s->me.lookahead_mvs= s->me.lookahead && s->pict_type != AV_PICTURE_TYPE_I
+                         && s->pict_type != AV_PICTURE_TYPE_B && s->avctx->me_threshold==0
+                         && ff_me_lookahead_fill(s);
     for(i=1; i<context_count; i++){
         ff_update_duplicate_context(s->thread_context[i], s);
     }
@@ -2811,7 +2824,7 @@ static int encode_picture(MpegEncContext *s, int picture_number)
     if(s->pict_type != AV_PICTURE_TYPE_I){
         s->lambda = (s->lambda * s->avctx->me_penalty_compensation + 128)>>8;
         s->lambda2= (s->lambda2* (int64_t)s->avctx->me_penalty_compensation + 128)>>8;
-        if(s->pict_type != AV_PICTURE_TYPE_B && s->avctx->me_threshold==0){
+        if(s->pict_type != AV_PICTURE_TYPE_B && s->avctx->me_threshold==0 && !s->me.lookahead_mvs){
             if((s->avctx->pre_me && s->last_non_b_pict_type==AV_PICTURE_TYPE_I) || s->avctx->pre_me==2){
                 s->avctx->execute(s->avctx, pre_estimate_motion_thread, &s->thread_context[0], NULL, context_count, sizeof(void*));
             }
@@ -0,0 +1,369 @@
+/*
+ * Copyright (c) 2012 Jan Pohanka
+ *
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * avcodec_decode_video_nonblock() test.
+ *
+ * An MPEG-4 stream is encoded in memory and decoded once
+ * single threaded with avcodec_decode_video2() and once with frame threads
+ * and avcodec_decode_video_nonblock(). The threaded decoder is slowed down
+ * so that all threads are busy; whenever it returns AVERROR(EAGAIN) it
+ * must not have returned a frame, and the packet is passed again after
+ * collecting finished frames with a NULL packet. The remaining frames are
+ * drained with empty packets. Both runs have to return the same frames in
+ * the same order.
+ *
+ * The stream has B-frames. With draw_horiz_band set, mpegvideo decodes
+ * them band by band into the first rows of the picture, so the bands are
+ * put together into a picture of their own for the checksum.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "libavutil/imgutils.h"
+#include "avcodec.h"
+#include "threadtest.h"
+
+#undef printf
+#undef fprintf
+
+#define WIDTH       352
+#define HEIGHT      288
+#define NB_FRAMES    40
+#define NB_THREADS    4
+#define MAX_BANDED   64
+
+typedef struct BandedPicture {
+    uint8_t *key;          ///< data[0] of the decoder's picture
+    uint8_t *data[4];
+    int      linesize[4];
+} BandedPicture;
+
+static ThreadTestStream stream;
+static int slow_decode;
+
+static BandedPicture banded[MAX_BANDED];
+static int banded_error;
+static pthread_mutex_t banded_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int encode_stream(void)
+{
+    AVCodec *codec = avcodec_find_encoder(CODEC_ID_MPEG4);
+    AVCodecContext *avctx = avcodec_alloc_context3(codec);
+    AVFrame *pic = avcodec_alloc_frame();
+    int buf_size = WIDTH * HEIGHT * 4;
+    uint8_t *buf = av_malloc(buf_size);
+    AVPacket *pkt;
+    int i, size, ret = -1;
+
+    if (!avctx || !pic || !buf)
+        goto end;
+
+    avctx->width        = WIDTH;
+    avctx->height       = HEIGHT;
+    avctx->time_base    = (AVRational){ 1, 25 };
+    avctx->pix_fmt      = PIX_FMT_YUV420P;
+    avctx->gop_size     = 12;
+    avctx->max_b_frames = 2;
+    avctx->flags       |= CODEC_FLAG_BITEXACT;
+    if (avcodec_open2(avctx, codec, NULL) < 0 ||
+        av_image_alloc(pic->data, pic->linesize, WIDTH, HEIGHT,
+                       PIX_FMT_YUV420P, 16) < 0)
+        goto end;
+
+    for (i = 0; ; i++) {
+        if (i < NB_FRAMES) {
+            ff_threadtest_fill_picture(pic, WIDTH, HEIGHT, i);
+            pic->pts = i;
+        }
+        size = avcodec_encode_video(avctx, buf, buf_size, i < NB_FRAMES ? pic : NULL);
+        if (size < 0)
+            goto end;
+        if (!size) {
+            if (i >= NB_FRAMES)
+                break;
+            continue;
+        }
+        if (!(pkt = ff_threadtest_new_packet(&stream, size)))
+            goto end;
+        memcpy(pkt->data, buf, size);
+    }
+    ret = 0;
+
+end:
+    if (avctx)
+        avcodec_close(avctx);
+    av_free(avctx);
+    if (pic)
+        av_free(pic->data[0]);
+    av_free(pic);
+    av_free(buf);
+    return ret;
+}
+
+/* the picture the bands of a B-frame decoded into pic are collected in */
+static BandedPicture *get_banded(const AVFrame *pic)
+{
+    BandedPicture *b = NULL;
+    int i;
+
+    pthread_mutex_lock(&banded_mutex);
+    for (i = 0; i < MAX_BANDED && banded[i].key; i++) {
+        if (banded[i].key == pic->data[0]) {
+            b = &banded[i];
+            break;
+        }
+    }
+    if (!b && i < MAX_BANDED &&
+        av_image_alloc(banded[i].data, banded[i].linesize, WIDTH, HEIGHT,
+                       PIX_FMT_YUV420P, 16) >= 0) {
+        b      = &banded[i];
+        b->key = pic->data[0];
+    }
+    if (!b)
+        banded_error = 1;
+    pthread_mutex_unlock(&banded_mutex);
+    return b;
+}
+
+static void free_banded(void)
+{
+    int i;
+
+    for (i = 0; i < MAX_BANDED && banded[i].key; i++) {
+        av_free(banded[i].data[0]);
+        banded[i].key = NULL;
+    }
+}
+
+static uint32_t frame_checksum(AVCodecContext *avctx, AVFrame *pic)
+{
+    uint8_t **data = pic->data;
+    int *linesize  = pic->linesize;
+
+    if (pic->pict_type == AV_PICTURE_TYPE_B) {
+        BandedPicture *b = get_banded(pic);
+
+        if (!b)
+            return 0;
+        data     = b->data;
+        linesize = b->linesize;
+    }
+    return ff_threadtest_checksum(data, linesize, avctx->width, avctx->height);
+}
+
+/* called by the decoding threads after the frame setup, so a thread
+ * sleeping here keeps its frame in flight */
+static void draw_horiz_band(AVCodecContext *avctx, const AVFrame *src,
+                            int offset[4], int y, int type, int height)
+{
+    if (src->pict_type == AV_PICTURE_TYPE_B) {
+        BandedPicture *b = get_banded(src);
+        int plane;
+
+        for (plane = 0; b && plane < 3; plane++) {
+            int shift = !!plane;
+
+            av_image_copy_plane(b->data[plane] + (y >> shift) * b->linesize[plane],
+                                b->linesize[plane],
+                                src->data[plane] + offset[plane], src->linesize[plane],
+                                avctx->width >> shift, height >> shift);
+        }
+    }
+    if (slow_decode && !y)
+        usleep(10000);
+}
+
+static AVCodecContext *open_decoder(int threads)
+{
+    AVCodec *codec = avcodec_find_decoder(CODEC_ID_MPEG4);
+    AVCodecContext *avctx = avcodec_alloc_context3(codec);
+
+    if (!avctx)
+        return NULL;
+    avctx->thread_count    = threads;
+    avctx->thread_type     = FF_THREAD_FRAME;
+    avctx->flags          |= CODEC_FLAG_BITEXACT;
+    avctx->draw_horiz_band = draw_horiz_band;
+    if (avcodec_open2(avctx, codec, NULL) < 0) {
+        av_free(avctx);
+        return NULL;
+    }
+    return avctx;
+}
+
+static void close_decoder(AVCodecContext *avctx)
+{
+    avcodec_close(avctx);
+    av_free(avctx);
+}
+
+/* return the delayed frames at the end of the stream */
+static int drain(AVCodecContext *avctx, AVFrame *pic, uint32_t *sums, int *nb)
+{
+    AVPacket pkt;
+    int got_picture;
+
+    av_init_packet(&pkt);
+    pkt.data = NULL;
+    pkt.size = 0;
+    do {
+        if (avcodec_decode_video2(avctx, pic, &got_picture, &pkt) < 0)
+            return -1;
+        if (got_picture) {
+            if (*nb == 2 * NB_FRAMES)
+                return -1;
+            sums[(*nb)++] = frame_checksum(avctx, pic);
+        }
+    } while (got_picture);
+    return 0;
+}
+
+static int decode_reference(AVFrame *pic, uint32_t *sums)
+{
+    AVCodecContext *avctx = open_decoder(1);
+    int i, got_picture, nb = 0;
+
+    if (!avctx)
+        return -1;
+    for (i = 0; i < stream.nb_packets; i++) {
+        AVPacket pkt = stream.packets[i];
+
+        if (avcodec_decode_video2(avctx, pic, &got_picture, &pkt) < 0) {
+            nb = -1;
+            break;
+        }
+        if (got_picture)
+            sums[nb++] = frame_checksum(avctx, pic);
+    }
+    if (nb >= 0 && drain(avctx, pic, sums, &nb) < 0)
+        nb = -1;
+    close_decoder(avctx);
+    return nb;
+}
+
+static int decode_nonblock(AVFrame *pic, uint32_t *sums, int *nb_eagain)
+{
+    AVCodecContext *avctx = open_decoder(NB_THREADS);
+    int i, ret = 0, got_picture, nb = 0;
+
+    if (!avctx)
+        return -1;
+    if (!(avctx->active_thread_type & FF_THREAD_FRAME)) {
+        fprintf(stderr, "frame threads are not active\n");
+        close_decoder(avctx);
+        return -1;
+    }
+
+    slow_decode = 1;
+    for (i = 0; i < stream.nb_packets && ret >= 0; i++) {
+        for (;;) {
+            AVPacket pkt = stream.packets[i];
+
+            ret = avcodec_decode_video_nonblock(avctx, pic, &got_picture, &pkt);
+            if (ret == AVERROR(EAGAIN)) {
+                if (got_picture) {
+                    fprintf(stderr, "frame returned with EAGAIN\n");
+                    ret = -1;
+                    break;
+                }
+                (*nb_eagain)++;
+
+                /* collect a finished frame without passing a packet */
+                ret = avcodec_decode_video_nonblock(avctx, pic, &got_picture, NULL);
+                if (ret < 0)
+                    break;
+                if (!got_picture)
+                    usleep(1000);
+            }
+            if (got_picture) {
+                if (nb == 2 * NB_FRAMES) {
+                    ret = -1;
+                    break;
+                }
+                sums[nb++] = frame_checksum(avctx, pic);
+            }
+            if (ret < 0 || ret == stream.packets[i].size)
+                break;
+            if (ret) {
+                fprintf(stderr, "packet %d: %d of %d bytes taken\n", i, ret,
+                        stream.packets[i].size);
+                ret = -1;
+                break;
+            }
+        }
+    }
+    slow_decode = 0;
+
+    if (ret < 0 || drain(avctx, pic, sums, &nb) < 0)
+        nb = -1;
+    close_decoder(avctx);
+    return nb;
+}
+
+int main(void)
+{
+    AVFrame *pic;
+    uint32_t ref[2 * NB_FRAMES], sums[2 * NB_FRAMES];
+    int nb_ref, nb, nb_eagain = 0, i;
+
+    avcodec_register_all();
+    av_log_set_level(AV_LOG_ERROR);
+
+    pic = avcodec_alloc_frame();
+    if (!pic || encode_stream() < 0) {
+        fprintf(stderr, "encoding the test stream failed\n");
+        return 1;
+    }
+
+    nb_ref = decode_reference(pic, ref);
+    nb     = decode_nonblock(pic, sums, &nb_eagain);
+    if (nb_ref < 0 || nb < 0 || banded_error) {
+        fprintf(stderr, "decoding failed\n");
+        return 1;
+    }
+
+    if (nb != nb_ref) {
+        fprintf(stderr, "%d frames instead of %d\n", nb, nb_ref);
+        return 1;
+    }
+    for (i = 0; i < nb; i++) {
+        if (sums[i] != ref[i]) {
+            fprintf(stderr, "frame %d differs\n", i);
+            return 1;
+        }
+    }
+    if (!nb_eagain) {
+        fprintf(stderr, "AVERROR(EAGAIN) was never returned\n");
+        return 1;
+    }
+
+    printf("%d packets, %d frames identical to single threaded decoding\n",
+           stream.nb_packets, nb);
+
+    ff_threadtest_free_stream(&stream);
+    free_banded();
+    av_free(pic);
+    return 0;
+}
@@ -33,6 +33,25 @@
 
 #include "avcodec.h"
 #include "thread.h"
+#include "libavutil/imgutils.h"
+
+#if HAVE_SYSCONF
+#include <unistd.h>
+#endif
+
+#if HAVE_SYNC_FETCH_AND_ADD
+#define memory_barrier() __sync_synchronize()
+#else
+/* progress values are only accessed under progress_mutex */
+#define memory_barrier()
+#endif
+
+/**
+ * Number of times a thread checks a progress value before it goes to sleep
+ * waiting for it. Spinning only pays off if the reporting thread runs on
+ * another core, so it is disabled on single core systems.
+ */
+#define PROGRESS_SPIN_COUNT 1000
 
 typedef int (action_func)(AVCodecContext *c, void *arg);
 typedef int (action_func2)(AVCodecContext *c, void *arg, int jobnr, int threadnr);
@@ -64,8 +83,9 @@ typedef struct PerThreadContext {
     struct FrameThreadContext *parent;
 
     pthread_t      thread;
+    int            thread_init;     ///< Set once the thread has been created.
     pthread_cond_t input_cond;      ///< Used to wait for a new packet from the main thread.
-    pthread_cond_t progress_cond;   ///< Used by child threads to wait for progress to change.
+    pthread_cond_t progress_cond;   ///< Used by child threads to wait for a state change.
     pthread_cond_t output_cond;     ///< Used by the main thread to wait for frames to finish.
 
     pthread_mutex_t mutex;          ///< Mutex used to protect the contents of the PerThreadContext.
@@ -77,8 +97,13 @@ typedef struct PerThreadContext {
     int            allocated_buf_size; ///< Size allocated for avpkt.data
 
     AVFrame frame;                  ///< Output frame (for decoding) or input (for encoding).
-    int     got_frame;              ///< The output of got_picture_ptr from the last avcodec_decode_video() call.
+    AVPicture input;                ///< Buffer the user's picture is copied to (for encoding).
+    int     got_frame;              /**<
+                                     * The output of got_picture_ptr from the last avcodec_decode_video() call,
+                                     * or set while an encoded frame has not been returned to the user.
+                                     */
     int     result;                 ///< The result of the last codec decode/encode() call.
+    int     reinit;                 ///< Set if the codec must be reopened before decoding avpkt.
 
     enum {
         STATE_INPUT_READY,          ///< Set when the thread is awaiting a packet.
@@ -99,11 +124,37 @@ typedef struct PerThreadContext {
 
     /**
      * Array of progress values used by ff_thread_get_buffer().
+     * Written by the decoding thread with release semantics, so that other
+     * threads may read them without taking progress_mutex.
      */
     int     progress[MAX_BUFFERS][2];
     uint8_t progress_used[MAX_BUFFERS];
 
+    /**
+     * Threads sleeping on each progress value and the condition they wait on.
+     * The count is changed under progress_mutex; ff_thread_report_progress()
+     * only takes the mutex if it is nonzero.
+     */
+    volatile int   progress_waiters[MAX_BUFFERS];
+    pthread_cond_t progress_conds[MAX_BUFFERS];
+
     AVFrame *requested_frame;       ///< AVFrame the codec passed to get_buffer()
+
+    /**
+     * Slice jobs this thread submitted with execute() or execute2() when
+     * frame and slice threading are combined. They are run by the thread
+     * itself and by the shared slice workers, under the parent's slice_mutex.
+     */
+    action_func  *slice_func;
+    action_func2 *slice_func2;
+    void *slice_args;
+    int  *slice_rets;
+    int   slice_rets_count;
+    int   slice_job_size;
+    int   slice_job_count;
+    int   slice_next_job;           ///< The next slice job to start.
+    int   slice_jobs_done;
+    pthread_cond_t slice_done_cond; ///< Signalled when the last slice job is done.
 } PerThreadContext;
 
 /**
@@ -117,6 +168,13 @@ typedef struct FrameThreadContext {
 
     int next_decoding;             ///< The next context to submit a packet to.
     int next_finished;             ///< The next context to return output from.
+    int in_flight;                 ///< Number of packets whose output was not returned yet.
+
+    void *priv_data;               ///< Decoder options as set before init(), used to reopen it.
+    int reinited;                  /**<
+                                    * Set after the codec was reopened, until the first packet
+                                    * decoded after that is returned.
+                                    */
 
     int delaying;                  /**<
                                     * Set for the first N packets, where N is the number of threads.
@@ -124,6 +182,22 @@ typedef struct FrameThreadContext {
                                     */
 
     int die;                       ///< Set when threads should exit.
+
+    int spin_count;                ///< Progress checks before sleeping in ff_thread_await_progress().
+
+    /**
+     * Slice workers shared by all frame threads, if slice threading is
+     * active as well. A worker only starts a job while fewer than
+     * thread_count threads are running codec code, so the slice jobs fill
+     * in for frame threads that are waiting instead of competing with them.
+     */
+    pthread_t *slice_workers;
+    int slice_worker_count;
+    pthread_mutex_t slice_mutex;   ///< Mutex protecting the slice job state and running.
+    pthread_cond_t  slice_cond;    ///< Used by slice workers to wait for jobs to start.
+    int slice_jobs;                ///< Number of slice jobs not started yet.
+    int running;                   ///< Number of threads running codec code.
+    int next_slice_worker;         ///< Used by slice workers to pick their thread number.
 } FrameThreadContext;
 
 static void* attribute_align_arg worker(void *v)
@@ -224,6 +298,253 @@ static int avcodec_thread_execute2(AVCodecContext *avctx, action_func2* func2, v
     return avcodec_thread_execute(avctx, NULL, arg, ret, job_count, 0);
 }
 
+static int get_logical_cpus(void)
+{
+#if HAVE_SYSCONF && defined(_SC_NPROCESSORS_ONLN)
+    long nb_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (nb_cpus > 0)
+        return nb_cpus;
+#endif
+    return 1;
+}
+
+/**
+ * Jobs of one execute() call on the shared thread pool.
+ * Lives on the stack of the calling thread, which runs jobs as well and
+ * returns once all of them are done.
+ */
+typedef struct PoolBatch {
+    AVCodecContext *avctx;
+    action_func *func;
+    action_func2 *func2;
+    void *args;
+    int *rets;
+    int rets_count;
+    int job_size;
+    int job_count;
+    int next_job;           ///< next job to be started
+    int jobs_done;
+    int priority;           ///< avctx->thread_priority
+    int max_threads;        ///< number of threads allowed to run jobs of the batch
+    unsigned threads_used;  ///< bitmask of the threadnr values in use
+
+    pthread_cond_t done_cond;
+    struct PoolBatch *next;
+} PoolBatch;
+
+/**
+ * Thread pool shared by all codec contexts opened while it exists.
+ */
+typedef struct ThreadPool {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;    ///< signalled when jobs are queued or on exit
+    pthread_t *workers;
+    int worker_count;
+    PoolBatch *batches;     ///< running batches, highest priority first
+    int die;
+} ThreadPool;
+
+static ThreadPool pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+
+/**
+ * Starts the next job of a batch, if the batch has one left and a free
+ * threadnr for it. Called with pool.mutex held.
+ */
+static int pool_start_job(PoolBatch *b, int *job, int *threadnr)
+{
+    int i;
+
+    if (b->next_job >= b->job_count)
+        return 0;
+    for (i = 0; i < b->max_threads; i++)
+        if (!(b->threads_used & (1U << i)))
+            break;
+    if (i == b->max_threads)
+        return 0;
+
+    b->threads_used |= 1U << i;
+    *threadnr = i;
+    *job      = b->next_job++;
+    return 1;
+}
+
+static void pool_run_job(PoolBatch *b, int job, int threadnr)
+{
+    b->rets[job % b->rets_count] =
+        b->func ? b->func(b->avctx, (char*)b->args + job*b->job_size) :
+                  b->func2(b->avctx, b->args, job, threadnr);
+}
+
+static attribute_align_arg void *pool_worker(void *arg)
+{
+    pthread_mutex_lock(&pool.mutex);
+    while (!pool.die) {
+        PoolBatch *b;
+        int job, threadnr;
+
+        for (b = pool.batches; b; b = b->next)
+            if (pool_start_job(b, &job, &threadnr))
+                break;
+        if (!b) {
+            pthread_cond_wait(&pool.cond, &pool.mutex);
+            continue;
+        }
+
+        pthread_mutex_unlock(&pool.mutex);
+        pool_run_job(b, job, threadnr);
+        pthread_mutex_lock(&pool.mutex);
+
+        b->threads_used &= ~(1U << threadnr);
+        if (++b->jobs_done == b->job_count)
+            pthread_cond_signal(&b->done_cond);
+    }
+    pthread_mutex_unlock(&pool.mutex);
+
+    return NULL;
+}
+
+static int pool_execute(AVCodecContext *avctx, action_func *func, action_func2 *func2,
+                        void *arg, int *ret, int job_count, int job_size)
+{
+    PoolBatch b = { 0 }, **q;
+    int dummy_ret, job, threadnr;
+
+    if (job_count <= 0)
+        return 0;
+
+    b.avctx       = avctx;
+    b.func        = func;
+    b.func2       = func2;
+    b.args        = arg;
+    b.job_size    = job_size;
+    b.job_count   = job_count;
+    b.priority    = avctx->thread_priority;
+    b.max_threads = av_clip(avctx->thread_count, 1, 32);
+    if (ret) {
+        b.rets       = ret;
+        b.rets_count = job_count;
+    } else {
+        b.rets       = &dummy_ret;
+        b.rets_count = 1;
+    }
+    pthread_cond_init(&b.done_cond, NULL);
+
+    pthread_mutex_lock(&pool.mutex);
+
+    /* The first job and threadnr 0 are ours until all jobs are done. */
+    job              = b.next_job++;
+    threadnr         = 0;
+    b.threads_used   = 1;
+    if (job_count > 1) {
+        for (q = &pool.batches; *q && (*q)->priority >= b.priority; q = &(*q)->next);
+        b.next = *q;
+        *q     = &b;
+        pthread_cond_broadcast(&pool.cond);
+    }
+
+    while (1) {
+        pthread_mutex_unlock(&pool.mutex);
+        pool_run_job(&b, job, threadnr);
+        pthread_mutex_lock(&pool.mutex);
+        b.jobs_done++;
+
+        if (b.next_job >= job_count)
+            break;
+        job = b.next_job++;
+    }
+
+    while (b.jobs_done < job_count)
+        pthread_cond_wait(&b.done_cond, &pool.mutex);
+
+    if (job_count > 1) {
+        for (q = &pool.batches; *q != &b; q = &(*q)->next);
+        *q = b.next;
+    }
+
+    pthread_mutex_unlock(&pool.mutex);
+    pthread_cond_destroy(&b.done_cond);
+
+    return 0;
+}
+
+/**
+ * execute() for contexts using the shared thread pool.
+ * The calling thread runs jobs too, and only waits for the ones
+ * that pool workers have started.
+ */
+static int thread_pool_execute(AVCodecContext *avctx, action_func *func, void *arg, int *ret, int job_count, int job_size)
+{
+    return pool_execute(avctx, func, NULL, arg, ret, job_count, job_size);
+}
+
+static int thread_pool_execute2(AVCodecContext *avctx, action_func2 *func2, void *arg, int *ret, int job_count)
+{
+    return pool_execute(avctx, NULL, func2, arg, ret, job_count, 0);
+}
+
+static int thread_pool_active(void)
+{
+    int active;
+
+    pthread_mutex_lock(&pool.mutex);
+    active = pool.worker_count > 0;
+    pthread_mutex_unlock(&pool.mutex);
+
+    return active;
+}
+
+int avcodec_thread_pool_init(int thread_count)
+{
+    int ret = 0;
+
+    if (thread_count < 0)
+        return AVERROR(EINVAL);
+    if (!thread_count)
+        thread_count = get_logical_cpus();
+
+    pthread_mutex_lock(&pool.mutex);
+    if (pool.workers) {
+        ret = AVERROR(EINVAL);
+        goto end;
+    }
+    pool.workers = av_mallocz(sizeof(pthread_t) * thread_count);
+    if (!pool.workers) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    pool.die = 0;
+    for (; pool.worker_count < thread_count; pool.worker_count++)
+        if (pthread_create(&pool.workers[pool.worker_count], NULL, pool_worker, NULL))
+            break;
+    if (!pool.worker_count) {
+        av_freep(&pool.workers);
+        ret = AVERROR(ENOMEM);
+    }
+end:
+    pthread_mutex_unlock(&pool.mutex);
+
+    return ret;
+}
+
+void avcodec_thread_pool_free(void)
+{
+    int i;
+
+    pthread_mutex_lock(&pool.mutex);
+    pool.die = 1;
+    pthread_cond_broadcast(&pool.cond);
+    pthread_mutex_unlock(&pool.mutex);
+
+    for (i = 0; i < pool.worker_count; i++)
+        pthread_join(pool.workers[i], NULL);
+
+    pthread_mutex_lock(&pool.mutex);
+    pool.worker_count = 0;
+    av_freep(&pool.workers);
+    pthread_mutex_unlock(&pool.mutex);
+}
+
 static int thread_init(AVCodecContext *avctx)
 {
     int i;
@@ -233,6 +554,12 @@ static int thread_init(AVCodecContext *avctx)
     if (thread_count <= 1)
         return 0;
 
+    if (thread_pool_active()) {
+        avctx->execute  = thread_pool_execute;
+        avctx->execute2 = thread_pool_execute2;
+        return 0;
+    }
+
     c = av_mallocz(sizeof(ThreadContext));
     if (!c)
         return -1;
@@ -268,6 +595,152 @@ static int thread_init(AVCodecContext *avctx)
     return 0;
 }
 
+/**
+ * Counts a thread in or out of the threads running codec code.
+ * Only needed when frame threads share slice workers.
+ */
+static void set_running(FrameThreadContext *fctx, int n)
+{
+    if (!fctx->slice_worker_count)
+        return;
+
+    pthread_mutex_lock(&fctx->slice_mutex);
+    fctx->running += n;
+    if (n < 0 && fctx->slice_jobs)
+        pthread_cond_signal(&fctx->slice_cond);
+    pthread_mutex_unlock(&fctx->slice_mutex);
+}
+
+/**
+ * Runs a slice job of a frame thread. Called without slice_mutex held.
+ */
+static void run_slice_job(PerThreadContext *p, int job, int threadnr)
+{
+    AVCodecContext *avctx = p->avctx;
+
+    p->slice_rets[job % p->slice_rets_count] =
+        p->slice_func ? p->slice_func(avctx, (char*)p->slice_args + job*p->slice_job_size) :
+                        p->slice_func2(avctx, p->slice_args, job, threadnr);
+}
+
+/**
+ * Slice worker thread, shared by all frame threads.
+ * Jobs of the oldest frame are started first, as the other threads
+ * may be waiting on it.
+ */
+static attribute_align_arg void *slice_worker_thread(void *arg)
+{
+    FrameThreadContext *fctx = arg;
+    AVCodecContext *avctx = fctx->threads[0].avctx;
+    int thread_count = avctx->thread_count;
+    int threadnr, i, job;
+
+    pthread_mutex_lock(&fctx->slice_mutex);
+    threadnr = ++fctx->next_slice_worker;
+
+    while (!fctx->die) {
+        PerThreadContext *p = NULL;
+
+        if (fctx->slice_jobs && fctx->running < thread_count) {
+            for (i = 0; i < thread_count; i++) {
+                p = &fctx->threads[(fctx->next_finished + i) % thread_count];
+                if (p->slice_next_job < p->slice_job_count)
+                    break;
+            }
+        }
+        if (!p || p->slice_next_job >= p->slice_job_count) {
+            pthread_cond_wait(&fctx->slice_cond, &fctx->slice_mutex);
+            continue;
+        }
+
+        job = p->slice_next_job++;
+        fctx->slice_jobs--;
+        fctx->running++;
+        pthread_mutex_unlock(&fctx->slice_mutex);
+
+        run_slice_job(p, job, threadnr);
+
+        pthread_mutex_lock(&fctx->slice_mutex);
+        fctx->running--;
+        if (++p->slice_jobs_done == p->slice_job_count)
+            pthread_cond_signal(&p->slice_done_cond);
+    }
+
+    pthread_mutex_unlock(&fctx->slice_mutex);
+
+    return NULL;
+}
+
+/**
+ * execute() for frame threads that share slice workers.
+ * The calling thread runs jobs too, and only waits for the ones
+ * that slice workers have started.
+ */
+static int frame_thread_execute(AVCodecContext *avctx, action_func *func, void *arg, int *ret, int job_count, int job_size)
+{
+    PerThreadContext *p = avctx->thread_opaque;
+    FrameThreadContext *fctx = p->parent;
+    int dummy_ret, job;
+
+    if (job_count <= 0)
+        return 0;
+
+    pthread_mutex_lock(&fctx->slice_mutex);
+
+    p->slice_func      = func;
+    p->slice_args      = arg;
+    p->slice_job_size  = job_size;
+    p->slice_next_job  = 0;
+    p->slice_jobs_done = 0;
+    if (ret) {
+        p->slice_rets       = ret;
+        p->slice_rets_count = job_count;
+    } else {
+        p->slice_rets       = &dummy_ret;
+        p->slice_rets_count = 1;
+    }
+    p->slice_job_count = job_count;
+    fctx->slice_jobs  += job_count - 1;
+    if (fctx->running < avctx->thread_count)
+        pthread_cond_broadcast(&fctx->slice_cond);
+
+    /* The first job is always ours, so there is one less to hand out. */
+    job = p->slice_next_job++;
+    while (1) {
+        pthread_mutex_unlock(&fctx->slice_mutex);
+        run_slice_job(p, job, 0);
+        pthread_mutex_lock(&fctx->slice_mutex);
+        p->slice_jobs_done++;
+
+        if (p->slice_next_job >= job_count)
+            break;
+        job = p->slice_next_job++;
+        fctx->slice_jobs--;
+    }
+
+    if (p->slice_jobs_done < job_count) {
+        fctx->running--;
+        if (fctx->slice_jobs)
+            pthread_cond_signal(&fctx->slice_cond);
+        while (p->slice_jobs_done < job_count)
+            pthread_cond_wait(&p->slice_done_cond, &fctx->slice_mutex);
+        fctx->running++;
+    }
+    p->slice_job_count = 0;
+
+    pthread_mutex_unlock(&fctx->slice_mutex);
+
+    return 0;
+}
+
+static int frame_thread_execute2(AVCodecContext *avctx, action_func2 *func2, void *arg, int *ret, int job_count)
+{
+    PerThreadContext *p = avctx->thread_opaque;
+
+    p->slice_func2 = func2;
+    return frame_thread_execute(avctx, NULL, arg, ret, job_count, 0);
+}
+
 /**
  * Codec worker thread.
  *
@@ -296,9 +769,15 @@ static attribute_align_arg void *frame_worker_thread(void *arg)
             ff_thread_finish_setup(avctx);
 
         pthread_mutex_lock(&p->mutex);
-        avcodec_get_frame_defaults(&p->frame);
-        p->got_frame = 0;
-        p->result = codec->decode(avctx, &p->frame, &p->got_frame, &p->avpkt);
+        set_running(fctx, 1);
+        if (codec->encode) {
+            p->result = codec->encode(avctx, p->avpkt.data, p->avpkt.size, &p->frame);
+        } else {
+            avcodec_get_frame_defaults(&p->frame);
+            p->got_frame = 0;
+            p->result = codec->decode(avctx, &p->frame, &p->got_frame, &p->avpkt);
+        }
+        set_running(fctx, -1);
 
         if (p->state == STATE_SETTING_UP) ff_thread_finish_setup(avctx);
 
@@ -367,6 +846,22 @@ static int update_context_from_thread(AVCodecContext *dst, AVCodecContext *src,
     return err;
 }
 
+/**
+ * Updates the user's AVCodecContext with values set by an encoding thread.
+ *
+ * @param dst The user's context.
+ * @param src The encoding thread's context.
+ */
+static void update_context_from_encoder(AVCodecContext *dst, AVCodecContext *src)
+{
+    dst->coded_frame    = src->coded_frame;
+    dst->extradata      = src->extradata;
+    dst->extradata_size = src->extradata_size;
+    dst->has_b_frames   = src->has_b_frames;
+
+    dst->bits_per_coded_sample = src->bits_per_coded_sample;
+}
+
 /**
  * Update the next thread's AVCodecContext with values set by the user.
  *
@@ -397,12 +892,17 @@ static void update_context_from_user(AVCodecContext *dst, AVCodecContext *src)
 #undef copy_fields
 }
 
+static int progress_index(PerThreadContext *p, volatile int *progress)
+{
+    return (progress - p->progress[0]) / 2;
+}
+
 static void free_progress(AVFrame *f)
 {
     PerThreadContext *p = f->owner->thread_opaque;
-    int *progress = f->thread_opaque;
+    volatile int *progress = f->thread_opaque;
 
-    p->progress_used[(progress - p->progress[0]) / 2] = 0;
+    p->progress_used[progress_index(p, progress)] = 0;
 }
 
 /// Releases the buffers that this decoding thread was the last user of.
@@ -417,7 +917,6 @@ static void release_delayed_buffers(PerThreadContext *p)
         f = &p->released_buffers[--p->num_released_buffers];
         free_progress(f);
         f->thread_opaque = NULL;
-
         f->owner->release_buffer(f->owner, f);
         pthread_mutex_unlock(&fctx->buffer_mutex);
     }
@@ -430,7 +929,13 @@ static int submit_packet(PerThreadContext *p, AVPacket *avpkt)
     AVCodec *codec = p->avctx->codec;
     uint8_t *buf = p->avpkt.data;
 
-    if (!avpkt->size && !(codec->capabilities & CODEC_CAP_DELAY)) return 0;
+    p->reinit = 0;
+
+    if (!avpkt->size && !(codec->capabilities & CODEC_CAP_DELAY)) {
+        /* nothing to keep for frame_thread_reinit() */
+        p->avpkt.size = 0;
+        return 0;
+    }
 
     pthread_mutex_lock(&p->mutex);
 
@@ -450,6 +955,12 @@ static int submit_packet(PerThreadContext *p, AVPacket *avpkt)
             pthread_mutex_unlock(&p->mutex);
             return err;
         }
+
+        /*
+         * The codec is reopened before this packet can be decoded,
+         * so only keep it until then.
+         */
+        p->reinit = prev_thread->reinit;
     }
 
     av_fast_malloc(&buf, &p->allocated_buf_size, avpkt->size + FF_INPUT_BUFFER_PADDING_SIZE);
@@ -458,6 +969,14 @@ static int submit_packet(PerThreadContext *p, AVPacket *avpkt)
     memcpy(buf, avpkt->data, avpkt->size);
     memset(buf + avpkt->size, 0, FF_INPUT_BUFFER_PADDING_SIZE);
 
+    if (p->reinit) {
+        p->got_frame = 0;
+        p->result    = 0;
+        pthread_mutex_unlock(&p->mutex);
+        fctx->prev_thread = p;
+        return 0;
+    }
+
     p->state = STATE_SETTING_UP;
     pthread_cond_signal(&p->input_cond);
     pthread_mutex_unlock(&p->mutex);
@@ -489,35 +1008,120 @@ static int submit_packet(PerThreadContext *p, AVPacket *avpkt)
     return 0;
 }
 
-int ff_thread_decode_frame(AVCodecContext *avctx,
-                           AVFrame *picture, int *got_picture_ptr,
-                           AVPacket *avpkt)
+static int frame_thread_reinit(AVCodecContext *avctx);
+
+/**
+ * Returns the output of the oldest thread holding any.
+ * @return AVERROR(EAGAIN) if it has not finished and wait is not set,
+ *         the result of its decode() call otherwise
+ */
+static int finish_frame(AVCodecContext *avctx, AVFrame *picture, int *got_picture_ptr, int wait)
 {
     FrameThreadContext *fctx = avctx->thread_opaque;
-    int finished = fctx->next_finished;
-    PerThreadContext *p;
-    int err;
+    PerThreadContext *p = &fctx->threads[fctx->next_finished];
+
+    if (p->state != STATE_INPUT_READY) {
+        int ready;
+
+        pthread_mutex_lock(&p->progress_mutex);
+        while (wait && p->state != STATE_INPUT_READY)
+            pthread_cond_wait(&p->output_cond, &p->progress_mutex);
+        ready = p->state == STATE_INPUT_READY;
+        pthread_mutex_unlock(&p->progress_mutex);
+
+        if (!ready)
+            return AVERROR(EAGAIN);
+    }
+
+    if (p->reinit) {
+        if (!fctx->reinited) {
+            int err = frame_thread_reinit(avctx);
+            if (err < 0)
+                return err;
+            return wait ? finish_frame(avctx, picture, got_picture_ptr, wait) : AVERROR(EAGAIN);
+        }
+        av_log(avctx, AV_LOG_ERROR, "Stream parameters still change after reopening the codec.\n");
+        p->got_frame = 0;
+        p->result    = AVERROR_INVALIDDATA;
+    }
+    fctx->reinited = 0;
+    *picture = p->frame;
+    *got_picture_ptr = p->got_frame;
+    picture->pkt_dts = p->avpkt.dts;
 
     /*
-     * Submit a packet to the next decoding thread.
+     * A later call with avkpt->size == 0 may loop over all threads,
+     * including this one, searching for a frame to return.
+     * Make sure we don't mistakenly return the same frame again.
      */
+    p->got_frame = 0;
+
+    update_context_from_thread(avctx, p->avctx, 1);
+
+    if (++fctx->next_finished >= avctx->thread_count)
+        fctx->next_finished = 0;
+    fctx->in_flight--;
+
+    return p->result;
+}
+
+/**
+ * Submits a packet to the next decoding thread.
+ */
+static int start_frame(AVCodecContext *avctx, AVPacket *avpkt)
+{
+    FrameThreadContext *fctx = avctx->thread_opaque;
+    PerThreadContext *p = &fctx->threads[fctx->next_decoding];
+    int err;
 
-    p = &fctx->threads[fctx->next_decoding];
     update_context_from_user(p->avctx, avctx);
     err = submit_packet(p, avpkt);
     if (err) return err;
 
-    fctx->next_decoding++;
+    if (++fctx->next_decoding >= avctx->thread_count)
+        fctx->next_decoding = 0;
+    fctx->in_flight++;
 
-    /*
-     * If we're still receiving the initial packets, don't return a frame.
-     */
+    return 0;
+}
 
-    if (fctx->delaying && avpkt->size) {
-        if (fctx->next_decoding >= (avctx->thread_count-1)) fctx->delaying = 0;
+int ff_thread_decode_frame(AVCodecContext *avctx,
+                           AVFrame *picture, int *got_picture_ptr,
+                           AVPacket *avpkt)
+{
+    FrameThreadContext *fctx = avctx->thread_opaque;
+    int err, ret;
 
-        *got_picture_ptr=0;
-        return 0;
+    if (fctx->in_flight < avctx->thread_count) {
+        /*
+         * Submit a packet to the next decoding thread.
+         */
+
+        err = start_frame(avctx, avpkt);
+        if (err) return err;
+
+        /*
+         * If we're still receiving the initial packets, don't return a frame.
+         */
+
+        if (fctx->delaying && avpkt->size) {
+            if (fctx->in_flight >= (avctx->thread_count-1)) fctx->delaying = 0;
+
+            *got_picture_ptr=0;
+            return 0;
+        }
+    } else {
+        /*
+         * After ff_thread_decode_frame_nonblock() every thread may hold
+         * output, so the oldest one is returned before its thread can take
+         * the packet.
+         */
+
+        err = finish_frame(avctx, picture, got_picture_ptr, 1);
+        if (!avctx->thread_opaque) return err;
+        ret = start_frame(avctx, avpkt);
+        if (ret) return ret;
+        if (*got_picture_ptr || avpkt->size) return err;
     }
 
     /*
@@ -528,35 +1132,139 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
      */
 
     do {
-        p = &fctx->threads[finished++];
+        err = finish_frame(avctx, picture, got_picture_ptr, 1);
+        /* the codec may have been reopened */
+        fctx = avctx->thread_opaque;
+    } while (fctx && !avpkt->size && !*got_picture_ptr && fctx->in_flight);
 
-        if (p->state != STATE_INPUT_READY) {
-            pthread_mutex_lock(&p->progress_mutex);
-            while (p->state != STATE_INPUT_READY)
-                pthread_cond_wait(&p->output_cond, &p->progress_mutex);
-            pthread_mutex_unlock(&p->progress_mutex);
-        }
+    return err;
+}
 
-        *picture = p->frame;
-        *got_picture_ptr = p->got_frame;
-        picture->pkt_dts = p->avpkt.dts;
+int ff_thread_decode_frame_nonblock(AVCodecContext *avctx,
+                                    AVFrame *picture, int *got_picture_ptr,
+                                    AVPacket *avpkt)
+{
+    FrameThreadContext *fctx = avctx->thread_opaque;
+    int ret = 0, err;
 
-        /*
-         * A later call with avkpt->size == 0 may loop over all threads,
-         * including this one, searching for a frame to return before being
-         * stopped by the "finished != fctx->next_finished" condition.
-         * Make sure we don't mistakenly return the same frame again.
-         */
-        p->got_frame = 0;
+    /* Threads are started as soon as packets arrive, no need to delay. */
+    fctx->delaying = 0;
+
+    *got_picture_ptr = 0;
+    while (fctx->in_flight && !*got_picture_ptr) {
+        ret = finish_frame(avctx, picture, got_picture_ptr, 0);
+        fctx = avctx->thread_opaque;
+        if (ret < 0) break;
+    }
+    if (ret == AVERROR(EAGAIN))
+        ret = 0;
+
+    if (avpkt && fctx) {
+        if (fctx->in_flight == avctx->thread_count)
+            return AVERROR(EAGAIN);
+        /* taken even if the returned frame failed, as documented */
+        err = start_frame(avctx, avpkt);
+        if (err) return err;
+        if (ret >= 0)
+            ret = avpkt->size;
+    }
 
-        if (finished >= avctx->thread_count) finished = 0;
-    } while (!avpkt->size && !*got_picture_ptr && finished != fctx->next_finished);
+    return ret;
+}
 
-    update_context_from_thread(avctx, p->avctx, 1);
+static int submit_frame(PerThreadContext *p, int buf_size, const AVFrame *pict)
+{
+    AVCodecContext *avctx = p->avctx;
+    uint8_t *buf = p->avpkt.data;
+
+    pthread_mutex_lock(&p->mutex);
+
+    if (!p->input.data[0] &&
+        av_image_alloc(p->input.data, p->input.linesize,
+                       avctx->width, avctx->height, avctx->pix_fmt, 16) < 0) {
+        pthread_mutex_unlock(&p->mutex);
+        return AVERROR(ENOMEM);
+    }
+
+    av_fast_malloc(&buf, &p->allocated_buf_size, buf_size);
+    if (!buf) {
+        p->allocated_buf_size = 0;
+        pthread_mutex_unlock(&p->mutex);
+        return AVERROR(ENOMEM);
+    }
+    p->avpkt.data = buf;
+    p->avpkt.size = buf_size;
+
+    /*
+     * The user may overwrite the picture as soon as we return,
+     * so the thread encodes from its own copy.
+     */
+    p->frame = *pict;
+    memcpy(p->frame.data,     p->input.data,     sizeof(p->frame.data));
+    memcpy(p->frame.linesize, p->input.linesize, sizeof(p->frame.linesize));
+    av_picture_copy((AVPicture*)&p->frame, (const AVPicture*)pict,
+                    avctx->pix_fmt, avctx->width, avctx->height);
+
+    p->got_frame = 1;
+    p->state     = STATE_SETTING_UP;
+    pthread_cond_signal(&p->input_cond);
+    pthread_mutex_unlock(&p->mutex);
+
+    return 0;
+}
+
+int ff_thread_encode_video(AVCodecContext *avctx, uint8_t *buf, int buf_size,
+                           const AVFrame *pict)
+{
+    FrameThreadContext *fctx = avctx->thread_opaque;
+    PerThreadContext *p;
+    int err;
+
+    /*
+     * Submit the picture to the next encoding thread.
+     * Until every thread holds a picture, don't return a packet.
+     */
+
+    if (pict) {
+        p = &fctx->threads[fctx->next_decoding];
+        update_context_from_user(p->avctx, avctx);
+        err = submit_frame(p, buf_size, pict);
+        if (err) return err;
+
+        if (++fctx->next_decoding >= avctx->thread_count) fctx->next_decoding = 0;
+
+        if (!fctx->threads[fctx->next_decoding].got_frame)
+            return 0;
+    }
+
+    /*
+     * Return the packet of the oldest thread. Threads are filled and
+     * emptied in the same order, so at the end of the stream there is
+     * nothing left once the oldest thread has no picture.
+     */
+
+    p = &fctx->threads[fctx->next_finished];
+    if (!p->got_frame)
+        return 0;
+
+    if (p->state != STATE_INPUT_READY) {
+        pthread_mutex_lock(&p->progress_mutex);
+        while (p->state != STATE_INPUT_READY)
+            pthread_cond_wait(&p->output_cond, &p->progress_mutex);
+        pthread_mutex_unlock(&p->progress_mutex);
+    }
 
-    if (fctx->next_decoding >= avctx->thread_count) fctx->next_decoding = 0;
+    p->got_frame = 0;
+    if (++fctx->next_finished >= avctx->thread_count) fctx->next_finished = 0;
 
-    fctx->next_finished = finished;
+    update_context_from_encoder(avctx, p->avctx);
+
+    if (p->result > buf_size) {
+        av_log(avctx, AV_LOG_ERROR, "encoded frame too large for the output buffer\n");
+        return -1;
+    }
+    if (p->result > 0)
+        memcpy(buf, p->avpkt.data, p->result);
 
     return p->result;
 }
@@ -564,37 +1272,79 @@ int ff_thread_decode_frame(AVCodecContext *avctx,
 void ff_thread_report_progress(AVFrame *f, int n, int field)
 {
     PerThreadContext *p;
-    int *progress = f->thread_opaque;
+    volatile int *progress = f->thread_opaque;
+    int idx;
 
     if (!progress || progress[field] >= n) return;
 
-    p = f->owner->thread_opaque;
+    p   = f->owner->thread_opaque;
+    idx = progress_index(p, progress);
 
     if (f->owner->debug&FF_DEBUG_THREADS)
         av_log(f->owner, AV_LOG_DEBUG, "%p finished %d field %d\n", progress, n, field);
 
+#if HAVE_SYNC_FETCH_AND_ADD
+    /* publish the decoded rows before the progress value, and the progress
+     * value before looking for sleeping threads; a thread going to sleep
+     * registers itself before checking the value again */
+    memory_barrier();
+    progress[field] = n;
+    memory_barrier();
+    if (!p->progress_waiters[idx])
+        return;
+#endif
+
     pthread_mutex_lock(&p->progress_mutex);
     progress[field] = n;
-    pthread_cond_broadcast(&p->progress_cond);
+    pthread_cond_broadcast(&p->progress_conds[idx]);
     pthread_mutex_unlock(&p->progress_mutex);
 }
 
 void ff_thread_await_progress(AVFrame *f, int n, int field)
 {
     PerThreadContext *p;
-    int *progress = f->thread_opaque;
+    volatile int *progress = f->thread_opaque;
+    int idx, i;
 
-    if (!progress || progress[field] >= n) return;
+    if (!progress) return;
+    if (progress[field] >= n) {
+        memory_barrier();
+        return;
+    }
 
-    p = f->owner->thread_opaque;
+    p   = f->owner->thread_opaque;
+    idx = progress_index(p, progress);
 
     if (f->owner->debug&FF_DEBUG_THREADS)
         av_log(f->owner, AV_LOG_DEBUG, "thread awaiting %d field %d from %p\n", n, field, progress);
 
+#if HAVE_SYNC_FETCH_AND_ADD
+    for (i = 0; i < p->parent->spin_count; i++) {
+        if (progress[field] >= n) {
+            memory_barrier();
+            return;
+        }
+    }
+#endif
+
+    set_running(p->parent, -1);
+
     pthread_mutex_lock(&p->progress_mutex);
+    p->progress_waiters[idx]++;
+    memory_barrier();
     while (progress[field] < n)
-        pthread_cond_wait(&p->progress_cond, &p->progress_mutex);
+        pthread_cond_wait(&p->progress_conds[idx], &p->progress_mutex);
+    p->progress_waiters[idx]--;
     pthread_mutex_unlock(&p->progress_mutex);
+
+    set_running(p->parent, 1);
+}
+
+void ff_thread_request_reinit(AVCodecContext *avctx)
+{
+    PerThreadContext *p = avctx->thread_opaque;
+
+    p->reinit = 1;
 }
 
 void ff_thread_finish_setup(AVCodecContext *avctx) {
@@ -629,14 +1379,20 @@ static void frame_thread_free(AVCodecContext *avctx, int thread_count)
 {
     FrameThreadContext *fctx = avctx->thread_opaque;
     AVCodec *codec = avctx->codec;
-    int i;
+    int i, j;
 
     park_frame_worker_threads(fctx, thread_count);
 
     if (fctx->prev_thread)
         update_context_from_thread(fctx->threads->avctx, fctx->prev_thread->avctx, 0);
 
+    pthread_mutex_lock(&fctx->slice_mutex);
     fctx->die = 1;
+    pthread_cond_broadcast(&fctx->slice_cond);
+    pthread_mutex_unlock(&fctx->slice_mutex);
+
+    for (i = 0; i < fctx->slice_worker_count; i++)
+        pthread_join(fctx->slice_workers[i], NULL);
 
     for (i = 0; i < thread_count; i++) {
         PerThreadContext *p = &fctx->threads[i];
@@ -645,11 +1401,17 @@ static void frame_thread_free(AVCodecContext *avctx, int thread_count)
         pthread_cond_signal(&p->input_cond);
         pthread_mutex_unlock(&p->mutex);
 
-        pthread_join(p->thread, NULL);
+        if (p->thread_init)
+            pthread_join(p->thread, NULL);
 
         if (codec->close)
             codec->close(p->avctx);
 
+        if (codec->encode) {
+            av_freep(&p->avctx->extradata);
+            av_freep(&p->input.data[0]);
+        }
+
         avctx->codec = NULL;
 
         release_delayed_buffers(p);
@@ -665,6 +1427,9 @@ static void frame_thread_free(AVCodecContext *avctx, int thread_count)
         pthread_cond_destroy(&p->input_cond);
         pthread_cond_destroy(&p->progress_cond);
         pthread_cond_destroy(&p->output_cond);
+        for (j = 0; j < MAX_BUFFERS; j++)
+            pthread_cond_destroy(&p->progress_conds[j]);
+        pthread_cond_destroy(&p->slice_done_cond);
         av_freep(&p->avpkt.data);
 
         if (i)
@@ -674,8 +1439,17 @@ static void frame_thread_free(AVCodecContext *avctx, int thread_count)
     }
 
     av_freep(&fctx->threads);
+    av_freep(&fctx->slice_workers);
+    av_freep(&fctx->priv_data);
     pthread_mutex_destroy(&fctx->buffer_mutex);
+    pthread_mutex_destroy(&fctx->slice_mutex);
+    pthread_cond_destroy(&fctx->slice_cond);
     av_freep(&avctx->thread_opaque);
+
+    if (codec->encode) {
+        avctx->extradata      = NULL;
+        avctx->extradata_size = 0;
+    }
 }
 
 static int frame_thread_init(AVCodecContext *avctx)
@@ -684,18 +1458,33 @@ static int frame_thread_init(AVCodecContext *avctx)
     AVCodec *codec = avctx->codec;
     AVCodecContext *src = avctx;
     FrameThreadContext *fctx;
-    int i, err = 0;
+    void *priv_data = NULL;
+    int i, j, err = 0, use_pool;
 
     if (thread_count <= 1) {
         avctx->active_thread_type = 0;
         return 0;
     }
 
+    /*
+     * Each encoding thread runs its own instance of the encoder,
+     * set up from the options the user gave before any init() call.
+     * Decoders keep these to reopen the codec in frame_thread_reinit().
+     */
+    priv_data = av_malloc(codec->priv_data_size);
+    if (!priv_data)
+        return AVERROR(ENOMEM);
+    memcpy(priv_data, avctx->priv_data, codec->priv_data_size);
+
     avctx->thread_opaque = fctx = av_mallocz(sizeof(FrameThreadContext));
 
     fctx->threads = av_mallocz(sizeof(PerThreadContext) * thread_count);
     pthread_mutex_init(&fctx->buffer_mutex, NULL);
+    pthread_mutex_init(&fctx->slice_mutex, NULL);
+    pthread_cond_init(&fctx->slice_cond, NULL);
     fctx->delaying = 1;
+    use_pool = thread_pool_active();
+    fctx->spin_count = get_logical_cpus() > 1 ? PROGRESS_SPIN_COUNT : 0;
 
     for (i = 0; i < thread_count; i++) {
         AVCodecContext *copy = av_malloc(sizeof(AVCodecContext));
@@ -706,6 +1495,9 @@ static int frame_thread_init(AVCodecContext *avctx)
         pthread_cond_init(&p->input_cond, NULL);
         pthread_cond_init(&p->progress_cond, NULL);
         pthread_cond_init(&p->output_cond, NULL);
+        for (j = 0; j < MAX_BUFFERS; j++)
+            pthread_cond_init(&p->progress_conds[j], NULL);
+        pthread_cond_init(&p->slice_done_cond, NULL);
 
         p->parent = fctx;
         p->avctx  = copy;
@@ -714,7 +1506,27 @@ static int frame_thread_init(AVCodecContext *avctx)
         copy->thread_opaque = p;
         copy->pkt = &p->avpkt;
 
-        if (!i) {
+        if (avctx->active_thread_type & FF_THREAD_SLICE) {
+            copy->execute  = use_pool ? thread_pool_execute  : frame_thread_execute;
+            copy->execute2 = use_pool ? thread_pool_execute2 : frame_thread_execute2;
+        }
+
+        if (codec->encode) {
+            copy->thread_count = 1;
+
+            if (i) {
+                copy->priv_data = av_malloc(codec->priv_data_size);
+                memcpy(copy->priv_data, priv_data, codec->priv_data_size);
+                copy->extradata      = NULL;
+                copy->extradata_size = 0;
+            }
+
+            if (codec->init)
+                err = codec->init(copy);
+
+            if (!i)
+                update_context_from_encoder(avctx, copy);
+        } else if (!i) {
             src = copy;
 
             if (codec->init)
@@ -732,20 +1544,124 @@ static int frame_thread_init(AVCodecContext *avctx)
 
         if (err) goto error;
 
-        pthread_create(&p->thread, NULL, frame_worker_thread, p);
+        p->thread_init = !pthread_create(&p->thread, NULL, frame_worker_thread, p);
+        if (!p->thread_init) {
+            err = AVERROR(ENOMEM);
+            goto error;
+        }
+    }
+
+    if (codec->encode)
+        av_free(priv_data);
+    else
+        fctx->priv_data = priv_data;
+
+    /*
+     * The frame threads run their own slice jobs as well, so one
+     * slice worker less than threads is enough to keep all cores busy.
+     */
+    if (avctx->active_thread_type & FF_THREAD_SLICE && !use_pool) {
+        fctx->slice_workers = av_mallocz(sizeof(pthread_t) * (thread_count - 1));
+        if (!fctx->slice_workers) {
+            err = AVERROR(ENOMEM);
+            goto error_threads;
+        }
+        for (; fctx->slice_worker_count < thread_count - 1; fctx->slice_worker_count++)
+            if (pthread_create(&fctx->slice_workers[fctx->slice_worker_count], NULL,
+                               slice_worker_thread, fctx)) {
+                err = AVERROR(ENOMEM);
+                goto error_threads;
+            }
     }
 
     return 0;
 
+error_threads:
+    frame_thread_free(avctx, thread_count);
+
+    return err;
+
 error:
+    av_free(priv_data);
     frame_thread_free(avctx, i+1);
 
     return err;
 }
 
+/**
+ * Reopens the codec after a decoding thread called ff_thread_request_reinit().
+ * All threads are finished, and the packets of the requesting thread and
+ * the ones after it are decoded again by the new threads.
+ * If no threads can be started, the codec is reopened without frame threading.
+ */
+static int frame_thread_reinit(AVCodecContext *avctx)
+{
+    FrameThreadContext *fctx = avctx->thread_opaque;
+    PerThreadContext *p = &fctx->threads[fctx->next_finished];
+    AVCodec *codec = avctx->codec;
+    int thread_count = avctx->thread_count;
+    int nb_pkts = fctx->in_flight;
+    void *priv_data = fctx->priv_data;
+    AVPacket *pkts;
+    int i, err;
+
+    park_frame_worker_threads(fctx, thread_count);
+    pkts = av_malloc(sizeof(AVPacket) * nb_pkts);
+    if (!pkts)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < nb_pkts; i++) {
+        PerThreadContext *t = &fctx->threads[(fctx->next_finished + i) % thread_count];
+
+        pkts[i] = t->avpkt;
+        pkts[i].side_data       = NULL;
+        pkts[i].side_data_elems = 0;
+        t->avpkt.data          = NULL;
+        t->allocated_buf_size  = 0;
+    }
+
+    av_log(avctx, AV_LOG_DEBUG, "Reopening the codec for %dx%d\n",
+           p->avctx->width, p->avctx->height);
+
+    avctx->width        = p->avctx->width;
+    avctx->height       = p->avctx->height;
+    avctx->coded_width  = p->avctx->coded_width;
+    avctx->coded_height = p->avctx->coded_height;
+    avctx->has_b_frames = p->avctx->has_b_frames; // without the thread delay
+
+    fctx->priv_data = NULL;
+    frame_thread_free(avctx, thread_count);
+    avctx->codec = codec;
+
+    memcpy(avctx->priv_data, priv_data, codec->priv_data_size);
+    err = frame_thread_init(avctx);
+    if (err < 0) {
+        av_log(avctx, AV_LOG_ERROR, "Reopening the codec with threads failed.\n");
+        memcpy(avctx->priv_data, priv_data, codec->priv_data_size);
+        avctx->active_thread_type = 0;
+        if (codec->init && codec->init(avctx) < 0)
+            avctx->codec = NULL;
+    } else {
+        fctx = avctx->thread_opaque;
+        for (i = 0; i < nb_pkts && !err; i++)
+            err = start_frame(avctx, &pkts[i]);
+        if (fctx->in_flight >= thread_count - 1)
+            fctx->delaying = 0;
+        fctx->reinited = 1;
+    }
+
+    for (i = 0; i < nb_pkts; i++)
+        av_free(pkts[i].data);
+    av_free(pkts);
+    av_free(priv_data);
+
+    return err;
+}
+
 void ff_thread_flush(AVCodecContext *avctx)
 {
     FrameThreadContext *fctx = avctx->thread_opaque;
+    int i;
 
     if (!avctx->thread_opaque) return;
 
@@ -757,7 +1673,12 @@ void ff_thread_flush(AVCodecContext *avctx)
             avctx->codec->flush(fctx->threads[0].avctx);
     }
 
+    if (avctx->codec->encode)
+        for (i = 0; i < avctx->thread_count; i++)
+            fctx->threads[i].got_frame = 0;
+
     fctx->next_decoding = fctx->next_finished = 0;
+    fctx->in_flight = 0;
     fctx->delaying = 1;
     fctx->prev_thread = NULL;
 }
@@ -786,7 +1707,8 @@ int ff_thread_get_buffer(AVCodecContext *avctx, AVFrame *f)
 
     f->owner = avctx;
 
-    if (!(avctx->active_thread_type&FF_THREAD_FRAME)) {
+    /* encoding threads never share pictures with each other */
+    if (!(avctx->active_thread_type&FF_THREAD_FRAME) || avctx->codec->encode) {
         f->thread_opaque = NULL;
         return avctx->get_buffer(avctx, f);
     }
@@ -845,7 +1767,7 @@ void ff_thread_release_buffer(AVCodecContext *avctx, AVFrame *f)
     PerThreadContext *p = avctx->thread_opaque;
     FrameThreadContext *fctx;
 
-    if (!(avctx->active_thread_type&FF_THREAD_FRAME)) {
+    if (!(avctx->active_thread_type&FF_THREAD_FRAME) || avctx->codec->encode) {
         avctx->release_buffer(avctx, f);
         return;
     }
@@ -872,21 +1794,51 @@ void ff_thread_release_buffer(AVCodecContext *avctx, AVFrame *f)
  * Threading requires more than one thread.
  * Frame threading requires entire frames to be passed to the codec,
  * and introduces extra decoding delay, so is incompatible with low_delay.
+ * Encoders are only frame threaded if they code each frame on its own,
+ * so two-pass statistics, which are gathered in coding order, rule it out,
+ * as do the inter frame options of ffv1 and huffyuv.
+ * Decoders supporting both methods only use both, with the slices of all
+ * frames sharing one set of workers, if FF_THREAD_FRAME_SLICE is set.
  *
  * @param avctx The context.
  */
+static int encoder_intra_only(AVCodecContext *avctx)
+{
+    switch (avctx->codec_id) {
+    case CODEC_ID_FFV1:
+        return avctx->gop_size == 1;
+    case CODEC_ID_HUFFYUV:
+    case CODEC_ID_FFVHUFF:
+        return avctx->context_model != 1;
+    default:
+        return 1;
+    }
+}
+
 static void validate_thread_parameters(AVCodecContext *avctx)
 {
+    int thread_type = avctx->thread_type;
     int frame_threading_supported = (avctx->codec->capabilities & CODEC_CAP_FRAME_THREADS)
                                 && !(avctx->flags & CODEC_FLAG_TRUNCATED)
                                 && !(avctx->flags & CODEC_FLAG_LOW_DELAY)
-                                && !(avctx->flags2 & CODEC_FLAG2_CHUNKS);
+                                && !(avctx->flags2 & CODEC_FLAG2_CHUNKS)
+                                && !(avctx->codec->encode &&
+                                     (avctx->flags & (CODEC_FLAG_PASS1 | CODEC_FLAG_PASS2) ||
+                                      !encoder_intra_only(avctx)));
+
+    if (thread_type & FF_THREAD_FRAME_SLICE)
+        thread_type |= FF_THREAD_FRAME | FF_THREAD_SLICE;
+
     if (avctx->thread_count == 1) {
         avctx->active_thread_type = 0;
-    } else if (frame_threading_supported && (avctx->thread_type & FF_THREAD_FRAME)) {
+    } else if (frame_threading_supported && (thread_type & FF_THREAD_FRAME)) {
         avctx->active_thread_type = FF_THREAD_FRAME;
+        if (avctx->codec->decode &&
+            avctx->codec->capabilities & CODEC_CAP_SLICE_THREADS &&
+            thread_type & FF_THREAD_FRAME_SLICE)
+            avctx->active_thread_type |= FF_THREAD_SLICE;
     } else if (avctx->codec->capabilities & CODEC_CAP_SLICE_THREADS &&
-               avctx->thread_type & FF_THREAD_SLICE) {
+               thread_type & FF_THREAD_SLICE) {
         avctx->active_thread_type = FF_THREAD_SLICE;
     }
 }
@@ -901,10 +1853,10 @@ int ff_thread_init(AVCodecContext *avctx)
     if (avctx->codec) {
         validate_thread_parameters(avctx);
 
-        if (avctx->active_thread_type&FF_THREAD_SLICE)
-            return thread_init(avctx);
-        else if (avctx->active_thread_type&FF_THREAD_FRAME)
+        if (avctx->active_thread_type&FF_THREAD_FRAME)
             return frame_thread_init(avctx);
+        else if (avctx->active_thread_type&FF_THREAD_SLICE)
+            return thread_init(avctx);
     }
 
     return 0;
@@ -917,3 +1869,118 @@ void ff_thread_free(AVCodecContext *avctx)
     else
         thread_free(avctx);
 }
+
+#ifdef TEST
+#include <stdio.h>
+#include <sys/time.h>
+
+#undef printf
+
+/* frames in flight and macroblock rows of a 1080p picture */
+#define BENCH_FRAMES    32
+#define BENCH_ROWS      68
+#define BENCH_ROUNDS    20
+#define MAX_CONSUMERS   8
+
+static AVCodecContext     bench_avctx;
+static FrameThreadContext bench_fctx;
+static PerThreadContext   bench_thread;
+static AVFrame            bench_frames[BENCH_FRAMES];
+static int                bench_work;
+
+/* stand-in for decoding one macroblock row */
+static void bench_row(void)
+{
+    volatile int i;
+
+    for (i = 0; i < bench_work; i++);
+}
+
+/* a thread decoding the next frame, which references every row of the
+ * frames decoded by the producer */
+static void *bench_consumer(void *arg)
+{
+    int i, row;
+
+    for (i = 0; i < BENCH_FRAMES; i++) {
+        for (row = 0; row < BENCH_ROWS; row++) {
+            ff_thread_await_progress(&bench_frames[i], row, 0);
+            bench_row();
+        }
+    }
+    return NULL;
+}
+
+static int64_t bench_time(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/* returns the time per row in ns */
+static double bench_run(int nb_consumers)
+{
+    pthread_t consumers[MAX_CONSUMERS];
+    int64_t total = 0, start;
+    int round, i, row;
+
+    for (round = 0; round < BENCH_ROUNDS; round++) {
+        for (i = 0; i < BENCH_FRAMES; i++) {
+            int *progress = bench_frames[i].thread_opaque;
+            progress[0] = progress[1] = -1;
+        }
+
+        for (i = 0; i < nb_consumers; i++)
+            pthread_create(&consumers[i], NULL, bench_consumer, NULL);
+
+        start = bench_time();
+        for (i = 0; i < BENCH_FRAMES; i++) {
+            for (row = 0; row < BENCH_ROWS; row++) {
+                bench_row();
+                ff_thread_report_progress(&bench_frames[i], row, 0);
+            }
+        }
+        for (i = 0; i < nb_consumers; i++)
+            pthread_join(consumers[i], NULL);
+        total += bench_time() - start;
+    }
+
+    return total * 1000.0 / (BENCH_ROUNDS * BENCH_FRAMES * BENCH_ROWS);
+}
+
+int main(void)
+{
+    static const int work[] = { 0, 1000, 10000 };
+    int i, j;
+
+    bench_avctx.thread_opaque = &bench_thread;
+    bench_thread.parent       = &bench_fctx;
+    bench_thread.avctx        = &bench_avctx;
+    bench_fctx.spin_count     = get_logical_cpus() > 1 ? PROGRESS_SPIN_COUNT : 0;
+    pthread_mutex_init(&bench_thread.progress_mutex, NULL);
+    for (i = 0; i < MAX_BUFFERS; i++)
+        pthread_cond_init(&bench_thread.progress_conds[i], NULL);
+
+    for (i = 0; i < BENCH_FRAMES; i++) {
+        bench_frames[i].owner         = &bench_avctx;
+        bench_frames[i].thread_opaque = allocate_progress(&bench_thread);
+    }
+
+    printf("%d cpus, %s progress, spin count %d\n", get_logical_cpus(),
+           HAVE_SYNC_FETCH_AND_ADD ? "lock-free" : "locked", bench_fctx.spin_count);
+    /* without work per row, the time is the cost of the synchronization */
+    printf(" work  waiters  ns/row\n");
+    for (i = 0; i < FF_ARRAY_ELEMS(work); i++) {
+        bench_work = work[i];
+        for (j = 0; j <= 3; j++)
+            printf("%5d  %7d  %6.0f\n", work[i], j, bench_run(j));
+    }
+
+    for (i = 0; i < MAX_BUFFERS; i++)
+        pthread_cond_destroy(&bench_thread.progress_conds[i]);
+    pthread_mutex_destroy(&bench_thread.progress_mutex);
+    return 0;
+}
+#endif
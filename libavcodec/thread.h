@@ -48,6 +48,41 @@ void ff_thread_flush(AVCodecContext *avctx);
 int ff_thread_decode_frame(AVCodecContext *avctx, AVFrame *picture,
                            int *got_picture_ptr, AVPacket *avpkt);
 
+/**
+ * Returns the frame of the oldest decoding thread if it is finished,
+ * and submits avpkt, if not NULL, to the next thread if it is idle.
+ * Never waits for decoding threads.
+ *
+ * Parameters and return value are the same as avcodec_decode_video_nonblock().
+ */
+int ff_thread_decode_frame_nonblock(AVCodecContext *avctx, AVFrame *picture,
+                                    int *got_picture_ptr, AVPacket *avpkt);
+
+/**
+ * Submits a new picture to an encoding thread.
+ * Returns the packet of the oldest picture that finished encoding,
+ * which lags the input by thread_count - 1 pictures. Pass a NULL
+ * picture at the end of the stream to get the remaining packets.
+ *
+ * Parameters are the same as avcodec_encode_video().
+ */
+int ff_thread_encode_video(AVCodecContext *avctx, uint8_t *buf, int buf_size,
+                           const AVFrame *pict);
+
+/**
+ * Call this from a frame threaded decoder when the stream changes in a way
+ * update_thread_context() cannot follow, like a new picture size, and
+ * return from decode() without decoding the packet.
+ *
+ * Once the frames of all earlier packets have been returned, the codec is
+ * reopened with the width and height of avctx, which the codec may set to
+ * the new size first, and the packet is decoded again.
+ * Must be called before ff_thread_finish_setup().
+ *
+ * @param avctx The context.
+ */
+void ff_thread_request_reinit(AVCodecContext *avctx);
+
 /**
  * If the codec defines update_thread_context(), call this
  * when they are ready for the next thread to start decoding
@@ -0,0 +1,78 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Fixture shared by the threading tests.
+ */
+
+#include "libavutil/adler32.h"
+#include "threadtest.h"
+
+AVPacket *ff_threadtest_new_packet(ThreadTestStream *s, int size)
+{
+    AVPacket *pkt;
+
+    if (s->nb_packets == THREADTEST_MAX_PACKETS)
+        return NULL;
+    pkt = &s->packets[s->nb_packets];
+    if (av_new_packet(pkt, size) < 0)
+        return NULL;
+    s->nb_packets++;
+    return pkt;
+}
+
+void ff_threadtest_free_stream(ThreadTestStream *s)
+{
+    int i;
+
+    for (i = 0; i < s->nb_packets; i++)
+        av_free_packet(&s->packets[i]);
+    s->nb_packets = 0;
+}
+
+void ff_threadtest_fill_picture(AVFrame *pic, int width, int height, int n)
+{
+    int x, y;
+
+    for (y = 0; y < height; y++)
+        for (x = 0; x < width; x++)
+            pic->data[0][y * pic->linesize[0] + x] = x * y / 64 + 3 * x + 2 * y + 5 * n;
+    for (y = 0; y < height / 2; y++) {
+        for (x = 0; x < width / 2; x++) {
+            pic->data[1][y * pic->linesize[1] + x] = 128 + (x ^ y) + n;
+            pic->data[2][y * pic->linesize[2] + x] = 64 + x - y - n;
+        }
+    }
+}
+
+uint32_t ff_threadtest_checksum(uint8_t * const data[4], const int linesize[4],
+                                int width, int height)
+{
+    uint32_t sum = 1;
+    int plane, y;
+
+    for (plane = 0; plane < 3; plane++) {
+        int w = plane ? width  >> 1 : width;
+        int h = plane ? height >> 1 : height;
+
+        for (y = 0; y < h; y++)
+            sum = av_adler32_update(sum, data[plane] + y * linesize[plane], w);
+    }
+    return sum;
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Fixture shared by the threading tests: an in-memory stream of packets,
+ * a synthetic picture and a checksum of decoded YUV 4:2:0 pictures.
+ */
+
+#ifndef AVCODEC_THREADTEST_H
+#define AVCODEC_THREADTEST_H
+
+#include <stdint.h>
+
+#include "avcodec.h"
+
+#define THREADTEST_MAX_PACKETS 64
+
+typedef struct ThreadTestStream {
+    AVPacket packets[THREADTEST_MAX_PACKETS];
+    int nb_packets;
+} ThreadTestStream;
+
+/**
+ * Append a packet of size bytes to the stream.
+ * @return the packet, or NULL if the stream is full or on allocation failure
+ */
+AVPacket *ff_threadtest_new_packet(ThreadTestStream *s, int size);
+
+void ff_threadtest_free_stream(ThreadTestStream *s);
+
+/**
+ * Fill the top left width x height of a YUV 4:2:0 picture with a pattern
+ * that moves with the frame number n.
+ */
+void ff_threadtest_fill_picture(AVFrame *pic, int width, int height, int n);
+
+/**
+ * Adler-32 checksum of the visible part of a YUV 4:2:0 picture.
+ */
+uint32_t ff_threadtest_checksum(uint8_t * const data[4], const int linesize[4],
+                                int width, int height);
+
+#endif /* AVCODEC_THREADTEST_H */
@@ -693,8 +693,12 @@ int attribute_align_arg avcodec_encode_video(AVCodecContext *avctx, uint8_t *buf
     }
     if(av_image_check_size(avctx->width, avctx->height, 0, avctx))
         return -1;
-    if((avctx->codec->capabilities & CODEC_CAP_DELAY) || pict){
-        int ret = avctx->codec->encode(avctx, buf, buf_size, pict);
+    if((avctx->codec->capabilities & CODEC_CAP_DELAY) || pict || (avctx->active_thread_type&FF_THREAD_FRAME)){
+        int ret;
+        if (HAVE_PTHREADS && avctx->active_thread_type&FF_THREAD_FRAME)
+            ret = ff_thread_encode_video(avctx, buf, buf_size, pict);
+        else
+            ret = avctx->codec->encode(avctx, buf, buf_size, pict);
         avctx->frame_number++;
         emms_c(); //needed to avoid an emms_c() call before every return;
 
@@ -799,6 +803,38 @@ int attribute_align_arg avcodec_decode_video2(AVCodecContext *avctx, AVFrame *pi
     return ret;
 }
 
+int attribute_align_arg avcodec_decode_video_nonblock(AVCodecContext *avctx, AVFrame *picture,
+                         int *got_picture_ptr,
+                         AVPacket *avpkt)
+{
+    int ret;
+
+    if (!(HAVE_PTHREADS && avctx->active_thread_type&FF_THREAD_FRAME)) {
+        *got_picture_ptr= 0;
+        return avpkt ? avcodec_decode_video2(avctx, picture, got_picture_ptr, avpkt) : 0;
+    }
+
+    if (avpkt) {
+        if((avctx->coded_width||avctx->coded_height) && av_image_check_size(avctx->coded_width, avctx->coded_height, 0, avctx))
+            return -1;
+        av_packet_split_side_data(avpkt);
+        avctx->pkt = avpkt;
+    }
+
+    ret = ff_thread_decode_frame_nonblock(avctx, picture, got_picture_ptr, avpkt);
+
+    emms_c(); //needed to avoid an emms_c() call before every return;
+
+    if (*got_picture_ptr){
+        avctx->frame_number++;
+        picture->best_effort_timestamp = guess_correct_pts(avctx,
+                                                        picture->pkt_pts,
+                                                        picture->pkt_dts);
+    }
+
+    return ret;
+}
+
 int attribute_align_arg avcodec_decode_audio3(AVCodecContext *avctx, int16_t *samples,
                          int *frame_size_ptr,
                          AVPacket *avpkt)
@@ -1373,6 +1409,15 @@ void ff_thread_await_progress(AVFrame *f, int progress, int field)
 {
 }
 
+int avcodec_thread_pool_init(int thread_count)
+{
+    return AVERROR(ENOSYS);
+}
+
+void avcodec_thread_pool_free(void)
+{
+}
+
 #endif
 
 #if FF_API_THREAD_INIT
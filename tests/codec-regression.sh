@@ -114,6 +114,18 @@ do_video_encoding huffyuv.avi "-an -vcodec huffyuv -pix_fmt yuv422p -sws_flags n
 do_video_decoding "" "-strict -2 -pix_fmt yuv420p -sws_flags neighbor+bitexact"
 fi
 
+if [ -n "$do_huffyuvthread" ] ; then
+do_video_encoding huffyuv-single.avi "-an -vcodec huffyuv -pix_fmt yuv422p -sws_flags neighbor+bitexact"
+do_video_encoding huffyuv-thread.avi "-an -vcodec huffyuv -pix_fmt yuv422p -sws_flags neighbor+bitexact -threads 4"
+do_video_decoding "" "-strict -2 -pix_fmt yuv420p -sws_flags neighbor+bitexact"
+fi
+
+if [ -n "$do_ffvhuffthread" ] ; then
+do_video_encoding ffvhuff-single.avi "-an -vcodec ffvhuff"
+do_video_encoding ffvhuff-thread.avi "-an -vcodec ffvhuff -threads 4"
+do_video_decoding
+fi
+
 if [ -n "$do_rc" ] ; then
 do_video_encoding mpeg4-rc.avi "-b 400k -bf 2 -an -vcodec mpeg4"
 do_video_decoding
@@ -133,11 +145,33 @@ do_video_encoding mpeg4-Q.avi "-qscale 7 -flags +mv4+qpel -mbd 2 -bf 2 -cmp 1 -s
 do_video_decoding
 fi
 
+if [ -n "$do_mpeg4lookahead" ] ; then
+# the output must not depend on the number of lookahead threads
+do_video_encoding mpeg4-lookahead.m4v "-qscale 10 -bf 2 -dia_size 4 -me_lookahead_threads 1 -an -vcodec mpeg4 -f m4v"
+do_video_decoding
+do_video_encoding mpeg4-lookahead.m4v "-qscale 10 -bf 2 -dia_size 4 -me_lookahead_threads 4 -an -vcodec mpeg4 -f m4v"
+do_video_decoding
+fi
+
 if [ -n "$do_mpeg4thread" ] ; then
 do_video_encoding mpeg4-thread.avi "-b 500k -flags +mv4+part+aic -trellis 1 -mbd bits -ps 200 -bf 2 -an -vcodec mpeg4 -threads 2"
 do_video_decoding
 fi
 
+if [ -n "$do_mpeg4reinit" ] ; then
+# the size changes mid-stream, frame threads have to reopen the decoder
+do_video_encoding mpeg4-cif.m4v "-an -vcodec mpeg4 -f m4v"
+do_video_encoding mpeg4-qcif.m4v "-an -vcodec mpeg4 -s 176x144 -f m4v"
+file=${outfile}mpeg4-reinit.m4v
+cat ${outfile}mpeg4-cif.m4v ${outfile}mpeg4-qcif.m4v > $file
+do_video_decoding
+do_video_decoding "-threads 4 -thread_type frame"
+# the size stays the same, nothing must be reopened with B-frames delaying the output
+do_video_encoding mpeg4-bf.m4v "-an -vcodec mpeg4 -bf 2 -f m4v"
+do_video_decoding
+do_video_decoding "-threads 4 -thread_type frame"
+fi
+
 if [ -n "$do_error" ] ; then
 do_video_encoding error-mpeg4-adv.avi "-qscale 7 -flags +mv4+part+aic -mbd rd -ps 250 -error 10 -an -vcodec mpeg4"
 do_video_decoding
@@ -158,6 +192,11 @@ do_video_encoding mjpeg.avi "-qscale 9 -an -vcodec mjpeg -pix_fmt yuvj420p"
 do_video_decoding "" "-pix_fmt yuv420p"
 fi
 
+if [ -n "$do_mjpegthread" ] ; then
+do_video_encoding mjpeg-thread.avi "-qscale 9 -an -vcodec mjpeg -pix_fmt yuvj420p -threads 4"
+do_video_decoding "" "-pix_fmt yuv420p"
+fi
+
 if [ -n "$do_ljpeg" ] ; then
 do_video_encoding ljpeg.avi "-an -vcodec ljpeg -strict -1"
 do_video_decoding
@@ -198,6 +237,12 @@ do_video_encoding ffv1.avi "-strict -2 -an -vcodec ffv1"
 do_video_decoding
 fi
 
+if [ -n "$do_ffv1thread" ] ; then
+do_video_encoding ffv1-single.avi "-strict -2 -an -vcodec ffv1 -g 1"
+do_video_encoding ffv1-thread.avi "-strict -2 -an -vcodec ffv1 -g 1 -threads 4"
+do_video_decoding
+fi
+
 if [ -n "$do_snow" ] ; then
 do_video_encoding snow.avi "-strict -2 -an -vcodec snow -qscale 2 -flags +qpel -me_method iter -dia_size 2 -cmp 12 -subcmp 12 -s 128x64"
 do_video_decoding "" "-s 352x288"
@@ -252,6 +297,36 @@ do_video_encoding flashsv2.flv "-an -vcodec flashsv2 -sws_flags neighbor+full_ch
 #do_video_decoding "" "-pix_fmt yuv420p -sws_flags area+accurate_rnd+bitexact"
 fi
 
+if [ -n "$do_libdm365_h264" ] ; then
+do_video_encoding libdm365_h264.h264 "-an -vcodec libdm365_h264 -pix_fmt nv12 -g 10 -strict experimental -f h264"
+do_video_decoding "" "-pix_fmt yuv420p"
+do_video_decoding "-vcodec libdm365_h264" "-pix_fmt yuv420p"
+# smallest output pool, and a deep DPB held by the codec in the default pool
+do_video_decoding "-vcodec libdm365_h264 -output_buffers 2" "-pix_fmt yuv420p"
+export DM365STUB_DPB_SIZE=6
+do_video_decoding "-vcodec libdm365_h264" "-pix_fmt yuv420p"
+unset DM365STUB_DPB_SIZE
+do_video_encoding libdm365_h264_slice.h264 "-an -vcodec libdm365_h264 -pix_fmt nv12 -g 10 -ps 20000 -strict experimental -f h264"
+do_video_decoding "" "-pix_fmt yuv420p"
+# the slices of every frame thread on workers shared by all of them
+do_video_decoding "-threads 4 -thread_type frame_slice" "-pix_fmt yuv420p"
+do_video_decoding "-vcodec libdm365_h264" "-pix_fmt yuv420p"
+fi
+
+if [ -n "$do_libdm365_mpeg4" ] ; then
+do_video_encoding libdm365_mpeg4.avi "-an -vcodec libdm365_mpeg4 -pix_fmt nv12 -b 400k -strict experimental"
+do_video_decoding
+do_video_decoding "-vcodec libdm365_mpeg4" "-pix_fmt yuv420p"
+do_video_encoding libdm365_mpeg4_async.avi "-an -vcodec libdm365_mpeg4 -pix_fmt nv12 -b 400k -async_encode 1 -strict experimental"
+do_video_decoding
+fi
+
+if [ -n "$do_libdm365_jpeg" ] ; then
+do_video_encoding libdm365_jpeg.avi "-an -vcodec libdm365_jpeg -pix_fmt nv12 -strict experimental"
+do_video_decoding "" "-pix_fmt yuv420p"
+do_video_decoding "-vcodec libdm365_jpeg" "-pix_fmt yuv420p"
+fi
+
 if [ -n "$do_roq" ] ; then
 do_video_encoding roqav.roq "-vframes 5"
 do_video_decoding "" "-pix_fmt yuv420p"
@@ -290,6 +365,16 @@ do_audio_encoding ac3.rm "-vn -acodec ac3_fixed"
 #$tiny_psnr $pcm_dst $pcm_ref 2 1024 >> $logfile
 fi
 
+if [ -n "$do_aac_fixed" ] ; then
+do_audio_encoding aac_fixed.aac "-vn -acodec aac_fixed"
+# the decoders output the 1024 samples of encoder delay
+# the float decoder output is not bitexact across FPUs
+do_ffmpeg_nomd5 $pcm_dst $DEC_OPTS -acodec aac -i $target_path/$file -sample_fmt s16 -f wav
+$tiny_psnr $pcm_dst $pcm_ref 2 4096 >> $logfile
+do_audio_decoding "-acodec aac_fixed"
+$tiny_psnr $pcm_dst $pcm_ref 2 4096 >> $logfile
+fi
+
 if [ -n "$do_g726" ] ; then
 do_audio_encoding g726.wav "-ab 32k -ac 1 -ar 8000 -acodec g726"
 do_audio_decoding
@@ -172,6 +172,8 @@ FATE_H264 = aud_mw_e                                                    \
             sva_nl2_e                                                   \
 
 FATE_H264  := $(FATE_H264:%=fate-h264-conformance-%)                    \
+              fate-h264-frame-slice-ba1_ft_c                            \
+              fate-h264-frame-slice-ci1_ft_b                            \
               fate-h264-interlace-crop                                  \
               fate-h264-lossless                                        \
               fate-h264-extreme-plane-pred                              \
@@ -355,3 +357,13 @@ fate-h264-conformance-sva_nl2_e: CMD = framecrc -vsync 0 -i $(SAMPLES)/h264-conf
 fate-h264-interlace-crop: CMD = framecrc -vsync 0 -vframes 3 -i $(SAMPLES)/h264/interlaced_crop.mp4
 fate-h264-lossless: CMD = framecrc -vsync 0 -i $(SAMPLES)/h264/lossless.h264
 fate-h264-extreme-plane-pred: CMD = framemd5 -strict 1 -vsync 0 -i $(SAMPLES)/h264/extreme-plane-pred.h264
+
+# multi-slice streams decoded with frame and slice threads combined
+fate-h264-frame-slice-ba1_ft_c: CMD = framecrc -threads 4 -thread_type frame_slice -vsync 0 -i $(SAMPLES)/h264-conformance/BA1_FT_C.264
+fate-h264-frame-slice-ba1_ft_c: REF = $(SRC_PATH)/tests/ref/fate/h264-conformance-ba1_ft_c
+fate-h264-frame-slice-ci1_ft_b: CMD = framecrc -threads 4 -thread_type frame_slice -vsync 0 -i $(SAMPLES)/h264-conformance/CI1_FT_B.264
+fate-h264-frame-slice-ci1_ft_b: REF = $(SRC_PATH)/tests/ref/fate/h264-conformance-ci1_ft_b
+
+FATE-$(CONFIG_H264DSP) += fate-h264dsp
+fate-h264dsp: libavcodec/h264dsp-test$(EXESUF)
+fate-h264dsp: CMD = run libavcodec/h264dsp-test
@@ -0,0 +1,13 @@
+ifeq ($(CONFIG_MPEG4_ENCODER)$(CONFIG_MPEG4_DECODER),yesyes)
+FATE_THREADS += fate-decode-nonblock
+endif
+fate-decode-nonblock: libavcodec/nonblock-test$(EXESUF)
+fate-decode-nonblock: CMD = run libavcodec/nonblock-test
+
+ifeq ($(CONFIG_MJPEG_ENCODER)$(CONFIG_MJPEG_DECODER),yesyes)
+FATE_THREADS += fate-mjpeg-dri-slice
+endif
+fate-mjpeg-dri-slice: libavcodec/mjpegdri-test$(EXESUF)
+fate-mjpeg-dri-slice: CMD = run libavcodec/mjpegdri-test
+
+FATE-$(HAVE_PTHREADS) += $(FATE_THREADS)
@@ -119,5 +119,5 @@ do_audio_encoding()
 
 do_audio_decoding()
 {
-    do_ffmpeg $pcm_dst $DEC_OPTS -i $target_path/$file -sample_fmt s16 -f wav
+    do_ffmpeg $pcm_dst $DEC_OPTS $1 -i $target_path/$file -sample_fmt s16 -f wav
 }